@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace x11engine::memory {
+
+    // Opt-in heap tracking. Built with X11ENGINE_ALLOC_TRACKING the engine replaces the global operator new/delete
+    // and counts calls made on threads that asked for it; other threads (and builds without the option) pay nothing.
+    // Only C++ allocations are seen, malloc from C libraries (Xlib) is not.
+
+    struct AllocationStats {
+        uint64_t count; // operator new calls
+        uint64_t bytes; // Requested bytes
+        uint64_t frees; // operator delete calls (non-null)
+    };
+
+    inline AllocationStats operator-(const AllocationStats& a, const AllocationStats& b) { return {a.count - b.count, a.bytes - b.bytes, a.frees - b.frees}; }
+    inline AllocationStats& operator+=(AllocationStats& a, const AllocationStats& b) {
+        a.count += b.count;
+        a.bytes += b.bytes;
+        a.frees += b.frees;
+        return a;
+    }
+
+    constexpr std::size_t ALLOCATION_SITE_DEPTH = 4;
+
+    // Allocations grouped by the innermost return addresses above operator new
+    struct AllocationSite {
+        std::array<void*, ALLOCATION_SITE_DEPTH> stack;
+        uint64_t count;
+        uint64_t bytes;
+    };
+
+    enum class AllocationCheck {
+        Off,
+        Track,  // Count per frame and phase, report the call sites of steady-state allocations
+        Assert, // Abort with a backtrace on the first allocation in a steady-state frame
+    };
+
+    // False when the engine was built without X11ENGINE_ALLOC_TRACKING (everything below then does nothing)
+    bool IsAllocationTrackingAvailable() noexcept;
+
+    // Count the calling thread's allocations from now on
+    void TrackThreadAllocations(bool enabled) noexcept;
+
+    // Running totals of the calling thread (zero while it is not tracked)
+    AllocationStats GetThreadAllocations() noexcept;
+
+    // Also group the calling thread's allocations by call site. Unwinds the stack on every allocation, so slow.
+    void RecordAllocationSites(bool enabled) noexcept;
+
+    // Busiest sites recorded on the calling thread since the last clear, most frequent first. Returns how many were written.
+    std::size_t GetAllocationSites(std::span<AllocationSite> out) noexcept;
+    void ClearAllocationSites() noexcept;
+
+    // While forbidden, an allocation on the calling thread prints its backtrace to stderr and aborts
+    void ForbidThreadAllocations(bool forbidden) noexcept;
+
+    // Symbolized stack of a site on stderr (names need -rdynamic, otherwise module+offset for addr2line)
+    void PrintAllocationSite(const AllocationSite& site) noexcept;
+
+} // namespace x11engine::memory
@@ -4,6 +4,9 @@ namespace x11engine {
 
     class Renderer;
     class Input;
+    class ThreadPool;
+    class PostProcessor;
+    struct FrameTiming;
 
     class Application {
     public:
@@ -13,12 +16,15 @@ namespace x11engine {
         virtual void OnUpdate(float dt) = 0;
         virtual void OnRender() = 0;
         virtual void OnResize(int width, int height) {}
+        virtual void OnFrameEnd(const FrameTiming& /*timing*/) {} // After Present, with the frame's phase times
 
         void Close() { shouldClose = true; }
         bool ShouldClose() const { return shouldClose; }
 
         Renderer* renderer = nullptr;
         Input* input = nullptr;
+        ThreadPool* jobs = nullptr; // Worker threads for data-parallel work in OnUpdate/OnRender
+        PostProcessor* post = nullptr; // Effects applied to every frame after OnRender
 
     private:
         bool shouldClose = false;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "x11engine/color.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace x11engine {
+
+    enum class BlitMode {
+        Opaque,   // Copy every pixel
+        ColorKey, // Skip pixels whose RGB equals the atlas' color key
+        Alpha,    // Premultiplied src-over with each pixel's own alpha
+    };
+
+    struct SpriteRect {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    // One sprite of a batch (see Renderer::BlitBatch). Position is the top-left corner in framebuffer pixels.
+    struct SpriteDraw {
+        int sprite;
+        int x;
+        int y;
+        int scale = 1; // Integer magnification
+        bool flipX = false;
+    };
+
+    // Reads a binary PPM (P6) or PAM (P7, RGB or RGB_ALPHA), 8 bits per channel, into premultiplied 0xAARRGGBB
+    bool ReadImageFile(const std::string& path, std::vector<uint32_t>& pixels, int& width, int& height);
+
+    // Sprites packed into one premultiplied 0xAARRGGBB image, so a whole HUD or tile set
+    // is a single allocation. Rows are padded to a cache line.
+    class Atlas {
+    public:
+        Atlas(int width, int height); // Transparent black. Throws std::bad_alloc.
+        ~Atlas();
+
+        Atlas(const Atlas&) = delete;
+        Atlas& operator=(const Atlas&) = delete;
+        Atlas(Atlas&& other) noexcept;
+        Atlas& operator=(Atlas&& other) noexcept;
+
+        // Copies an image in (shelf packing) and returns its sprite id, or -1 when it doesn't fit.
+        // Pass 'premultiply' for straight-alpha 0xAARRGGBB input.
+        int Add(const uint32_t* image, int imageWidth, int imageHeight, bool premultiply = false);
+
+        // Binary PPM (P6) or PAM (P7, RGB or RGB_ALPHA), 8 bits per channel
+        int AddImageFile(const std::string& path);
+
+        // Registers a region that is already in the atlas, e.g. one cell of a sprite sheet
+        int Define(const SpriteRect& rect);
+
+        void SetColorKey(uint32_t key) { colorKey = key; }
+        uint32_t GetColorKey() const { return colorKey; }
+
+        const SpriteRect& GetSprite(int id) const { return sprites[id]; }
+        int GetSpriteCount() const { return static_cast<int>(sprites.size()); }
+
+        const uint32_t* GetRow(int y) const { return pixels + static_cast<std::size_t>(y) * pitch; }
+        uint32_t* GetPixels() { return pixels; }
+        int GetPitch() const { return pitch; } // In pixels
+        int GetWidth() const { return width; }
+        int GetHeight() const { return height; }
+
+    private:
+        int width = 0;
+        int height = 0;
+        int pitch = 0;
+        uint32_t* pixels = nullptr;
+        uint32_t colorKey = color::MAGENTA;
+        std::vector<SpriteRect> sprites;
+
+        // Shelf packer: images fill the current row left to right, a new shelf opens below the tallest one
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+    };
+
+} // namespace x11engine
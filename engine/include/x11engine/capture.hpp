@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace x11engine {
+
+    enum class CaptureFormat {
+        Y4M, // YUV4MPEG2, 4:2:0 BT.601 limited range. Plays in mpv/ffplay, ffmpeg reads it directly.
+        Raw, // Framebuffer bytes as-is: -f rawvideo -pixel_format bgr0 -video_size WxH
+    };
+
+    // Records presented frames without blocking the render thread.
+    // Submit copies the frame into one of 'slots' preallocated buffers (one memcpy); a writer thread
+    // converts and streams them to disk. When every slot is still waiting to be written the frame is
+    // dropped and counted instead of stalling the caller.
+    class FrameCapture {
+    public:
+        FrameCapture() = default;
+        ~FrameCapture();
+
+        FrameCapture(const FrameCapture&) = delete;
+        FrameCapture& operator=(const FrameCapture&) = delete;
+
+        // Frames must be (width x height) for the whole recording, 'fps' is only written to the Y4M header
+        bool Start(const std::string& path, CaptureFormat format, int width, int height, int fps, int slots = 8);
+        void Stop(); // Writes out every frame already submitted, then closes the file
+
+        // Render thread only. Returns false if the frame was dropped.
+        bool Submit(const uint32_t* pixels, int frameWidth, int frameHeight);
+
+        bool IsActive() const { return writer.joinable(); }
+        uint64_t GetSubmittedFrames() const { return submitted.load(std::memory_order_relaxed); }
+        uint64_t GetDroppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+        uint64_t GetWrittenFrames() const { return written.load(std::memory_order_relaxed); }
+
+    private:
+        void WriterLoop();
+        bool WriteFrame(const uint32_t* pixels);
+
+    private:
+        CaptureFormat format = CaptureFormat::Y4M;
+        int width = 0;
+        int height = 0;
+        std::FILE* file = nullptr;
+
+        // Single-producer/single-consumer ring: the render thread advances head, the writer advances tail
+        std::vector<uint32_t*> ring;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+        std::counting_semaphore<> ready{0}; // One release per submitted frame, plus one to stop
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> failed{false};
+
+        std::vector<uint8_t> scratch; // Writer-side conversion output (one Y4M frame)
+        std::thread writer;
+
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> written{0};
+    };
+
+    // Y4M for *.y4m paths, Raw otherwise
+    CaptureFormat GuessCaptureFormat(const std::string& path);
+
+} // namespace x11engine
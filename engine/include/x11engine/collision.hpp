@@ -0,0 +1,122 @@
+#pragma once
+
+#include "x11engine/math.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace x11engine {
+
+    namespace objects {
+        class Object3D;
+    }
+
+    namespace collision {
+
+        using math::Mat4;
+        using math::Vec3;
+
+        struct Aabb {
+            Vec3 min;
+            Vec3 max;
+        };
+
+        // Touching boxes overlap
+        inline bool Overlaps(const Aabb& a, const Aabb& b) {
+            return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+        }
+
+        // World box around a transformed local box: the center goes through m, the half extents through |m|
+        Aabb TransformAabb(const Mat4& m, const Aabb& local);
+
+        using BodyId = uint32_t;
+
+        struct CollisionPair {
+            BodyId a; // a < b
+            BodyId b;
+        };
+
+        // Incremental sweep-and-prune. Every axis keeps the boxes' min/max endpoints sorted; Update re-sorts them with
+        // an insertion sort, which is close to linear when bodies move a little per step. Each swap of a min past a max
+        // is exactly one axis starting or ending an overlap, so the pair set is maintained from the swaps alone.
+        class SweepAndPrune {
+        public:
+            BodyId Add(const Aabb& bounds); // Becomes part of the pairs on the next Update
+            void Remove(BodyId id);         // Its pairs go away immediately, the id is reused
+            void SetBounds(BodyId id, const Aabb& bounds) { bodies[id] = bounds; }
+            const Aabb& GetBounds(BodyId id) const { return bodies[id]; }
+
+            void Update();
+
+            // Overlapping pairs as of the last Update, ordered by (a, b)
+            std::span<const CollisionPair> GetPairs() const { return pairs; }
+            std::size_t GetBodyCount() const { return bodies.size() - freeIds.size(); }
+
+        private:
+            struct Endpoint {
+                float value;
+                uint32_t data; // body << 1 | isMax
+            };
+
+            // Open addressing with linear probing, keyed by a << 32 | b. Only grows, so steady state doesn't allocate.
+            class PairSet {
+            public:
+                void Insert(uint64_t key);
+                void Erase(uint64_t key);
+                template <typename Fn>
+                void ForEach(Fn&& fn) const {
+                    for (uint64_t key : slots) {
+                        if (key != EMPTY)
+                            fn(key);
+                    }
+                }
+                std::size_t GetCount() const { return count; }
+
+            private:
+                static constexpr uint64_t EMPTY = ~0ull;
+
+                std::size_t Slot(uint64_t key) const { return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1); }
+                void Grow();
+
+                std::vector<uint64_t> slots;
+                std::size_t count = 0;
+            };
+
+            void SortAxis(int axis);
+
+            std::vector<Aabb> bodies; // By id
+            std::vector<bool> alive;
+            std::vector<BodyId> freeIds;
+            std::vector<Endpoint> axes[3];
+            PairSet pairSet;
+            std::vector<CollisionPair> pairs;
+        };
+
+        // Broadphase over objects: boxes follow the objects' transforms (GetModelMatrix, GetLocalBounds)
+        class CollisionWorld {
+        public:
+            BodyId Add(objects::Object3D& object);
+            void Remove(BodyId id);
+
+            // Recompute every box from its object, then update the pairs. Call after the objects moved (OnUpdate).
+            void Update();
+
+            // Hands every overlapping pair to the narrowphase: fn(Object3D& a, Object3D& b)
+            template <typename Fn>
+            void ForEachPair(Fn&& narrowphase) const {
+                for (const CollisionPair& pair : broadphase.GetPairs())
+                    narrowphase(*objects[pair.a], *objects[pair.b]);
+            }
+
+            const SweepAndPrune& GetBroadphase() const { return broadphase; }
+
+        private:
+            SweepAndPrune broadphase;
+            std::vector<objects::Object3D*> objects; // By id, nullptr once removed
+        };
+
+    } // namespace collision
+
+} // namespace x11engine
@@ -5,11 +5,29 @@
 namespace x11engine::color {
 
     // Colors are in 0xRRGGBB format.
+    // Translucent colors are premultiplied 0xAARRGGBB: the channels are already scaled by alpha.
+    // The alpha byte only matters to the blended draw modes; Replace draws every color opaque.
+
+    enum class BlendMode {
+        Replace,  // dst = src
+        Alpha,    // dst = src + dst * (1 - a)
+        Additive, // dst = min(dst + src, 1), e.g. glow
+        Multiply, // dst = dst * src + dst * (1 - a), i.e. tint by src at coverage a
+    };
 
     constexpr uint32_t RGB(uint8_t r, uint8_t g, uint8_t b) noexcept {
         return (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
     }
 
+    // Premultiplies (r, g, b) by a / 255 (rounded)
+    constexpr uint32_t RGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a) noexcept {
+        auto scale = [a](uint8_t c) { return static_cast<uint8_t>((c * a + 127) / 255); };
+        return (static_cast<uint32_t>(a) << 24) | RGB(scale(r), scale(g), scale(b));
+    }
+
+    constexpr uint32_t WithAlpha(uint32_t rgb, uint8_t a) noexcept { return RGBA((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, a); }
+    constexpr uint8_t Alpha(uint32_t color) noexcept { return static_cast<uint8_t>(color >> 24); }
+
     constexpr uint32_t BLACK = RGB(0, 0, 0);
     constexpr uint32_t WHITE = RGB(255, 255, 255);
 
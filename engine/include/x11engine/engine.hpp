@@ -1,8 +1,16 @@
 #pragma once
 
+#include "x11engine/allocations.hpp"
+#include "x11engine/capture.hpp"
+#include "x11engine/eventthread.hpp"
 #include "x11engine/frame.hpp"
 #include "x11engine/renderer.hpp"
 #include "x11engine/input.hpp"
+#include "x11engine/jobs.hpp"
+#include "x11engine/postprocess.hpp"
+#include "x11engine/profiler.hpp"
+#include "x11engine/resolution.hpp"
+#include "x11engine/telemetry.hpp"
 
 #include <string>
 #include <memory>
@@ -22,13 +30,83 @@ namespace x11engine {
         bool Init();
         void Run();
 
+        // Frame rate cap (TARGET_FPS by default), 0 runs uncapped. Also the dynamic resolution budget.
+        void SetTargetFps(double fps);
+
+        const Profiler& GetProfiler() const { return profiler; }
+        ThreadPool& GetJobs() { return jobs; }
+        PostProcessor& GetPostProcessor() { return post; } // Empty by default
+
+        // Heap checks on the main loop once 'warmupFrames' frames have passed (again after every resize).
+        // Needs a build with X11ENGINE_ALLOC_TRACKING; X11ENGINE_ALLOC=track|assert sets it at launch.
+        void SetAllocationCheck(memory::AllocationCheck check, int warmupFrames = 120);
+
+        // Call before Init. X11ENGINE_BACKEND=xlib|xcb overrides it at launch.
+        void SetWindowBackend(WindowBackend backend);
+
+        // Call before Init. Reads input on a thread of its own (see eventthread.hpp) instead of once per frame in the main loop,
+        // adds mouse buttons and motion, and with 'rawMotion' XInput2 raw mouse deltas. X11ENGINE_EVENT_THREAD=1|raw sets it at launch.
+        // Either way events reach Input at the start of the fixed tick they arrived in.
+        void SetEventThread(bool enabled, bool rawMotion = false);
+
+        // Queues a synthetic event (replays, automation, latency benchmarks), delivered and measured like a real one.
+        // Main thread only, and not while the event thread runs: the queue takes a single producer.
+        bool PushInput(const InputEvent& event);
+
+        // Lower the internal render resolution (down to minScale) whenever frames exceed the TARGET_FPS budget
+        void SetDynamicResolution(bool enabled, float minScale = 0.5f);
+
+        // Record every presented frame (format from the extension, see capture.hpp). Also started by X11ENGINE_CAPTURE=<path>.
+        bool StartCapture(const std::string& path);
+        void StopCapture();
+
+        // Publish every frame's timings and render counts to shared memory for EngineStats and other monitors (see telemetry.hpp).
+        // An empty name picks "/x11engine.<pid>". Also started by X11ENGINE_TELEMETRY=1 (or =<name>).
+        bool StartTelemetry(const std::string& name = "");
+        void StopTelemetry();
+
     private:
         void WaitForMapNotify();
         void HandleEvents();
+        void ReportAllocations() const;
+        void PublishTelemetry();
+        void DeliverInput(double tickEnd, bool lastTick);
+        void RetireInput();
 
         Frame frame;
         Renderer renderer;
         Input input;
+        InputEventQueue inputEvents; // Filled by HandleEvents or the event thread, drained per tick
+        EventThread eventThread;
+        bool useEventThread;
+        bool rawMotion;
+
+        // Presses consumed by the ticks, oldest first, with the present that showed them (Frame::GetPresentCount). They
+        // become latencies once the frame knows that present completed. A burst beyond the capacity isn't sampled.
+        struct PendingInput {
+            double arrival;
+            uint64_t present; // 0 until this frame's present has been sent
+        };
+        std::array<PendingInput, 256> pendingInput;
+        std::size_t pendingInputHead;
+        std::size_t pendingInputCount;
+        std::size_t unpresentedInput; // The newest entries, consumed by this frame's ticks
+        ThreadPool jobs;
+        PostProcessor post;
+        ResolutionController resolution;
+        FrameCapture capture;
+        TelemetryWriter telemetry;
+        bool dynamicResolution;
+        double targetFps;
+        Profiler profiler;
+
+        // Allocation checks
+        memory::AllocationCheck allocationCheck;
+        int allocationWarmup;
+        uint64_t steadyFrame;     // First frame counted as steady state
+        uint64_t steadyFrames;
+        uint64_t allocatingFrames; // Steady-state frames that allocated
+        std::array<memory::AllocationStats, FRAME_PHASE_COUNT> steadyAllocations;
         Application* app;
         bool running;
     };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "x11engine/input.hpp"
+
+#include <X11/Xlib.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace x11engine {
+
+    // Fixed-size single-producer/single-consumer queue: one thread pushes, one peeks and pops. Never blocks or allocates
+    // after construction; a push into a full queue is dropped and counted.
+    class InputEventQueue {
+    public:
+        explicit InputEventQueue(std::size_t capacity = 1024); // Rounded up to a power of two
+
+        bool Push(const InputEvent& event);
+        const InputEvent* Peek() const; // Oldest event, nullptr when empty
+        void Pop();
+
+        uint64_t GetDroppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        std::vector<InputEvent> ring;
+        std::size_t mask;
+        alignas(64) std::atomic<uint64_t> head{0}; // Written by the producer
+        alignas(64) std::atomic<uint64_t> tail{0}; // Written by the consumer
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    // Reads input on its own X connection so events are picked up (and timestamped) the moment they arrive instead of
+    // once per frame. The render connection is left alone: no XInitThreads, and it works behind either window backend.
+    // Keys, buttons and pointer motion of 'window' go into the queue; with 'rawMotion', so do XInput2 raw mouse deltas
+    // (when the build has XInput2 and the server supports it). Raw motion is reported whether or not the window has focus.
+    class EventThread {
+    public:
+        EventThread() = default;
+        ~EventThread();
+
+        EventThread(const EventThread&) = delete;
+        EventThread& operator=(const EventThread&) = delete;
+
+        bool Start(Window window, bool rawMotion, InputEventQueue& queue);
+        void Stop();
+
+        bool IsRunning() const { return thread.joinable(); }
+        bool HasRawMotion() const { return xiOpcode >= 0; }
+
+    private:
+        void Loop();
+        bool Translate(XEvent& event, InputEvent& out);
+        bool EnableRawMotion();
+
+        Display* display = nullptr;
+        Window window = 0;
+        int xiOpcode = -1;
+        int wake[2] = {-1, -1}; // Pipe that interrupts the poll on Stop
+        InputEventQueue* queue = nullptr;
+        std::atomic<bool> stopping{false};
+        std::thread thread;
+    };
+
+} // namespace x11engine
@@ -1,19 +1,52 @@
 #pragma once
 
+#include "x11engine/pixelformat.hpp"
+
 #include <X11/Xlib.h>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace x11engine {
 
+    // Windowing library behind Frame. Picked before Init, or at launch with X11ENGINE_BACKEND=xlib|xcb|headless.
+    enum class WindowBackend {
+        Xlib,     // XPutImage followed by a blocking XSync every frame
+        Xcb,      // Pipelined xcb_put_image, errors collected a couple of frames later (no round-trip per frame)
+        Headless, // No X connection: frames are rendered and dropped (benchmarks, CI)
+    };
+
+    class FrameBackend; // See src/frame_backend.hpp
+
     class Frame {
     public:
         Frame(int width, int height, const std::string& title);
         ~Frame();
 
+        void SetBackend(WindowBackend newBackend); // Only before Init
         bool Init();
         void Resize(int newWidth, int newHeight);
+        void SetTitle(std::string_view newTitle); // Reuses the stored title's buffer, no allocation once it is long enough
 
-        Display* GetDisplay() const;
+        // Events arrive as Xlib events whatever the backend. Keys must be resolved with LookupKeysym.
+        bool PollEvent(XEvent& event); // Non-blocking, false when the queue is empty
+        void WaitEvent(XEvent& event);
+        KeySym LookupKeysym(const XKeyEvent& event) const;
+
+        // Shows a (width x height) image laid out in GetPixelFormat() with 'bytesPerLine' pitch.
+        // The data is copied out before returning; with XCB the server may still be drawing the previous frames.
+        void PresentImage(const void* data, int width, int height, int bytesPerLine);
+
+        // Presents handed to PresentImage since Init, and how many of them the server is known to have processed (in order,
+        // never blocks). Xlib and headless are done when PresentImage returns; XCB once the fence sent after the image has
+        // its reply, which is read here if it has arrived.
+        uint64_t GetPresentCount() const { return presentCount; }
+        uint64_t PollCompletedPresents();
+
+        WindowBackend GetBackend() const { return backend; }
+        const PixelFormatInfo& GetPixelFormat() const;
+        Display* GetDisplay() const; // nullptr unless the Xlib backend is active
         Window GetWindow() const;
         int GetScreen() const;
         Atom GetWMDeleteMessage() const;
@@ -23,10 +56,11 @@ namespace x11engine {
         int height;
         std::string title;
 
-        Display* display;
-        Window window;
-        int screen;
-        Atom wmDeleteMessage;
+        WindowBackend backend;
+        std::unique_ptr<FrameBackend> impl;
+        uint64_t presentCount;
     };
 
-} // namespace x11engine
\ No newline at end of file
+    const char* GetWindowBackendName(WindowBackend backend);
+
+} // namespace x11engine
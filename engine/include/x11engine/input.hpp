@@ -1,17 +1,76 @@
 #pragma once
 
 #include <X11/Xlib.h>
-#include <unordered_map>
+#include <X11/keysym.h> // XK_* constants for IsKeyDown
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace x11engine {
 
+    enum class InputEventType : uint8_t {
+        KeyDown,
+        KeyUp,
+        ButtonDown,
+        ButtonUp,
+        Motion,    // Pointer moved inside the window
+        RawMotion, // Unaccelerated device motion (XInput2, event thread only)
+    };
+
+    struct InputEvent {
+        InputEventType type;
+        double time;         // Arrival in the engine, seconds on the Profiler::Now clock
+        uint32_t serverTime; // X server timestamp in milliseconds
+        KeySym key;          // Key events
+        int button;          // Button events: 1 left, 2 middle, 3 right, 4/5 wheel
+        int x;               // Pointer position in the window (key, button and motion events)
+        int y;
+        double dx; // RawMotion: device deltas
+        double dy;
+    };
+
     class Input {
     public:
-        void ProcessEvent(const XEvent& event);
+        Input();
+
+        void ProcessEvent(const XEvent& event);   // Xlib events only (resolves the key through the event's display)
+        void ProcessKey(KeySym key, bool pressed); // Already resolved, e.g. by Frame::LookupKeysym
         bool IsKeyDown(KeySym key) const;
 
+        // Per-tick delivery (driven by the engine): every event is applied in order at the start of the fixed tick
+        // it arrived in, and stays readable through GetEvents until the next tick. GetEvents keeps the first
+        // MAX_TICK_EVENTS of a tick; later ones still update key, button and pointer state.
+        static constexpr std::size_t MAX_TICK_EVENTS = 256;
+        void BeginTick(double start, double end);
+        void Process(const InputEvent& event);
+
+        std::span<const InputEvent> GetEvents() const { return events; } // This tick's, in arrival order
+        double GetTickStart() const { return tickStart; }                 // Wall-clock span of the tick (Profiler::Now),
+        double GetTickEnd() const { return tickEnd; }                     // so 'event.time - GetTickStart()' places an event inside it
+
+        bool IsButtonDown(int button) const { return button > 0 && button < 32 && (buttons >> button) & 1; }
+        int GetMouseX() const { return mouseX; }
+        int GetMouseY() const { return mouseY; }
+        double GetRawDeltaX() const { return rawX; } // Summed over this tick's RawMotion events
+        double GetRawDeltaY() const { return rawY; }
+
     private:
-        std::unordered_map<KeySym, bool> keys;
+        // Fixed key state, so a new key never allocates: one bit per keysym in the Latin-1 (0x00xx) and
+        // function/keypad (0xffxx) pages, and a small table of the other keysyms currently held
+        static constexpr std::size_t MAX_OTHER_KEYS = 32;
+        std::bitset<512> pageKeys;
+        std::array<KeySym, MAX_OTHER_KEYS> otherKeys{};
+        std::size_t otherKeyCount = 0;
+        std::vector<InputEvent> events;
+        double tickStart = 0.0;
+        double tickEnd = 0.0;
+        uint32_t buttons = 0;
+        int mouseX = 0;
+        int mouseY = 0;
+        double rawX = 0.0;
+        double rawY = 0.0;
     };
 
-} // namespace x11engine
\ No newline at end of file
+} // namespace x11engine
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace x11engine {
+
+    // Persistent worker threads for data-parallel loops. Jobs are issued one at a time from a single thread
+    // (the frame loop), which works on them too: a pool of N threads has N - 1 workers.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threads = 0); // 0: one per hardware thread, X11ENGINE_THREADS=<n> overrides
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned GetThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+        // Calls fn(begin, end) on disjoint chunks of [0, count), each at most 'grain' long, and returns once all are done.
+        // Nothing is allocated per call. fn must not issue another ParallelFor.
+        template <typename Fn>
+        void ParallelFor(std::size_t count, std::size_t grain, Fn&& fn) {
+            using Callable = std::remove_reference_t<Fn>;
+            Run(count, grain, [](void* context, std::size_t begin, std::size_t end) { (*static_cast<Callable*>(context))(begin, end); }, const_cast<void*>(static_cast<const void*>(&fn)));
+        }
+
+    private:
+        using ChunkFn = void (*)(void* context, std::size_t begin, std::size_t end);
+
+        void Run(std::size_t count, std::size_t grain, ChunkFn fn, void* context);
+        void WorkerLoop();
+        void Work(); // Claim chunks of the current job until none are left
+
+        std::vector<std::thread> workers;
+
+        // Current job, published by bumping 'generation'
+        ChunkFn jobFn = nullptr;
+        void* jobContext = nullptr;
+        std::size_t jobCount = 0;
+        std::size_t jobGrain = 1;
+        std::atomic<std::size_t> nextChunk{0};
+        std::atomic<unsigned> busy{0};        // Workers that haven't finished the current job
+        std::atomic<uint32_t> generation{0}; // Workers sleep on it between jobs
+        bool stopping = false;
+    };
+
+} // namespace x11engine
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "x11engine/color.hpp"
+#include "x11engine/math.hpp"
+#include "x11engine/texture.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace x11engine::kernels {
+
+    // Instruction set the hot kernels were built for. Picked once at startup from cpuid,
+    // can be lowered with X11ENGINE_CPU=sse2|avx2|avx512 (e.g. to compare variants).
+    enum class CpuLevel {
+        SSE2,
+        AVX2,   // + FMA
+        AVX512, // AVX-512F
+    };
+
+    // Clip space -> pixels: x = (x / w + 1) * halfWidth, y = (1 - y / w) * halfHeight, truncated
+    struct ClipViewport {
+        float halfWidth;
+        float halfHeight;
+        float guardBand; // Lines within |x|, |y| <= guardBand * w are left to the raster scissor (DrawLine)
+    };
+
+    struct ScreenLine {
+        int x0, y0, x1, y1;
+    };
+
+    // Particle pools (see particles.hpp), one array per component
+    struct ParticleStreams {
+        float* px;
+        float* py;
+        float* pz;
+        float* vx;
+        float* vy;
+        float* vz;
+        float* life; // Seconds left
+    };
+
+    // One fixed step: v = (v + accel * dt) * drag, p += v * dt, life -= dt
+    struct ParticleStep {
+        float dt;
+        float drag;             // Velocity multiplier for this step
+        float ax, ay, az;       // accel * dt
+    };
+
+    constexpr uint32_t PARTICLE_CULLED = 0xFFFFFFFF;
+
+    // Tiled framebuffer layout (see Renderer::SetLayout): TILE x TILE pixel tiles of 256 bytes, tiles stored row-major,
+    // pixels row-major inside a tile. Any line through a tile stays within its 4 cache lines.
+    constexpr int TILE_SHIFT = 3;
+    constexpr int TILE = 1 << TILE_SHIFT;
+    constexpr int TILE_PIXELS = TILE * TILE;
+
+    inline std::size_t TiledOffset(int x, int y, int tilesPerRow) {
+        std::size_t tile = static_cast<std::size_t>(y >> TILE_SHIFT) * tilesPerRow + (x >> TILE_SHIFT);
+        return tile * TILE_PIXELS + ((y & (TILE - 1)) << TILE_SHIFT) + (x & (TILE - 1));
+    }
+
+    // One mip level of a Texture: power-of-two sizes, texels in 4x4 tiles of 16 (one cache line each)
+    struct TextureLevel {
+        const uint32_t* texels;
+        int widthMask;
+        int heightMask;
+        int tileShift; // log2(tiles per row) + 4: texel offset of a tile row
+        float width;
+        float height;
+    };
+
+    // Texel (x, y) of a level, coordinates wrap
+    inline uint32_t TextureOffset(const TextureLevel& l, int x, int y) {
+        x &= l.widthMask;
+        y &= l.heightMask;
+        return static_cast<uint32_t>(((y >> 2) << l.tileShift) | ((x >> 2) << 4) | ((y & 3) << 2) | (x & 3));
+    }
+
+    struct KernelTable {
+        CpuLevel level;
+
+        // out[i] = m * (in[i], 1). 'out' must be 16-byte aligned (Vec4).
+        void (*transformPoints)(const math::Mat4& m, const math::Vec3* in, math::Vec4* out, std::size_t count);
+
+        // Clips the lines verts[edges[i][0]] - verts[edges[i][1]] in clip space and writes the visible ones to 'out'
+        // (room for edgeCount), returns how many. Lines entirely outside one frustum plane are dropped, lines leaving the
+        // guard band or crossing near/far are clipped exactly, the rest pass as they are. Edges indexing past vertexCount
+        // are skipped. Classification runs 4 (SSE2) or 8 (AVX2) edges at a time, identical on every level.
+        std::size_t (*clipLines)(const math::Vec4* verts, std::size_t vertexCount, const std::array<int, 2>* edges, std::size_t edgeCount, const ClipViewport& viewport,
+                                 ScreenLine* out);
+
+        // dst[0..count) = color. Large fills bypass the cache with streaming stores.
+        void (*fill)(uint32_t* dst, std::size_t count, uint32_t color);
+
+        // Rasterizes a line whose endpoints are already inside the target.
+        // Pixels are y = y0 + round(i * dy / dx) along the major axis (ties away from y0), identical on every level.
+        void (*line)(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color);
+
+        // Blended twins of fill and line for a premultiplied color (see color.hpp), same pixel coverage.
+        // 4 (SSE2) or 8 (AVX2) pixels per step in 16-bit lanes with exact /255 rounding, identical on every level.
+        void (*blendFill)(uint32_t* dst, std::size_t count, uint32_t color, color::BlendMode mode);
+        void (*blendLine)(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode);
+
+        // line and blendLine into a tiled target (see TiledOffset), same pixels
+        void (*lineTiled)(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color);
+        void (*blendLineTiled)(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode);
+
+        // Sprite rows (see atlas.hpp): plain copy, color-keyed copy (pixels whose RGB equals 'key' are skipped),
+        // premultiplied src-over. The framebuffer's top byte is always written as zero.
+        void (*copyRow)(uint32_t* dst, const uint32_t* src, std::size_t count);
+        void (*keyRow)(uint32_t* dst, const uint32_t* src, std::size_t count, uint32_t key);
+        void (*alphaRow)(uint32_t* dst, const uint32_t* src, std::size_t count);
+
+        // Copies one row of tiles (64-byte aligned) to 'rows' <= TILE linear rows of 'width' pixels, 'pitch' apart
+        void (*detileRow)(uint32_t* dst, std::size_t pitch, const uint32_t* tiles, int width, int rows);
+
+        // Post-processing rows (see postprocess.hpp), identical on every level.
+        // lutRow: out = lut[b] | lut[256 + g] | lut[512 + r], the 3 x 256 entries already shifted into place.
+        // vignetteRow: each channel scaled by (columns[4 * x + c] * rowFactor) >> 16, a 0..65535 fraction.
+        // smoothRow: where the luma (r + 2g + b) range of a pixel and its 4 neighbours reaches max(threshold, max luma / 8),
+        // out = (4 * center + neighbours + 4) / 8 per channel, elsewhere the pixel itself. The edge columns are their own outer neighbours.
+        void (*lutRow)(uint32_t* px, std::size_t count, const uint32_t* lut);
+        void (*vignetteRow)(uint32_t* px, std::size_t count, const uint16_t* columns, uint16_t rowFactor);
+        void (*smoothRow)(uint32_t* out, const uint32_t* above, const uint32_t* row, const uint32_t* below, int width, int threshold);
+
+        // Integrates particles [begin, end), returns how many have run out of life. Same operation order on every level.
+        std::size_t (*integrateParticles)(const ParticleStreams& s, std::size_t begin, std::size_t end, const ParticleStep& step);
+
+        // offsets[i] = pixel index (y * width + x) of point i, or PARTICLE_CULLED outside the frustum or the target
+        void (*projectParticles)(const math::Mat4& viewProj, const float* x, const float* y, const float* z, std::size_t count, const ClipViewport& viewport, int width, int height,
+                                 uint32_t* offsets);
+
+        // s[i] = sin(angles[i]), c[i] = cos(angles[i]), same approximation and error bound as math::sincos
+        void (*sincos)(const float* angles, float* s, float* c, std::size_t count);
+
+        // Texture sampling (see texture.hpp): out[i] = texel at (u[i], v[i]), repeating, or the perspective-correct span.
+        // Bilinear uses 7-bit weights. 4 (SSE2), 8 (AVX2) or 16 (AVX-512, nearest only) texels per step, identical on every level.
+        void (*sampleNearest)(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out);
+        void (*sampleBilinear)(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out);
+        void (*sampleSpanNearest)(const TextureLevel& l, const TextureSpan& span, int count, uint32_t* out);
+        void (*sampleSpanBilinear)(const TextureLevel& l, const TextureSpan& span, int count, uint32_t* out);
+    };
+
+    const KernelTable& Get() noexcept;
+
+    // Bulk Euler (radians, Z * Y * X order) -> quaternion conversion on top of the batched sincos
+    void EulerToQuats(const math::Vec3* angles, math::Quat* out, std::size_t count) noexcept;
+
+    CpuLevel DetectCpuLevel() noexcept;
+    const char* GetCpuLevelName(CpuLevel level) noexcept;
+
+} // namespace x11engine::kernels
@@ -235,6 +235,138 @@ namespace x11engine::math {
         return res;
     }
 
+    // =====================
+    // Fast sin/cos
+    // =====================
+    // Reduces to [-pi/4, pi/4] around the nearest multiple of pi/2 (3-term Cody-Waite),
+    // then evaluates minimax polynomials. Max abs error ~2e-7 for |x| < 8192, NaN/Inf not handled.
+    namespace detail {
+        constexpr float TWO_OVER_PI = 0.636619772367581343f;
+        constexpr float PIO2_1 = 1.5703125f; // pi/2 split so q * PIO2_n is exact in float
+        constexpr float PIO2_2 = 4.837512969970703125e-4f;
+        constexpr float PIO2_3 = 7.54978995489188216e-8f;
+
+        constexpr float SIN_C1 = -1.6666654611e-1f;
+        constexpr float SIN_C2 = 8.3321608736e-3f;
+        constexpr float SIN_C3 = -1.9515295891e-4f;
+        constexpr float COS_C1 = 4.166664568298827e-2f;
+        constexpr float COS_C2 = -1.388731625493765e-3f;
+        constexpr float COS_C3 = 2.443315711809948e-5f;
+    } // namespace detail
+
+    // 4 lanes at once (SSE2)
+    inline void sincos(__m128 x, __m128& s, __m128& c) noexcept {
+        using namespace detail;
+
+        __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI))); // Round to nearest quadrant
+        __m128 qf = _mm_cvtepi32_ps(q);
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PIO2_1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PIO2_3)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 ps = _mm_add_ps(_mm_set1_ps(SIN_C2), _mm_mul_ps(r2, _mm_set1_ps(SIN_C3)));
+        ps = _mm_add_ps(_mm_set1_ps(SIN_C1), _mm_mul_ps(r2, ps));
+        ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r2, r), ps));
+
+        __m128 pc = _mm_add_ps(_mm_set1_ps(COS_C2), _mm_mul_ps(r2, _mm_set1_ps(COS_C3)));
+        pc = _mm_add_ps(_mm_set1_ps(COS_C1), _mm_mul_ps(r2, pc));
+        pc = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+        // Quadrant q: odd swaps sin/cos, sin negated for q & 2, cos negated for (q + 1) & 2
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+        s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps)), sinSign);
+        c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc)), cosSign);
+    }
+
+    inline void sincos(float x, float& s, float& c) noexcept {
+        __m128 vs, vc;
+        sincos(_mm_set_ss(x), vs, vc);
+        s = _mm_cvtss_f32(vs);
+        c = _mm_cvtss_f32(vc);
+    }
+
+    // =====================
+    // Quaternion
+    // =====================
+    struct alignas(16) Quat {
+        float x, y, z, w;
+
+        constexpr Quat() noexcept : x(0), y(0), z(0), w(1) {}
+        constexpr Quat(float x_, float y_, float z_, float w_) noexcept : x(x_), y(y_), z(z_), w(w_) {}
+
+        static constexpr Quat identity() noexcept { return {}; }
+
+        static Quat fromAxisAngle(const Vec3& axis, float angleRadians) noexcept {
+            float s, c;
+            sincos(angleRadians * 0.5f, s, c);
+            Vec3 a = normalize(axis) * s;
+            return {a.x, a.y, a.z, c};
+        }
+
+        // Same convention as Mat4::rotationZ * rotationY * rotationX (X applied first).
+        // All three half-angle sincos run in one SIMD call.
+        static Quat fromEuler(const Vec3& anglesRadians) noexcept {
+            __m128 vs, vc;
+            sincos(_mm_mul_ps(_mm_setr_ps(anglesRadians.x, anglesRadians.y, anglesRadians.z, 0.0f), _mm_set1_ps(0.5f)), vs, vc);
+
+            alignas(16) float s[4], c[4];
+            _mm_store_ps(s, vs);
+            _mm_store_ps(c, vc);
+
+            return {s[0] * c[1] * c[2] - c[0] * s[1] * s[2], c[0] * s[1] * c[2] + s[0] * c[1] * s[2], c[0] * c[1] * s[2] - s[0] * s[1] * c[2], c[0] * c[1] * c[2] + s[0] * s[1] * s[2]};
+        }
+
+        // Rotation part as a matrix (expects a unit quaternion)
+        Mat4 toMat4() const noexcept {
+            float xx = x * x, yy = y * y, zz = z * z;
+            float xy = x * y, xz = x * z, yz = y * z;
+            float wx = w * x, wy = w * y, wz = w * z;
+
+            return {{1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy), 0},
+                    {2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx), 0},
+                    {2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy), 0},
+                    {0, 0, 0, 1}};
+        }
+    };
+
+    // Hamilton product: (a * b) applies b first, then a
+    constexpr Quat operator*(const Quat& a, const Quat& b) noexcept {
+        return {a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x, a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+                a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+    }
+
+    constexpr Quat conjugate(const Quat& q) noexcept { return {-q.x, -q.y, -q.z, q.w}; }
+
+    inline Quat normalize(const Quat& q) noexcept {
+        float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        if (len <= 0.0f)
+            return {};
+        float inv = 1.0f / len;
+        return {q.x * inv, q.y * inv, q.z * inv, q.w * inv};
+    }
+
+    // v' = v + 2w(u x v) + 2u x (u x v), u = q.xyz
+    constexpr Vec3 rotate(const Quat& q, const Vec3& v) noexcept {
+        Vec3 u{q.x, q.y, q.z};
+        Vec3 t = cross(u, v) * 2.0f;
+        return v + t * q.w + cross(u, t);
+    }
+
+    // Translation * Rotation * Scale composed directly, without any matrix products
+    inline Mat4 composeTRS(const Vec3& t, const Quat& q, const Vec3& s) noexcept {
+        Mat4 m = q.toMat4();
+        m.c0 = m.c0 * s.x;
+        m.c1 = m.c1 * s.y;
+        m.c2 = m.c2 * s.z;
+        m.c3 = {t.x, t.y, t.z, 1.0f};
+        return m;
+    }
+
     // =====================
     // Transform helpers
     // =====================
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace x11engine::memory {
+
+    constexpr std::size_t CACHE_LINE = 64;             // Alignment for SIMD streaming stores
+    constexpr std::size_t HUGE_PAGE = 2 * 1024 * 1024; // Transparent huge page size on x86-64
+
+    // Allocates 'bytes' aligned to 'alignment' (power of two, >= CACHE_LINE).
+    // With 'hugePages', large blocks are aligned to HUGE_PAGE and advised with MADV_HUGEPAGE.
+    // Returns nullptr on failure. Release with FreeAligned.
+    void* AllocateAligned(std::size_t bytes, std::size_t alignment = CACHE_LINE, bool hugePages = false) noexcept;
+    void FreeAligned(void* ptr) noexcept;
+
+    constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment) noexcept { return (value + alignment - 1) & ~(alignment - 1); }
+
+} // namespace x11engine::memory
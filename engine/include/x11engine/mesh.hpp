@@ -0,0 +1,99 @@
+#pragma once
+
+#include "x11engine/objects.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace x11engine::objects {
+
+    // --- Binary Mesh Format (.xmesh) ---
+    // [MeshFileHeader][vertices: float x,y,z][edges: int32 a,b][faces: uint32 a,b,c]
+    // Every array starts on a 64-byte boundary so a mapped file can be used in place.
+
+    constexpr uint32_t MESH_FILE_MAGIC = 0x48534D58; // "XMSH" little-endian
+    constexpr uint32_t MESH_FILE_VERSION = 1;
+
+    using Face = std::array<uint32_t, 3>;
+
+    struct MeshFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t edgeCount;
+        uint32_t faceCount;
+        uint32_t reserved;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint64_t vertexOffset; // Byte offsets from the start of the file
+        uint64_t edgeOffset;
+        uint64_t faceOffset;
+        uint64_t fileSize;
+    };
+
+    // The arrays are reinterpreted in place, so the in-memory types must match the file layout
+    static_assert(sizeof(Vec3) == 3 * sizeof(float));
+    static_assert(sizeof(Edge) == 2 * sizeof(int32_t));
+    static_assert(sizeof(Face) == 3 * sizeof(uint32_t));
+
+    // Writes a mesh in the binary format. Bounds are computed from the vertices.
+    bool WriteMeshFile(const std::string& path, std::span<const Vec3> vertices, std::span<const Edge> edges, std::span<const Face> faces);
+
+    // --- Mesh Optimization ---
+    // 1. Welds vertices closer than 'weldEpsilon' (collapsed poles, duplicated seams, split OBJ corners)
+    // 2. Drops zero-length and duplicate edges, degenerate faces and unreferenced vertices
+    // 3. Orders edges as connected walks and renumbers vertices by first use, so consecutive
+    //    edges reuse freshly transformed vertices instead of jumping around the vertex array
+    constexpr float WELD_EPSILON = 1e-5f;
+
+    void OptimizeMesh(std::vector<Vec3>& vertices, std::vector<Edge>& edges, std::vector<Face>& faces, float weldEpsilon = WELD_EPSILON);
+    void OptimizeMesh(std::vector<Vec3>& vertices, std::vector<Edge>& edges, float weldEpsilon = WELD_EPSILON);
+
+    // --- Memory-Mapped Mesh ---
+    // Read-only view of a .xmesh file. Pages are shared between every process mapping the same file.
+    class MappedMesh {
+    public:
+        MappedMesh() = default;
+        ~MappedMesh();
+
+        MappedMesh(const MappedMesh&) = delete;
+        MappedMesh& operator=(const MappedMesh&) = delete;
+        MappedMesh(MappedMesh&& other) noexcept;
+        MappedMesh& operator=(MappedMesh&& other) noexcept;
+
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const { return data != nullptr; }
+
+        std::span<const Vec3> Vertices() const;
+        std::span<const Edge> Edges() const;
+        std::span<const Face> Faces() const;
+
+        Vec3 GetBoundsMin() const { return {header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]}; }
+        Vec3 GetBoundsMax() const { return {header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]}; }
+
+    private:
+        const std::byte* data = nullptr;
+        std::size_t size = 0;
+        const MeshFileHeader* header = nullptr;
+    };
+
+    // --- Mesh Object ---
+    // Draws a mapped mesh as a wireframe. The mesh can be shared between many instances.
+    class MeshObject : public Object3D {
+    public:
+        MeshObject(float x, float y, float z, float size, std::shared_ptr<const MappedMesh> mesh, uint32_t color);
+
+        void Update(const Input& input) override;
+        void Prepare(const ViewContext& view, DrawList& out) const override;
+        collision::Aabb GetLocalBounds() const override; // From the file header
+
+    private:
+        std::shared_ptr<const MappedMesh> mesh;
+    };
+
+} // namespace x11engine::objects
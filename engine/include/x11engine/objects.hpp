@@ -1,10 +1,17 @@
 #pragma once
 
+#include "x11engine/collision.hpp"
+#include "x11engine/kernels.hpp"
 #include "x11engine/math.hpp"
+#include "x11engine/primitives.hpp"
+#include "x11engine/view.hpp"
 
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <span>
+#include <utility>
 
 namespace x11engine {
 
@@ -15,13 +22,39 @@ namespace x11engine {
 
         using math::Mat4;
         using math::Vec3;
+        using math::Vec4;
+
+        // Meshes up to this many vertices get a fully unrolled transform in DrawWireframe
+        constexpr std::size_t UNROLLED_TRANSFORM_LIMIT = 16;
+
+        // Clip-space |x|, |y| up to GUARD_BAND * w skip exact clipping (see kernels::ClipViewport)
+        constexpr float GUARD_BAND = 4.0f;
+
+        // One level of a LOD chain. 'error' is the worst-case distance (model space)
+        // between this level's surface and the exact shape it approximates.
+        struct LodLevel {
+            std::vector<Vec3> vertices;
+            std::vector<Edge> edges;
+            float error;
+        };
+
+        // Screen-space error (in pixels) a level may have before a finer one is picked
+        constexpr float LOD_PIXEL_ERROR = 0.75f;
 
         // --- Base Object Interface ---
         class Object {
         public:
             virtual ~Object() = default;
             virtual void Update(const Input& input) = 0;
-            virtual void Draw(Renderer& renderer, const Mat4& viewProj) = 0;
+
+            // Appends the object's visible lines for one view. Must not modify the object: views are prepared in parallel.
+            virtual void Prepare(const ViewContext& view, DrawList& out) const = 0;
+
+            // Single view over the whole render target: Prepare, then rasterize
+            void Draw(Renderer& renderer, const Mat4& viewProj);
+
+        protected:
+            int lod = 0; // LOD state of Draw (ViewportRenderer keeps one per viewport)
         };
 
         // --- Object3D Base Class ---
@@ -32,16 +65,70 @@ namespace x11engine {
 
             Mat4 GetModelMatrix() const;
 
+            // Model-space box around the geometry (before GetModelMatrix), the unit primitives by default
+            virtual collision::Aabb GetLocalBounds() const { return {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}}; }
+
             Vec3 position;
             Vec3 rotation;
             Vec3 scale;
 
         protected:
             uint32_t color;
-            std::vector<Vec3> vertices;
 
-            // Updated signature to use vector reference for safety and speed
-            void DrawWireframe(Renderer& renderer, const Mat4& viewProj, const std::vector<std::array<int, 2>>& edges);
+            // Frustum test of the world box (GetLocalBounds through 'model')
+            bool IsVisible(const ViewContext& view, const Mat4& model) const { return IsInFrustum(view, collision::TransformAabb(model, GetLocalBounds())); }
+
+            void DrawWireframe(const ViewContext& view, DrawList& out, std::span<const Vec3> verts, std::span<const Edge> edges) const;
+
+            // Compile-time sized meshes: clip-space vertices stay on the stack and small meshes are transformed
+            // by an unrolled sequence the compiler can specialize on the constant vertex data
+            template <std::size_t V, std::size_t E>
+            void DrawWireframe(const ViewContext& view, DrawList& out, const StaticMesh<V, E>& mesh) const {
+                Mat4 model = GetModelMatrix();
+                if (!IsVisible(view, model))
+                    return;
+
+                Mat4 mvp = view.viewProj * model;
+                std::array<Vec4, V> clipSpaceVerts;
+                if constexpr (V <= UNROLLED_TRANSFORM_LIMIT) {
+                    [&]<std::size_t... I>(std::index_sequence<I...>) {
+                        ((clipSpaceVerts[I] = mvp * Vec4{mesh.vertices[I].x, mesh.vertices[I].y, mesh.vertices[I].z, 1.0f}), ...);
+                    }(std::make_index_sequence<V>{});
+                } else {
+                    kernels::Get().transformPoints(mvp, mesh.vertices.data(), clipSpaceVerts.data(), V);
+                }
+                DrawEdges(view, out, clipSpaceVerts, mesh.edges);
+            }
+
+            // Clips the edges against the view frustum in clip space and appends them. Indices out of range are skipped.
+            void DrawEdges(const ViewContext& view, DrawList& out, std::span<const Vec4> clipSpaceVerts, std::span<const Edge> edges) const;
+
+            // Pixels covered by one model-space unit at the object's center (0 when behind the camera)
+            float PixelsPerUnit(const ViewContext& view) const;
+
+            // Coarsest of 'count' levels (sorted finest first, errorOf(i) their model-space error) whose projected
+            // error stays under LOD_PIXEL_ERROR. Coarsening needs twice the margin, so objects near a threshold don't flicker.
+            template <typename ErrorFn>
+            static int SelectLod(int count, int current, float pixelsPerUnit, ErrorFn errorOf) {
+                if (count == 0)
+                    return 0;
+
+                // Behind the camera: nothing is drawn, keep the cheapest level
+                if (pixelsPerUnit <= 0.0f)
+                    return count - 1;
+
+                int level = std::clamp(current, 0, count - 1);
+
+                // Refine while the current level is visibly wrong
+                while (level > 0 && errorOf(level) * pixelsPerUnit > LOD_PIXEL_ERROR)
+                    level--;
+
+                // Coarsen only with margin (hysteresis)
+                while (level + 1 < count && errorOf(level + 1) * pixelsPerUnit * 2.0f <= LOD_PIXEL_ERROR)
+                    level++;
+
+                return level;
+            }
         };
 
         // --- Cube ---
@@ -50,10 +137,8 @@ namespace x11engine {
             Cube(float x, float y, float z, float size, uint32_t color);
 
             void Update(const Input& input) override;
-            void Draw(Renderer& renderer, const Mat4& viewProj) override;
+            void Prepare(const ViewContext& view, DrawList& out) const override;
 
-        private:
-            static const std::vector<std::array<int, 2>> edges;
         };
 
         // --- Triangular Pyramid ---
@@ -62,10 +147,8 @@ namespace x11engine {
             TriangularPyramid(float x, float y, float z, float baseSize, float height, uint32_t color);
 
             void Update(const Input& input) override;
-            void Draw(Renderer& renderer, const Mat4& viewProj) override;
+            void Prepare(const ViewContext& view, DrawList& out) const override;
 
-        private:
-            static const std::vector<std::array<int, 2>> edges;
         };
 
         // --- Square Pyramid ---
@@ -74,23 +157,58 @@ namespace x11engine {
             SquarePyramid(float x, float y, float z, float baseSize, float height, uint32_t color);
 
             void Update(const Input& input) override;
-            void Draw(Renderer& renderer, const Mat4& viewProj) override;
+            void Prepare(const ViewContext& view, DrawList& out) const override;
 
-        private:
-            static const std::vector<std::array<int, 2>> edges;
         };
 
-        // --- UV Sphere ---
-        class Sphere : public Object3D {
+        // --- UV Spheres ---
+        // Both pick a level of detail per frame from their projected size; they only differ in where the geometry comes from.
+        class SphereBase : public Object3D {
         public:
-            Sphere(float x, float y, float z, float radius, int rings, int sectors, uint32_t color);
+            SphereBase(float x, float y, float z, float radius, uint32_t color);
 
             void Update(const Input& input) override;
-            void Draw(Renderer& renderer, const Mat4& viewProj) override;
+            collision::Aabb GetLocalBounds() const override { return {{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}; } // Unit sphere, scaled by the radius
+
+            int GetLod() const { return lod; } // As picked by the last Draw
+        };
+
+        // Tessellation fixed at compile time: every level is a constexpr table and draws through the specialized path
+        template <int Rings, int Sectors>
+        class Sphere : public SphereBase {
+        public:
+            using Lods = primitives::UvSphereLods<std::max(Rings, 2), std::max(Sectors, 3)>;
+
+            Sphere(float x, float y, float z, float radius, uint32_t color) : SphereBase(x, y, z, radius, color) {}
+
+            void Prepare(const ViewContext& view, DrawList& out) const override {
+                *view.lod = SelectLod(static_cast<int>(Lods::COUNT), *view.lod, PixelsPerUnit(view), [](int i) { return Lods::ERRORS[i]; });
+                DrawLevel(view, out, std::make_index_sequence<Lods::COUNT>{});
+            }
+
+            int GetLodCount() const { return static_cast<int>(Lods::COUNT); }
 
         private:
-            // Sphere edges are dynamic based on rings/sectors, so they are not static
-            std::vector<std::array<int, 2>> sphereEdges;
+            template <std::size_t... I>
+            void DrawLevel(const ViewContext& view, DrawList& out, std::index_sequence<I...>) const {
+                ((*view.lod == static_cast<int>(I) ? DrawWireframe(view, out, Lods::template Level<I>()) : void()), ...);
+            }
+        };
+
+        // Tessellation chosen at run time (e.g. from a config), LOD chain built and welded in the constructor
+        class TessellatedSphere : public SphereBase {
+        public:
+            TessellatedSphere(float x, float y, float z, float radius, int rings, int sectors, uint32_t color);
+
+            void Prepare(const ViewContext& view, DrawList& out) const override;
+
+            int GetLodCount() const { return static_cast<int>(lods.size()); }
+
+        private:
+            // Unit sphere at 'rings' x 'sectors', halved per level down to 2 x 3
+            static LodLevel BuildLevel(int rings, int sectors);
+
+            std::vector<LodLevel> lods;
         };
 
     } // namespace objects
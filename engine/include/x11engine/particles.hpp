@@ -0,0 +1,109 @@
+#pragma once
+
+#include "x11engine/color.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/math.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace x11engine {
+
+    class Renderer;
+    class ThreadPool;
+
+    namespace objects {
+
+        using math::Mat4;
+        using math::Vec3;
+
+        struct EmitterConfig {
+            Vec3 position;
+            Vec3 velocity;                // Launch velocity (units per second)
+            float spread = 1.0f;          // Random velocity in [-spread, spread) added per axis
+            float rate = 100.0f;          // Particles per second, 0 only emits on Burst
+            float lifetime = 2.0f;        // Seconds
+            float lifetimeJitter = 0.25f; // Lifetimes vary by up to this fraction
+            uint32_t colorStart = color::WHITE;
+            uint32_t colorEnd = color::GRAY;
+        };
+
+        enum class ParticleStyle {
+            Points,  // One pixel each
+            Streaks, // Line back along the velocity, for sparks and rain
+        };
+
+        // Fixed-capacity particle pool in structure-of-arrays layout: every component is its own stream,
+        // so integration and projection run through the SIMD kernels (kernels::integrateParticles/projectParticles).
+        // Dead particles are swap-removed, the live ones stay packed in [0, count).
+        class ParticleSystem {
+        public:
+            explicit ParticleSystem(std::size_t capacity);
+
+            int AddEmitter(const EmitterConfig& config); // Emitter id, or -1 past 65536 emitters
+            EmitterConfig& GetEmitter(int emitter) { return emitters[emitter].config; }
+            void Burst(int emitter, std::size_t count); // Spawns 'count' particles on the next Update
+
+            void SetAcceleration(const Vec3& acceleration) { this->acceleration = acceleration; } // e.g. gravity
+            void SetDrag(float drag) { this->drag = drag; }                                       // Fraction of the velocity lost per second
+
+            // One fixed step (TICK_RATE): emit, integrate, remove the dead. With 'jobs' the integration is split across its threads.
+            void Update(float dt, ThreadPool* jobs = nullptr);
+
+            // Points are written opaque in particle order (the last one on a pixel wins, the same with or without 'jobs').
+            // Streaks are 'streakTime' seconds of travel long.
+            void Draw(Renderer& renderer, const Mat4& viewProj, ThreadPool* jobs = nullptr, ParticleStyle style = ParticleStyle::Points, float streakTime = 0.05f);
+
+            std::size_t GetCount() const { return count; }
+            std::size_t GetCapacity() const { return capacity; }
+
+        private:
+            static constexpr std::size_t CHUNK = 16384; // Particles per job chunk
+            static constexpr std::size_t BANDS = 64;    // Framebuffer row bands, each written by one thread
+            static constexpr std::size_t GRADIENT_STEPS = 256;
+
+            struct Emitter {
+                EmitterConfig config;
+                float pending = 0.0f; // Fractional particles carried over between steps
+                std::size_t bursts = 0;
+                std::array<uint32_t, GRADIENT_STEPS> gradient{};
+            };
+
+            void Spawn(int emitter, std::size_t spawnCount);
+            void Compact();
+            float Random(); // [-1, 1)
+
+            void DrawPoints(Renderer& renderer, const Mat4& viewProj, ThreadPool* jobs);
+            void DrawStreaks(Renderer& renderer, const Mat4& viewProj, float streakTime);
+            uint32_t ColorOf(std::size_t i) const;
+
+            kernels::ParticleStreams Streams() { return {px.data(), py.data(), pz.data(), vx.data(), vy.data(), vz.data(), life.data()}; }
+
+            std::size_t capacity;
+            std::size_t count;
+
+            // Streams
+            std::vector<float> px, py, pz;
+            std::vector<float> vx, vy, vz;
+            std::vector<float> life;
+            std::vector<float> invLifetime;
+            std::vector<uint16_t> emitterOf;
+
+            std::vector<Emitter> emitters;
+            Vec3 acceleration;
+            float drag;
+            uint32_t seed;
+
+            // Draw scratch: projected offsets, then the points regrouped by band
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> bandOffsets;
+            std::vector<uint32_t> bandColors;
+            std::vector<uint32_t> chunkBands; // [chunk * BANDS + band]: counts, then write cursors
+            std::array<std::size_t, BANDS + 1> bandStart;
+        };
+
+    } // namespace objects
+
+} // namespace x11engine
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <X11/Xlib.h>
+#include <cstdint>
+
+namespace x11engine {
+
+    // The renderer always draws 0xRRGGBB (see color.hpp). These are the layouts it can hand to X.
+    enum class PixelFormat {
+        XRGB8888, // Native: framebuffer goes to X untouched
+        XBGR8888, // Red and blue swapped
+        RGB565,
+        RGB555,
+        RGB888,   // Packed 24bpp
+        Generic,  // Any other TrueColor layout, converted through the channel masks (scalar)
+    };
+
+    struct PixelFormatInfo {
+        PixelFormat format;
+        int depth;
+        int bitsPerPixel;
+        int scanlinePad; // Row alignment in bits the server expects for this depth
+        bool swapBytes; // Server byte order differs from ours
+        uint32_t redMask;
+        uint32_t greenMask;
+        uint32_t blueMask;
+    };
+
+    // Converts one row of 'count' 0xRRGGBB pixels into the visual's layout at 'dst'
+    using ConvertRowFn = void (*)(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo& info);
+
+    // Inspects the visual's masks, depth, pixmap format and the server's image byte order
+    PixelFormatInfo DescribeVisual(Display* display, const Visual* visual, int depth);
+
+    // Same classification from raw connection setup values (for backends that don't go through Xlib)
+    PixelFormatInfo DescribePixelFormat(int depth, int bitsPerPixel, int scanlinePad, uint32_t redMask, uint32_t greenMask, uint32_t blueMask, bool serverLsb, bool trueColor);
+
+    // Bytes per row of a 'width' pixel image in this format, padded to the scanline unit
+    inline int GetBytesPerLine(const PixelFormatInfo& info, int width) {
+        int pad = info.scanlinePad > 0 ? info.scanlinePad : 32;
+        return ((width * info.bitsPerPixel + pad - 1) / pad) * pad / 8;
+    }
+
+    // Row converter specialized for the format, or nullptr when the framebuffer can be used as-is
+    ConvertRowFn GetRowConverter(const PixelFormatInfo& info);
+
+    const char* GetPixelFormatName(PixelFormat format);
+
+} // namespace x11engine
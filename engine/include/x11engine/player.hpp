@@ -9,12 +9,15 @@ namespace x11engine::objects {
         Player(float x, float y, float z, float size, uint32_t color);
 
         void Update(const Input& input) override;
-        void Draw(Renderer& renderer, const Mat4& viewProj) override;
+        void Prepare(const ViewContext& view, DrawList& out) const override;
+
+        // Collision response: back to where the last Update started (see collision::CollisionWorld)
+        void RevertMove() { position = previousPosition; }
 
     private:
-        static const std::vector<std::array<int, 2>> edges;
         math::Vec3 forward;
         math::Vec3 up;
+        math::Vec3 previousPosition;
     };
 
 } // namespace x11engine::objects
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace x11engine {
+
+    class Renderer;
+    class ThreadPool;
+
+    // Per-channel tone curves: out = curve[in]
+    struct ColorCurves {
+        std::array<uint8_t, 256> r;
+        std::array<uint8_t, 256> g;
+        std::array<uint8_t, 256> b;
+
+        static ColorCurves Identity();
+    };
+
+    // Full-screen effects on the finished frame. The engine runs them between OnRender and Present.
+    // Effects apply in the order they were added. Neighbouring per-pixel effects are fused: each row is read from the
+    // framebuffer once and goes through all of them while it sits in L1, and consecutive lookup effects (gamma, curves) are
+    // composed into a single table. Edge smoothing reads the rows around a pixel, so it starts a new stage.
+    // Every stage is split into row bands across the worker threads.
+    class PostProcessor {
+    public:
+        void AddGamma(float gamma);                       // out = in^(1 / gamma)
+        void AddCurves(const ColorCurves& curves);        // Color grading through per-channel lookup tables
+        void AddVignette(float strength);                 // Darkens towards the borders: 0 none, 1 black corners
+        void AddEdgeSmoothing(float threshold = 0.0625f); // FXAA-style: blends pixels whose local luma contrast exceeds 'threshold' (0..1) with their neighbours
+        void Clear();
+        bool IsEmpty() const { return effects.empty(); }
+
+        // Runs every effect over the renderer's framebuffer (either layout). Allocates only when the effects or the size change.
+        void Apply(Renderer& renderer, ThreadPool* jobs = nullptr);
+
+    private:
+        enum class EffectType {
+            Lut,
+            Vignette,
+            Smooth,
+        };
+
+        struct Effect {
+            EffectType type;
+            std::array<uint8_t, 768> curves; // Lut: b, g, r
+            float value;                     // Vignette strength, smoothing threshold
+        };
+
+        struct Op {
+            EffectType type;
+            std::array<uint8_t, 768> curves;
+            std::array<uint32_t, 768> table; // curves shifted into place for kernels::lutRow
+            float strength;
+            std::vector<uint16_t> columns; // Vignette: 4 factors per pixel (one per channel)
+            std::vector<uint16_t> rows;    // Vignette: one factor per row
+        };
+
+        // Optional smoothing of the stage's input, then ops [firstOp, firstOp + opCount) on every row
+        struct Stage {
+            bool smooth;
+            int threshold; // Luma units (0..1020)
+            std::size_t firstOp;
+            std::size_t opCount;
+        };
+
+        void Compile();                    // effects -> ops, stages
+        void Resize(int width, int height); // Rebuild the size-dependent tables
+        void RunOps(const Stage& stage, uint32_t* row, int y) const;
+        void RunBand(Renderer& renderer, const Stage& stage, std::size_t band, int y0, int y1);
+
+        std::vector<Effect> effects;
+        std::vector<Op> ops;
+        std::vector<Stage> stages;
+        bool dirty = false;
+        int width = 0;
+        int height = 0;
+
+        // Row buffers per band: smoothing window (above, center, below), output, saved band borders (above, below)
+        static constexpr std::size_t BAND_ROWS = 6;
+        std::vector<uint32_t> scratch;
+    };
+
+} // namespace x11engine
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "x11engine/math.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace x11engine::objects {
+
+    using math::Vec3;
+
+    using Edge = std::array<int, 2>;
+
+    // Geometry whose size is known at compile time. Lives in read-only data, nothing is built at startup.
+    template <std::size_t VertexCount, std::size_t EdgeCount>
+    struct StaticMesh {
+        static constexpr std::size_t VERTEX_COUNT = VertexCount;
+        static constexpr std::size_t EDGE_COUNT = EdgeCount;
+
+        std::array<Vec3, VertexCount> vertices;
+        std::array<Edge, EdgeCount> edges;
+    };
+
+    namespace primitives {
+
+        // --- Unit primitives, centered on the origin ---
+
+        inline constexpr StaticMesh<8, 12> CUBE = {
+            {{{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}}},
+            {{
+                {0, 1}, {1, 2}, {2, 3}, {3, 0}, // Bottom face
+                {4, 5}, {5, 6}, {6, 7}, {7, 4}, // Top face
+                {0, 4}, {1, 5}, {2, 6}, {3, 7}  // Connecting pillars
+            }},
+        };
+
+        // Equilateral base: the back corner sits sqrt(3)/4 behind the center, the front edge half that in front
+        inline constexpr float TRIANGLE_OFFSET = 0.4330127019f;
+
+        inline constexpr StaticMesh<4, 6> TRIANGULAR_PYRAMID = {
+            {{
+                {-0.5f, -0.5f, TRIANGLE_OFFSET * 0.5f}, // 0: Base Left
+                {0.5f, -0.5f, TRIANGLE_OFFSET * 0.5f},  // 1: Base Right
+                {0.0f, -0.5f, -TRIANGLE_OFFSET},        // 2: Base Top (Back)
+                {0.0f, 0.5f, 0.0f}                      // 3: Apex
+            }},
+            {{
+                {0, 1}, {1, 2}, {2, 0}, // Base
+                {0, 3}, {1, 3}, {2, 3}  // Sides
+            }},
+        };
+
+        inline constexpr StaticMesh<5, 8> SQUARE_PYRAMID = {
+            {{
+                {-0.5f, -0.5f, -0.5f}, // 0
+                {0.5f, -0.5f, -0.5f},  // 1
+                {0.5f, -0.5f, 0.5f},   // 2
+                {-0.5f, -0.5f, 0.5f},  // 3
+                {0.0f, 0.5f, 0.0f}     // 4 Apex
+            }},
+            {{
+                {0, 1}, {1, 2}, {2, 3}, {3, 0}, // Base
+                {0, 4}, {1, 4}, {2, 4}, {3, 4}  // Sides
+            }},
+        };
+
+        // --- Compile-time trigonometry (double precision, only used to build tables) ---
+
+        namespace detail {
+            inline constexpr double PI = 3.14159265358979323846;
+
+            constexpr double Sin(double x) {
+                // Reduce to [-pi, pi], then the Taylor series converges to double precision within 30 terms
+                while (x > PI)
+                    x -= 2.0 * PI;
+                while (x < -PI)
+                    x += 2.0 * PI;
+
+                double term = x;
+                double sum = x;
+                for (int n = 1; n < 30; ++n) {
+                    term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr double Cos(double x) { return Sin(x + PI * 0.5); }
+        } // namespace detail
+
+        // --- UV sphere ---
+        // The poles are single vertices and the seam is shared, i.e. the welded grid the runtime OptimizeMesh would produce.
+
+        template <int Rings, int Sectors>
+        using UvSphereMesh = StaticMesh<2 + (Rings - 1) * Sectors, (Rings - 1) * Sectors + Rings * Sectors>;
+
+        template <int Rings, int Sectors>
+        constexpr UvSphereMesh<Rings, Sectors> MakeUvSphere() {
+            static_assert(Rings >= 2 && Sectors >= 3, "A UV sphere needs at least 2 rings and 3 sectors");
+
+            UvSphereMesh<Rings, Sectors> mesh{};
+            constexpr int NORTH = 0;
+            constexpr int SOUTH = static_cast<int>(UvSphereMesh<Rings, Sectors>::VERTEX_COUNT) - 1;
+            auto index = [](int ring, int sector) { return 1 + (ring - 1) * Sectors + sector % Sectors; };
+
+            // 1. Vertices: pole, inner rings top to bottom, pole
+            mesh.vertices[NORTH] = {0.0f, 1.0f, 0.0f};
+            for (int r = 1; r < Rings; ++r) {
+                double phi = detail::PI * r / Rings;
+                for (int s = 0; s < Sectors; ++s) {
+                    double theta = 2.0 * detail::PI * s / Sectors;
+                    mesh.vertices[index(r, s)] = {static_cast<float>(detail::Cos(theta) * detail::Sin(phi)), static_cast<float>(detail::Cos(phi)),
+                                                  static_cast<float>(detail::Sin(theta) * detail::Sin(phi))};
+                }
+            }
+            mesh.vertices[SOUTH] = {0.0f, -1.0f, 0.0f};
+
+            // 2. Edges: per sector the meridian segment from the ring above, then the ring segment to the next sector
+            std::size_t e = 0;
+            for (int r = 1; r <= Rings; ++r) {
+                for (int s = 0; s < Sectors; ++s) {
+                    int above = r == 1 ? NORTH : index(r - 1, s);
+                    int current = r == Rings ? SOUTH : index(r, s);
+                    mesh.edges[e++] = {above, current};
+                    if (r < Rings)
+                        mesh.edges[e++] = {current, index(r, s + 1)};
+                }
+            }
+            return mesh;
+        }
+
+        // Depth of the widest facet's center below the unit sphere (see Sphere LOD selection)
+        constexpr float UvSphereError(int rings, int sectors) { return static_cast<float>(1.0 - detail::Cos(detail::PI / sectors) * detail::Cos(detail::PI / (2.0 * rings))); }
+
+        // LOD chain of a UV sphere: tessellation halves per level down to 2 x 3, like TessellatedSphere
+        template <int Rings, int Sectors>
+        struct UvSphereLods {
+            static constexpr int NEXT_RINGS = std::max(Rings / 2, 2);
+            static constexpr int NEXT_SECTORS = std::max(Sectors / 2, 3);
+            static constexpr bool LAST = NEXT_RINGS == Rings && NEXT_SECTORS == Sectors;
+
+            using Next = UvSphereLods<NEXT_RINGS, NEXT_SECTORS>;
+
+            static constexpr UvSphereMesh<Rings, Sectors> MESH = MakeUvSphere<Rings, Sectors>();
+            static constexpr float ERROR = UvSphereError(Rings, Sectors);
+
+            static constexpr std::size_t COUNT = [] {
+                if constexpr (LAST)
+                    return std::size_t{1};
+                else
+                    return 1 + Next::COUNT;
+            }();
+
+            // Mesh of level I (0 = finest)
+            template <std::size_t I>
+            static constexpr const auto& Level() {
+                if constexpr (I == 0)
+                    return MESH;
+                else
+                    return Next::template Level<I - 1>();
+            }
+
+            static constexpr std::array<float, COUNT> ERRORS = [] {
+                std::array<float, COUNT> errors{};
+                errors[0] = ERROR;
+                if constexpr (!LAST) {
+                    for (std::size_t i = 1; i < COUNT; ++i)
+                        errors[i] = Next::ERRORS[i - 1];
+                }
+                return errors;
+            }();
+        };
+
+    } // namespace primitives
+
+} // namespace x11engine::objects
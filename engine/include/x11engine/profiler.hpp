@@ -0,0 +1,124 @@
+#pragma once
+
+#include "x11engine/allocations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace x11engine {
+
+    // Coarse steps of one Engine::Run iteration
+    enum class FramePhase {
+        Events,
+        Update,  // All fixed ticks of the frame
+        Render,  // Application::OnRender
+        Post,    // Post-processing (see postprocess.hpp)
+        Present, // Upscale, convert, hand to the window backend (and capture)
+        Count,
+    };
+
+    constexpr std::size_t FRAME_PHASE_COUNT = static_cast<std::size_t>(FramePhase::Count);
+
+    // Log-scale buckets, 8 per doubling (under 10% wide) from 0.1 ms; the first holds everything below that, the last
+    // everything from about 22 s up. Never allocates.
+    class LatencyHistogram {
+    public:
+        static constexpr std::size_t BUCKETS = 144;
+        static constexpr std::size_t STEPS_PER_DOUBLING = 8;
+        static constexpr double MIN_LATENCY = 0.0001; // Seconds, upper edge of the first bucket
+
+        void Record(double seconds);
+        void Clear() { *this = {}; }
+
+        uint64_t GetCount() const { return count; }
+        double GetMean() const { return count ? sum / count : 0.0; }
+        double GetMax() const { return max; }
+        double GetPercentile(double p) const { return std::min(Percentile(buckets, p), max); } // Never above the largest latency seen
+        const std::array<uint64_t, BUCKETS>& GetBuckets() const { return buckets; }
+
+        // Nearest rank, reported as the upper edge of its bucket (seconds), +infinity when it falls in the last bucket.
+        // Also works on the difference of two snapshots.
+        static double Percentile(const std::array<uint64_t, BUCKETS>& buckets, double p);
+        static double GetBucketUpperEdge(std::size_t bucket);
+
+    private:
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        double sum = 0.0;
+        double max = 0.0;
+    };
+
+    struct FrameTiming {
+        uint64_t frame;
+        double total; // Seconds from BeginFrame to EndFrame (excludes the FPS-cap sleep)
+        std::array<double, FRAME_PHASE_COUNT> phases;
+
+        // Heap activity of the profiling thread (all zero unless it is tracked, see allocations.hpp)
+        memory::AllocationStats allocations;
+        std::array<memory::AllocationStats, FRAME_PHASE_COUNT> phaseAllocations;
+
+        // Key and button presses this frame was the first to show, and the longest of their input-to-present latencies
+        uint32_t inputEvents;
+        double inputLatency;
+    };
+
+    // Per-frame phase timer. Timestamps come from the monotonic clock; nothing allocates.
+    // Must be driven from a single thread, allocation counts are that thread's.
+    class Profiler {
+    public:
+        void BeginFrame();
+        void EndFrame();
+
+        void BeginPhase(FramePhase phase);
+        void EndPhase(FramePhase phase); // Repeated Begin/End pairs within a frame accumulate
+
+        // Seconds from an input event's arrival to the end of the Present that first showed its effect
+        void RecordInputLatency(double seconds);
+        const LatencyHistogram& GetInputLatency() const { return inputLatency; } // Every event since the start
+
+        const FrameTiming& GetLastFrame() const { return last; }
+        uint64_t GetFrameCount() const { return frames; }
+
+        static double Now(); // Seconds, CLOCK_MONOTONIC
+
+    private:
+        FrameTiming current{};
+        FrameTiming last{};
+        double frameStart = 0.0;
+        std::array<double, FRAME_PHASE_COUNT> phaseStart{};
+        memory::AllocationStats frameAllocStart{};
+        std::array<memory::AllocationStats, FRAME_PHASE_COUNT> phaseAllocStart{};
+        LatencyHistogram inputLatency;
+        uint64_t frames = 0;
+    };
+
+    class ScopedPhase {
+    public:
+        ScopedPhase(Profiler& profiler, FramePhase phase) : profiler(profiler), phase(phase) { profiler.BeginPhase(phase); }
+        ~ScopedPhase() { profiler.EndPhase(phase); }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        Profiler& profiler;
+        FramePhase phase;
+    };
+
+    struct TimingSummary {
+        double mean;
+        double p50;
+        double p95;
+        double p99;
+        double max;
+    };
+
+    // Nearest-rank percentiles. Sorts 'samples' in place.
+    TimingSummary Summarize(std::vector<double>& samples);
+
+    const char* GetFramePhaseName(FramePhase phase);
+
+} // namespace x11engine
@@ -1,43 +1,163 @@
 #pragma once
 
+#include "x11engine/atlas.hpp"
 #include "x11engine/color.hpp"
 #include "x11engine/frame.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/pixelformat.hpp"
+#include "x11engine/texture.hpp"
+#include "x11engine/view.hpp"
 
-#include <X11/Xlib.h>
-#include <X11/Xutil.h>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <span>
+#include <vector>
 
 namespace x11engine {
 
+    enum class UpscaleFilter {
+        Nearest,
+        Bilinear,
+    };
+
+    // How the framebuffer is stored. Tiled keeps kernels::TILE x TILE blocks contiguous, so steep and diagonal lines
+    // touch a new cache line every TILE pixels instead of every pixel; Present detiles it into a linear image.
+    enum class FramebufferLayout {
+        Linear,
+        Tiled,
+    };
+
+    // What the renderer drew since the last ResetStats
+    struct RenderStats {
+        uint64_t objects; // Reported by the drawing code (CountObjects)
+        uint64_t lines;   // Lines that survived clipping
+        uint64_t pixels;  // Written by lines, spans, rects, sprites and textured spans
+    };
+
     class Renderer {
     public:
         Renderer(int width, int height);
         ~Renderer();
 
-        bool Init(const Frame& frame);                                // Initialize X-specific resources (XImage)
-        void Present(const Frame& frame);                             // Pushes the framebuffer to the X11 Window
+        bool Init(const Frame& frame);                                // Pick up the window's pixel format
+        void Present(Frame& frame);                                   // Pushes the framebuffer to the window through the frame's backend
         void Clear(uint32_t color);                                   // Clear the framebuffer with a specific color
-        void Resize(const Frame& frame, int newWidth, int newHeight); // Resize the framebuffer
+        void Resize(const Frame& frame, int newWidth, int newHeight); // Resize the framebuffer (reuses capacity when possible)
+
+        // Dynamic resolution: draw into a (width * scale, height * scale) target, upscaled on Present
+        void SetRenderScale(const Frame& frame, float scale);
+        void SetUpscaleFilter(UpscaleFilter newFilter) { filter = newFilter; }
+
+        // Switching clears the framebuffer; everything drawn after that lands in the new layout
+        void SetLayout(FramebufferLayout newLayout);
+        FramebufferLayout GetLayout() const { return layout; }
+
+        // Clipped, rasterized by the dispatched line kernels. Blended modes take premultiplied colors (color::RGBA).
+        void DrawLine(int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode = color::BlendMode::Replace);
+        void FillSpan(int x0, int x1, int y, uint32_t color, color::BlendMode mode = color::BlendMode::Replace); // Horizontal run [x0, x1] on row y
+
+        // Prepared lines (see objects::Object::Prepare) in 'rect' coordinates, scissored to it. Only touches pixels
+        // inside 'rect', so threads may draw disjoint rects at the same time.
+        void DrawLines(const ViewRect& rect, std::span<const kernels::ScreenLine> lines, std::span<const uint32_t> colors, color::BlendMode mode = color::BlendMode::Replace);
+        void FillRect(const ViewRect& rect, uint32_t color);
+
+        // Sprites: top-left at (x, y), clipped to the target. Rows go through the dispatched copy/key/alpha kernels.
+        void Blit(const Atlas& atlas, int sprite, int x, int y, BlitMode mode = BlitMode::Opaque, int scale = 1, bool flipX = false);
+        void BlitBatch(const Atlas& atlas, std::span<const SpriteDraw> draws, BlitMode mode = BlitMode::Opaque);
+
+        // Perspective-correct textured run [x0, x1] on row y; 'span' describes pixel x0 (clipped like FillSpan).
+        // ColorKey skips texels equal to color::MAGENTA.
+        void DrawTexturedSpan(int x0, int x1, int y, const Texture& texture, TextureSpan span, TextureFilter filter = TextureFilter::Bilinear, BlitMode mode = BlitMode::Opaque);
 
-        void DrawLine(int x0, int y0, int x1, int y1, uint32_t color); // Bresenham's line algorithm
+        uint32_t* GetFramebuffer() { return framebuffer; } // In the current layout, address pixels with GetPixelOffset
+        std::size_t GetPixelOffset(int x, int y) const { return layout == FramebufferLayout::Tiled ? kernels::TiledOffset(x, y, tilesPerRow) : static_cast<std::size_t>(y) * width + x; }
+        const uint32_t* GetPresentedImage() const; // Window-sized 0xRRGGBB, valid after Present
 
-        uint32_t* GetFramebuffer() { return framebuffer; }
+        // Row y in linear order, whatever the layout: a pointer into the framebuffer when it is linear, nullptr when tiled
+        // (then copy rows out and back with ReadRow / WriteRow). Rows are GetWidth() pixels.
+        uint32_t* GetLinearRow(int y) { return layout == FramebufferLayout::Linear ? framebuffer + static_cast<std::size_t>(y) * width : nullptr; }
+        void ReadRow(int y, uint32_t* dst) const;
+        void WriteRow(int y, const uint32_t* src);
         int GetWidth() const { return width; }
         int GetHeight() const { return height; }
+        int GetWindowWidth() const { return windowWidth; }
+        int GetWindowHeight() const { return windowHeight; }
+        float GetRenderScale() const { return renderScale; }
+        const PixelFormatInfo& GetPixelFormat() const { return pixelFormat; }
+
+        // Counters are relaxed atomics bumped once per draw call, so threads drawing disjoint rects may share them
+        RenderStats GetStats() const { return {statObjects.load(std::memory_order_relaxed), statLines.load(std::memory_order_relaxed), statPixels.load(std::memory_order_relaxed)}; }
+        void ResetStats();
+        void CountObjects(uint64_t count) { statObjects.fetch_add(count, std::memory_order_relaxed); }
+        void CountPixels(uint64_t count) { statPixels.fetch_add(count, std::memory_order_relaxed); } // For code writing GetFramebuffer() directly
 
     private:
+        void UpdateTargets();                   // Recompute the render size and the lookups that depend on it
+        void UpdateConvertTarget();
+        bool IsScaled() const { return width != windowWidth || height != windowHeight; }
+
+        static void Reserve(uint32_t*& buffer, std::size_t& capacity, std::size_t pixels); // Grow geometrically, never shrinks
+        std::size_t GetStoragePixels() const;                                                 // Framebuffer size in the current layout
+        void Detile();                                                                        // framebuffer -> linearBuffer
+
+        // Calls run(dst, i, n) for the pieces of row y's [x, x + count) that are contiguous in memory, i counting from x:
+        // the whole run when linear, up to TILE pixels at a time when tiled
+        template <class Run>
+        void ForEachRun(int x, int y, std::size_t count, Run&& run) const;
         void MapToScreenCoord(int& x, int& y); // Transform from Center-Origin to Top-Left-Origin
 
+        void BlitSprite(const Atlas& atlas, const SpriteDraw& draw, BlitMode mode);
+
+        int RasterLine(int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode); // Endpoints inside the target, returns the pixels drawn
+        void Span(int x0, int x1, int y, uint32_t color, color::BlendMode mode);               // FillSpan without clipping or counting
+        void Count(uint64_t lines, uint64_t pixels) {
+            statLines.fetch_add(lines, std::memory_order_relaxed);
+            statPixels.fetch_add(pixels, std::memory_order_relaxed);
+        }
+
         void DrawPixelScreen(int x, int y, uint32_t color);
         void DrawPixel(int x, int y, uint32_t color);
 
     private:
-        int width;
+        int width;  // Render target size, what all Draw* calls see
         int height;
-        uint32_t* framebuffer;
-        XImage* image;
+        int windowWidth; // Presented size
+        int windowHeight;
+        float renderScale;
+        UpscaleFilter filter;
+
+        uint32_t* framebuffer; // 64-byte aligned, see memory.hpp
+        std::size_t capacity;  // Allocated size in pixels (>= GetStoragePixels())
+
+        FramebufferLayout layout;
+        int tilesPerRow;
+        uint32_t* linearBuffer; // Render-sized detile target, only used while tiled
+        std::size_t linearCapacity;
+
+        uint32_t* presentBuffer; // Window-sized upscale target, only used while scaled
+        std::size_t presentCapacity;
+
+        // Per-column source lookups for the upscale blit (rebuilt when sizes change)
+        std::vector<int> upscaleNearestX;
+        std::vector<int> upscaleX0;
+        std::vector<int> upscaleX1;
+        std::vector<int16_t> upscaleWX;
+
+        std::vector<uint32_t> blitRow; // Flipped/scaled sprite row or sampled texels, reused between draws
+
+        // Visual negotiation: when the window's layout isn't 0xRRGGBB, Present converts into convertBuffer
+        PixelFormatInfo pixelFormat;
+        ConvertRowFn convertRow;
+        uint32_t* convertBuffer;
+        std::size_t convertCapacity;
+        int convertPitch; // Bytes per row in convertBuffer
+
+        std::atomic<uint64_t> statObjects{0};
+        std::atomic<uint64_t> statLines{0};
+        std::atomic<uint64_t> statPixels{0};
     };
 
 } // namespace x11engine
\ No newline at end of file
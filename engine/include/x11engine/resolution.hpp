@@ -0,0 +1,28 @@
+#pragma once
+
+namespace x11engine {
+
+    // Picks the internal render scale from measured frame times so the frame budget holds.
+    // Cost is roughly proportional to the pixel count, i.e. to scale^2.
+    class ResolutionController {
+    public:
+        ResolutionController(double targetFrameTime, float minScale = 0.5f, float maxScale = 1.0f);
+
+        // Feed the CPU time spent on the last frame (excluding any FPS-cap sleep). Returns the new scale.
+        float Update(double frameTime);
+
+        void SetTargetFrameTime(double seconds) { budget = seconds; }
+        void SetLimits(float newMin, float newMax);
+        float GetScale() const { return scale; }
+
+    private:
+        double budget;
+        float minScale;
+        float maxScale;
+        float scale;
+
+        double average;  // Exponential moving average of frame time
+        int cooldown;    // Frames to wait after a change so the average reflects the new scale
+    };
+
+} // namespace x11engine
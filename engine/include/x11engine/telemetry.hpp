@@ -0,0 +1,111 @@
+#pragma once
+
+#include "x11engine/profiler.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+namespace x11engine {
+
+    constexpr uint32_t TELEMETRY_MAGIC = 0x54313158; // "X11T"
+    constexpr uint32_t TELEMETRY_VERSION = 3;
+
+    // One frame's worth of metrics. Per-frame values describe the last finished frame, totals run since the writer opened,
+    // so a reader can turn two samples into rates. Only 8-byte fields: the block is copied word by word.
+    struct TelemetrySample {
+        uint64_t frame;
+        double time;      // Seconds, CLOCK_MONOTONIC (shared by every process on the host)
+        double frameTime; // FrameTiming::total
+        double phases[FRAME_PHASE_COUNT];
+
+        // Last frame (see Renderer::GetStats)
+        uint64_t objects;
+        uint64_t lines;
+        uint64_t pixels;
+        uint64_t allocations; // Main loop heap activity, zero unless allocation tracking is on (see allocations.hpp)
+        uint64_t allocatedBytes;
+        uint64_t inputEvents; // Presses first shown by the last frame (FrameTiming::inputEvents)
+        double inputLatency;  // and the longest of their latencies
+
+        // Since the writer opened
+        uint64_t frames;
+        double totalFrameTime;
+        uint64_t totalObjects;
+        uint64_t totalLines;
+        uint64_t totalPixels;
+        uint64_t totalAllocations;
+
+        // Input-to-present latency since the engine started (Profiler::GetInputLatency). Subtract the buckets of an
+        // earlier sample and use LatencyHistogram::Percentile for the latencies in between.
+        uint64_t inputLatencyCount;
+        double inputLatencyMean;
+        uint64_t inputLatencyBuckets[LatencyHistogram::BUCKETS];
+    };
+
+    // Layout of the shared memory object. 'sequence' is a seqlock: odd while the writer is inside Publish.
+    struct TelemetryBlock {
+        uint32_t magic; // Stored last when the block is created
+        uint32_t version;
+        int64_t pid;
+        uint64_t phaseCount;
+        std::atomic<uint64_t> sequence;
+        TelemetrySample sample;
+    };
+
+    static_assert(sizeof(TelemetrySample) % sizeof(uint64_t) == 0);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock is shared between processes");
+
+    // "/x11engine.<pid>", what X11ENGINE_TELEMETRY=1 uses. Readers find instances as /dev/shm/x11engine.*
+    std::string GetDefaultTelemetryName(pid_t pid);
+
+    // Publishes samples into a POSIX shared memory object. Open creates and maps it (the only syscalls); Publish is a
+    // handful of plain stores with no locks or I/O, so readers never slow the render loop and a stuck reader cannot block it.
+    class TelemetryWriter {
+    public:
+        TelemetryWriter() = default;
+        ~TelemetryWriter();
+
+        TelemetryWriter(const TelemetryWriter&) = delete;
+        TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+        bool Open(const std::string& name);
+        void Close(); // Unmaps and unlinks the object
+
+        bool IsOpen() const { return block != nullptr; }
+        const std::string& GetName() const { return name; }
+
+        // Single writer thread. Fills in the totals from the per-frame fields.
+        void Publish(const TelemetrySample& sample);
+
+    private:
+        TelemetryBlock* block = nullptr;
+        std::string name;
+        TelemetrySample totals{};
+    };
+
+    // Read-only mapping of another process's block
+    class TelemetryReader {
+    public:
+        TelemetryReader() = default;
+        ~TelemetryReader();
+
+        TelemetryReader(const TelemetryReader&) = delete;
+        TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+        bool Open(const std::string& name);
+        void Close();
+
+        bool IsOpen() const { return block != nullptr; }
+        pid_t GetPid() const { return block ? static_cast<pid_t>(block->pid) : 0; }
+
+        // Consistent snapshot, retried while the writer is mid-update. False if nothing was published yet.
+        bool Read(TelemetrySample& out) const;
+
+    private:
+        TelemetryBlock* block = nullptr; // Mapped read-only, only ever loaded from
+    };
+
+} // namespace x11engine
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace x11engine {
+
+    enum class TextureFilter {
+        Nearest,
+        Bilinear, // 7-bit weights, like the upscaler
+    };
+
+    // A horizontal span in screen space: (u/w, v/w, 1/w) at its first pixel and their steps per pixel.
+    // These are linear in screen space, so dividing per pixel gives perspective-correct UVs (u, v in [0, 1), repeating).
+    struct TextureSpan {
+        float uOverW;
+        float vOverW;
+        float oneOverW;
+        float uOverWStep;
+        float vOverWStep;
+        float oneOverWStep;
+    };
+
+    // Premultiplied 0xAARRGGBB texels with a full mip chain. Sizes are powers of two so addressing wraps with a mask.
+    // Each level is stored in 4x4 tiles of 16 texels, one cache line each: a bilinear footprint or a diagonal
+    // walk touches a handful of lines instead of one per row.
+    class Texture {
+    public:
+        Texture() = default;
+        ~Texture();
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+        Texture(Texture&& other) noexcept;
+        Texture& operator=(Texture&& other) noexcept;
+
+        // Row-major texels in; mips are box-filtered down to 1x1 unless 'generateMips' is false
+        bool Create(const uint32_t* texels, int width, int height, bool generateMips = true);
+        bool Load(const std::string& path, bool generateMips = true); // See ReadImageFile (atlas.hpp)
+
+        // Batched sampling of 'count' (u, v) pairs from one mip level (kernels::KernelTable::sampleNearest / sampleBilinear)
+        void Sample(const float* u, const float* v, std::size_t count, uint32_t* out, TextureFilter filter, int level = 0) const;
+
+        // Perspective-correct span. The mip level comes from the u/v rate of change at the span's middle (plus 'lodBias').
+        void SampleSpan(const TextureSpan& span, int count, uint32_t* out, TextureFilter filter, float lodBias = 0.0f) const;
+
+        int SelectLevel(float texelsPerPixel, float lodBias = 0.0f) const; // Level whose texels are about a pixel wide
+        uint32_t Fetch(int level, int x, int y) const;                    // Single texel, coordinates wrap
+
+        bool IsValid() const { return data != nullptr; }
+        int GetWidth(int level = 0) const { return levels[level].width; }
+        int GetHeight(int level = 0) const { return levels[level].height; }
+        int GetLevelCount() const { return static_cast<int>(levels.size()); }
+
+    private:
+        struct Level {
+            int width;
+            int height;
+            int tileShift;      // log2(tiles per row) + 4: texel offset of a tile row
+            std::size_t offset; // Into 'data', in texels
+        };
+
+        void Release();
+
+    private:
+        uint32_t* data = nullptr;
+        std::vector<Level> levels;
+    };
+
+} // namespace x11engine
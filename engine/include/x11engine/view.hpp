@@ -0,0 +1,49 @@
+#pragma once
+
+#include "x11engine/collision.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/math.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace x11engine {
+
+    // Pixel rectangle of the render target
+    struct ViewRect {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    // Everything an object needs to record its draws for one view. Objects only read it (and their own LOD slot),
+    // so several views can be prepared on different threads at once.
+    struct ViewContext {
+        math::Mat4 viewProj;
+        std::array<math::Vec4, 6> frustum; // Inward planes (a, b, c, d): left, right, bottom, top, near, far
+        int width;                         // Size of the view in pixels
+        int height;
+        int* lod; // This view's level-of-detail state for the object being prepared
+    };
+
+    ViewContext MakeViewContext(const math::Mat4& viewProj, int width, int height, int* lod);
+
+    // False when the box is entirely outside one frustum plane (conservative: boxes near a corner may pass)
+    bool IsInFrustum(const ViewContext& view, const collision::Aabb& bounds);
+
+    // Lines in view pixels, ready for Renderer::DrawLines. Grows to the busiest frame, then stops allocating.
+    struct DrawList {
+        std::vector<kernels::ScreenLine> lines;
+        std::vector<uint32_t> colors;
+        std::size_t objects = 0; // Objects that recorded at least one line (for Renderer::CountObjects)
+
+        void Clear() {
+            lines.clear();
+            colors.clear();
+            objects = 0;
+        }
+    };
+
+} // namespace x11engine
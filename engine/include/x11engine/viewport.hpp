@@ -0,0 +1,63 @@
+#pragma once
+
+#include "x11engine/camera.hpp"
+#include "x11engine/color.hpp"
+#include "x11engine/view.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace x11engine {
+
+    class Renderer;
+    class ThreadPool;
+
+    namespace objects {
+        class Object;
+    }
+
+    // A camera drawn into part of the render target. The rectangle is in fractions of the target,
+    // so it follows resizes and dynamic resolution; the camera's aspect ratio is kept in sync with it.
+    struct Viewport {
+        float x = 0.0f;
+        float y = 0.0f;
+        float width = 1.0f;
+        float height = 1.0f;
+        camera::Camera camera;
+        bool clear = true;
+        uint32_t clearColor = color::BLACK;
+    };
+
+    // Split-screen and picture-in-picture. Later viewports draw over earlier ones.
+    class ViewportRenderer {
+    public:
+        int AddViewport(const Viewport& viewport);
+        Viewport& GetViewport(int index) { return viewports[index].viewport; }
+        std::size_t GetViewportCount() const { return viewports.size(); }
+
+        // 1. Culls and prepares every (viewport, chunk of objects) as its own job; the scene is only read.
+        // 2. Rasterizes each viewport into its rectangle: in parallel when no rectangles overlap, in order otherwise.
+        // Objects keep a separate LOD state per viewport (by their index in 'scene').
+        void Render(Renderer& renderer, std::span<const std::unique_ptr<objects::Object>> scene, ThreadPool* jobs = nullptr);
+
+        ViewRect GetRect(const Renderer& renderer, int index) const;
+
+    private:
+        static constexpr std::size_t CHUNK = 64; // Objects per prepare job
+
+        struct View {
+            Viewport viewport;
+            ViewRect rect{};
+            ViewContext context{};
+            std::vector<int> lods;        // By object index
+            std::vector<DrawList> chunks; // Prepared lines, by chunk
+        };
+
+        void Rasterize(Renderer& renderer, const View& view) const;
+
+        std::vector<View> viewports;
+    };
+
+} // namespace x11engine
@@ -0,0 +1,187 @@
+#include "x11engine/allocations.hpp"
+#include "x11engine/memory.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <execinfo.h>
+#include <new>
+#include <unistd.h>
+
+namespace x11engine::memory {
+
+#ifdef X11ENGINE_ALLOC_TRACKING
+
+    namespace {
+        constexpr std::size_t SITE_SLOTS = 64; // Open-addressed, sites beyond this are only counted in the totals
+
+        // Plain data so the thread_local needs no constructor (operator new can run before anything is initialized)
+        struct ThreadState {
+            bool tracked;
+            bool forbidden;
+            bool recordSites;
+            bool inHook; // backtrace() itself may allocate on first use
+            AllocationStats stats;
+            AllocationSite sites[SITE_SLOTS];
+        };
+
+        constinit thread_local ThreadState state{};
+
+        void RecordSite(std::size_t size) {
+            // [0] is this function, [1] operator new
+            void* frames[ALLOCATION_SITE_DEPTH + 2] = {};
+            int depth = backtrace(frames, static_cast<int>(std::size(frames)));
+
+            AllocationSite key{};
+            uintptr_t hash = 0;
+            for (int i = 2; i < depth; ++i) {
+                key.stack[i - 2] = frames[i];
+                hash = (hash ^ reinterpret_cast<uintptr_t>(frames[i])) * 0x9E3779B97F4A7C15ull;
+            }
+
+            for (std::size_t probe = 0; probe < SITE_SLOTS; ++probe) {
+                AllocationSite& slot = state.sites[(hash + probe) % SITE_SLOTS];
+                if (slot.count == 0)
+                    slot.stack = key.stack;
+                if (slot.stack == key.stack) {
+                    slot.count++;
+                    slot.bytes += size;
+                    return;
+                }
+            }
+        }
+
+        [[gnu::noinline]] void OnAllocate(std::size_t size) {
+            if (!state.tracked || state.inHook)
+                return;
+            state.inHook = true;
+
+            if (state.forbidden) {
+                char message[128];
+                int length = std::snprintf(message, sizeof(message), "x11engine: %zu byte allocation in a steady-state frame\n", size);
+                write(STDERR_FILENO, message, static_cast<std::size_t>(length));
+                void* frames[32];
+                backtrace_symbols_fd(frames, backtrace(frames, 32), STDERR_FILENO);
+                std::abort();
+            }
+
+            state.stats.count++;
+            state.stats.bytes += size;
+            if (state.recordSites)
+                RecordSite(size);
+            state.inHook = false;
+        }
+
+        inline void OnFree(void* ptr) {
+            if (ptr && state.tracked)
+                state.stats.frees++;
+        }
+
+        void* Allocate(std::size_t size, std::size_t alignment) noexcept {
+            OnAllocate(size);
+            if (size == 0)
+                size = 1;
+
+            // Same contract as the default operator new: retry through the new_handler until it gives up
+            while (true) {
+                void* ptr = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? std::aligned_alloc(alignment, AlignUp(size, alignment)) : std::malloc(size);
+                if (ptr)
+                    return ptr;
+                std::new_handler handler = std::get_new_handler();
+                if (!handler)
+                    return nullptr;
+                handler();
+            }
+        }
+
+        void* AllocateOrThrow(std::size_t size, std::size_t alignment) {
+            void* ptr = Allocate(size, alignment);
+            if (!ptr)
+                throw std::bad_alloc();
+            return ptr;
+        }
+
+        void Free(void* ptr) noexcept {
+            OnFree(ptr);
+            std::free(ptr);
+        }
+    } // namespace
+
+    bool IsAllocationTrackingAvailable() noexcept { return true; }
+
+    void TrackThreadAllocations(bool enabled) noexcept {
+        // Warm up the unwinder here rather than inside the first tracked allocation
+        void* frame;
+        backtrace(&frame, 1);
+        state.tracked = enabled;
+    }
+
+    AllocationStats GetThreadAllocations() noexcept { return state.tracked ? state.stats : AllocationStats{}; }
+
+    void RecordAllocationSites(bool enabled) noexcept { state.recordSites = enabled; }
+
+    std::size_t GetAllocationSites(std::span<AllocationSite> out) noexcept {
+        AllocationSite sorted[SITE_SLOTS];
+        auto end = std::copy_if(std::begin(state.sites), std::end(state.sites), sorted, [](const AllocationSite& s) { return s.count > 0; });
+        std::sort(sorted, end, [](const AllocationSite& a, const AllocationSite& b) { return a.count > b.count; });
+
+        std::size_t count = std::min(out.size(), static_cast<std::size_t>(end - sorted));
+        std::copy_n(sorted, count, out.begin());
+        return count;
+    }
+
+    void ClearAllocationSites() noexcept { std::fill(std::begin(state.sites), std::end(state.sites), AllocationSite{}); }
+
+    void ForbidThreadAllocations(bool forbidden) noexcept { state.forbidden = forbidden; }
+
+    void PrintAllocationSite(const AllocationSite& site) noexcept {
+        int depth = static_cast<int>(std::find(site.stack.begin(), site.stack.end(), nullptr) - site.stack.begin());
+        backtrace_symbols_fd(const_cast<void* const*>(site.stack.data()), depth, STDERR_FILENO);
+    }
+
+#else
+
+    bool IsAllocationTrackingAvailable() noexcept { return false; }
+    void TrackThreadAllocations(bool) noexcept {}
+    AllocationStats GetThreadAllocations() noexcept { return {}; }
+    void RecordAllocationSites(bool) noexcept {}
+    std::size_t GetAllocationSites(std::span<AllocationSite>) noexcept { return 0; }
+    void ClearAllocationSites() noexcept {}
+    void ForbidThreadAllocations(bool) noexcept {}
+    void PrintAllocationSite(const AllocationSite&) noexcept {}
+
+#endif
+
+} // namespace x11engine::memory
+
+#ifdef X11ENGINE_ALLOC_TRACKING
+
+// --- Global replacements. Every form goes through malloc/aligned_alloc so any new pairs with any delete. ---
+
+using x11engine::memory::Allocate;
+using x11engine::memory::AllocateOrThrow;
+using x11engine::memory::Free;
+
+void* operator new(std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t align) { return AllocateOrThrow(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return AllocateOrThrow(size, static_cast<std::size_t>(align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<std::size_t>(align)); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<std::size_t>(align)); }
+
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete[](void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { Free(ptr); }
+
+#endif
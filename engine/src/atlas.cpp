@@ -0,0 +1,187 @@
+#include "x11engine/atlas.hpp"
+#include "x11engine/memory.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <utility>
+
+namespace x11engine {
+
+    namespace {
+        // Next header token, skipping whitespace and '#' comments (PPM)
+        bool ReadToken(std::istream& in, std::string& token) {
+            token.clear();
+            char c;
+            while (in.get(c)) {
+                if (c == '#') {
+                    std::string comment;
+                    std::getline(in, comment);
+                } else if (!std::isspace(static_cast<unsigned char>(c))) {
+                    token.push_back(c);
+                    break;
+                }
+            }
+            while (in.get(c) && !std::isspace(static_cast<unsigned char>(c)))
+                token.push_back(c);
+            return !token.empty();
+        }
+
+        // Whole token as a number in [1, MAX_DIMENSION]; large enough for any sprite sheet, small enough that sizes can't overflow
+        constexpr int MAX_DIMENSION = 1 << 15;
+
+        bool ParseField(const std::string& token, int& out) {
+            int value = 0;
+            auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+            if (ec != std::errc() || ptr != token.data() + token.size() || value < 1 || value > MAX_DIMENSION)
+                return false;
+            out = value;
+            return true;
+        }
+
+        bool ReadHeader(std::istream& in, int& width, int& height, int& channels) {
+            std::string magic, token;
+            if (!ReadToken(in, magic))
+                return false;
+
+            int maxValue = 0;
+            if (magic == "P6") {
+                channels = 3;
+                std::string w, h, m;
+                if (!ReadToken(in, w) || !ReadToken(in, h) || !ReadToken(in, m))
+                    return false;
+                if (!ParseField(w, width) || !ParseField(h, height) || !ParseField(m, maxValue))
+                    return false;
+            } else if (magic == "P7") {
+                channels = 0;
+                while (ReadToken(in, token) && token != "ENDHDR") {
+                    std::string value;
+                    if (!ReadToken(in, value))
+                        return false;
+                    bool ok = true;
+                    if (token == "WIDTH")
+                        ok = ParseField(value, width);
+                    else if (token == "HEIGHT")
+                        ok = ParseField(value, height);
+                    else if (token == "DEPTH")
+                        ok = ParseField(value, channels);
+                    else if (token == "MAXVAL")
+                        ok = ParseField(value, maxValue);
+                    if (!ok)
+                        return false;
+                }
+            } else {
+                return false;
+            }
+
+            return width > 0 && height > 0 && maxValue == 255 && (channels == 3 || channels == 4);
+        }
+    } // namespace
+
+    bool ReadImageFile(const std::string& path, std::vector<uint32_t>& pixels, int& width, int& height) {
+        std::ifstream in(path, std::ios::binary);
+        int channels = 0;
+        width = height = 0;
+        if (!in || !ReadHeader(in, width, height, channels)) {
+            std::cerr << "Failed to read image " << path << " (binary PPM or PAM, 8-bit)" << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> raw(static_cast<std::size_t>(width) * height * channels);
+        if (!in.read(reinterpret_cast<char*>(raw.data()), static_cast<std::streamsize>(raw.size()))) {
+            std::cerr << "Truncated image " << path << std::endl;
+            return false;
+        }
+
+        pixels.resize(static_cast<std::size_t>(width) * height);
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            const uint8_t* p = raw.data() + i * channels;
+            pixels[i] = channels == 4 ? color::RGBA(p[0], p[1], p[2], p[3]) : (0xFF000000 | color::RGB(p[0], p[1], p[2]));
+        }
+        return true;
+    }
+
+    Atlas::Atlas(int width, int height) : width(width), height(height), pitch(static_cast<int>(memory::AlignUp(width, memory::CACHE_LINE / sizeof(uint32_t)))) {
+        std::size_t bytes = static_cast<std::size_t>(pitch) * height * sizeof(uint32_t);
+        pixels = static_cast<uint32_t*>(memory::AllocateAligned(bytes));
+        if (!pixels)
+            throw std::bad_alloc();
+        std::memset(pixels, 0, bytes);
+    }
+
+    Atlas::~Atlas() { memory::FreeAligned(pixels); }
+
+    Atlas::Atlas(Atlas&& other) noexcept { *this = std::move(other); }
+
+    Atlas& Atlas::operator=(Atlas&& other) noexcept {
+        if (this != &other) {
+            memory::FreeAligned(pixels);
+            width = std::exchange(other.width, 0);
+            height = std::exchange(other.height, 0);
+            pitch = std::exchange(other.pitch, 0);
+            pixels = std::exchange(other.pixels, nullptr);
+            colorKey = other.colorKey;
+            sprites = std::move(other.sprites);
+            shelfX = other.shelfX;
+            shelfY = other.shelfY;
+            shelfHeight = other.shelfHeight;
+        }
+        return *this;
+    }
+
+    int Atlas::Add(const uint32_t* image, int imageWidth, int imageHeight, bool premultiply) {
+        // 1. Find room: current shelf, else a new one below it. Nothing changes until it fits.
+        int x = shelfX;
+        int y0 = shelfY;
+        int rowHeight = shelfHeight;
+        if (x + imageWidth > width) {
+            x = 0;
+            y0 += rowHeight;
+            rowHeight = 0;
+        }
+        if (imageWidth <= 0 || imageHeight <= 0 || imageWidth > width || y0 + imageHeight > height) {
+            std::cerr << "Atlas is full (" << imageWidth << "x" << imageHeight << " sprite)" << std::endl;
+            return -1;
+        }
+
+        // 2. Copy rows in
+        for (int y = 0; y < imageHeight; ++y) {
+            uint32_t* dst = pixels + static_cast<std::size_t>(y0 + y) * pitch + x;
+            const uint32_t* src = image + static_cast<std::size_t>(y) * imageWidth;
+            if (!premultiply) {
+                std::memcpy(dst, src, imageWidth * sizeof(uint32_t));
+                continue;
+            }
+            for (int x = 0; x < imageWidth; ++x)
+                dst[x] = color::WithAlpha(src[x], color::Alpha(src[x]));
+        }
+
+        int id = Define({x, y0, imageWidth, imageHeight});
+        shelfX = x + imageWidth;
+        shelfY = y0;
+        shelfHeight = std::max(rowHeight, imageHeight);
+        return id;
+    }
+
+    int Atlas::AddImageFile(const std::string& path) {
+        std::vector<uint32_t> image;
+        int imageWidth, imageHeight;
+        if (!ReadImageFile(path, image, imageWidth, imageHeight))
+            return -1;
+        return Add(image.data(), imageWidth, imageHeight);
+    }
+
+    int Atlas::Define(const SpriteRect& rect) {
+        if (rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0 || rect.x + rect.width > width || rect.y + rect.height > height) {
+            std::cerr << "Sprite rect outside the atlas" << std::endl;
+            return -1;
+        }
+        sprites.push_back(rect);
+        return static_cast<int>(sprites.size()) - 1;
+    }
+
+} // namespace x11engine
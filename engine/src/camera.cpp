@@ -8,7 +8,7 @@
 namespace x11engine::camera {
 
     Camera::Camera()
-        : position{0.0f, 0.0f, 0.0f}, forward{0.0f, 0.0f, -1.0f}, up{0.0f, 1.0f, 0.0f}, yaw(-90.0f), pitch(0.0f), fov_degrees{74.0f}, aspect_ratio{4.0f / 3.0f}, near_plane{0.1f}, far_plane{100.0f} {}
+        : position{0.0f, 0.0f, 0.0f}, forward{0.0f, 0.0f, -1.0f}, up{0.0f, 1.0f, 0.0f}, yaw(-90.0f), pitch(0.0f), fov_degrees{74.0f}, aspect_ratio{4.0f / 3.0f}, near_plane{0.1f}, far_plane{10000.0f} {}
 
     void Camera::Update(const Input& input) {
         // 1. Rotation
@@ -32,10 +32,14 @@ namespace x11engine::camera {
         float radYaw = math::radians(yaw);
         float radPitch = math::radians(pitch);
 
+        float sinYaw, cosYaw, sinPitch, cosPitch;
+        math::sincos(radYaw, sinYaw, cosYaw);
+        math::sincos(radPitch, sinPitch, cosPitch);
+
         math::Vec3 newForward;
-        newForward.x = std::cos(radYaw) * std::cos(radPitch);
-        newForward.y = std::sin(radPitch);
-        newForward.z = std::sin(radYaw) * std::cos(radPitch);
+        newForward.x = cosYaw * cosPitch;
+        newForward.y = sinPitch;
+        newForward.z = sinYaw * cosPitch;
 
         forward = math::normalize(newForward);
 
@@ -0,0 +1,188 @@
+#include "x11engine/capture.hpp"
+#include "x11engine/memory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace x11engine {
+
+    namespace {
+        constexpr std::size_t FILE_BUFFER = 1 << 20;
+
+        // BT.601 limited range, 8-bit fixed point
+        inline uint8_t LumaOf(int r, int g, int b) { return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16); }
+        inline uint8_t BlueDiffOf(int r, int g, int b) { return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128); }
+        inline uint8_t RedDiffOf(int r, int g, int b) { return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128); }
+
+        // 0xRRGGBB -> planar I420 (chroma averaged over each 2x2 block, edges clamped for odd sizes)
+        void ConvertToI420(const uint32_t* src, int width, int height, uint8_t* y, uint8_t* u, uint8_t* v) {
+            for (int row = 0; row < height; ++row) {
+                const uint32_t* line = src + static_cast<std::size_t>(row) * width;
+                uint8_t* out = y + static_cast<std::size_t>(row) * width;
+                for (int x = 0; x < width; ++x)
+                    out[x] = LumaOf((line[x] >> 16) & 0xFF, (line[x] >> 8) & 0xFF, line[x] & 0xFF);
+            }
+
+            int chromaWidth = (width + 1) / 2;
+            int chromaHeight = (height + 1) / 2;
+            for (int cy = 0; cy < chromaHeight; ++cy) {
+                const uint32_t* row0 = src + static_cast<std::size_t>(cy * 2) * width;
+                const uint32_t* row1 = src + static_cast<std::size_t>(std::min(cy * 2 + 1, height - 1)) * width;
+                for (int cx = 0; cx < chromaWidth; ++cx) {
+                    int x0 = cx * 2;
+                    int x1 = std::min(x0 + 1, width - 1);
+                    uint32_t p[4] = {row0[x0], row0[x1], row1[x0], row1[x1]};
+                    int r = 0, g = 0, b = 0;
+                    for (uint32_t c : p) {
+                        r += (c >> 16) & 0xFF;
+                        g += (c >> 8) & 0xFF;
+                        b += c & 0xFF;
+                    }
+                    r = (r + 2) >> 2;
+                    g = (g + 2) >> 2;
+                    b = (b + 2) >> 2;
+                    std::size_t i = static_cast<std::size_t>(cy) * chromaWidth + cx;
+                    u[i] = BlueDiffOf(r, g, b);
+                    v[i] = RedDiffOf(r, g, b);
+                }
+            }
+        }
+    } // namespace
+
+    FrameCapture::~FrameCapture() { Stop(); }
+
+    bool FrameCapture::Start(const std::string& path, CaptureFormat newFormat, int newWidth, int newHeight, int fps, int slots) {
+        if (IsActive())
+            Stop();
+
+        // 1. Output file with a large stdio buffer so the writer issues few syscalls
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Failed to open capture file " << path << std::endl;
+            return false;
+        }
+        std::setvbuf(file, nullptr, _IOFBF, FILE_BUFFER);
+
+        format = newFormat;
+        width = newWidth;
+        height = newHeight;
+        if (format == CaptureFormat::Y4M && std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps) < 0) {
+            std::cerr << "Failed to write capture header to " << path << std::endl;
+            std::fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        // 2. Everything the recording needs is allocated now, never while frames flow
+        std::size_t frameBytes = static_cast<std::size_t>(width) * height * sizeof(uint32_t);
+        ring.assign(std::max(slots, 2), nullptr);
+        for (uint32_t*& slot : ring) {
+            slot = static_cast<uint32_t*>(memory::AllocateAligned(frameBytes, memory::CACHE_LINE, true));
+            if (!slot) {
+                std::cerr << "Failed to allocate capture buffers" << std::endl;
+                Stop();
+                return false;
+            }
+        }
+        if (format == CaptureFormat::Y4M)
+            scratch.resize(static_cast<std::size_t>(width) * height + 2 * static_cast<std::size_t>((width + 1) / 2) * ((height + 1) / 2));
+
+        head.store(0);
+        tail.store(0);
+        stopping.store(false);
+        failed.store(false);
+        submitted.store(0);
+        dropped.store(0);
+        written.store(0);
+
+        // 3. Writer
+        writer = std::thread(&FrameCapture::WriterLoop, this);
+        return true;
+    }
+
+    void FrameCapture::Stop() {
+        if (writer.joinable()) {
+            stopping.store(true, std::memory_order_release);
+            ready.release();
+            writer.join();
+            std::cout << "Capture: " << written.load() << " frames written, " << dropped.load() << " dropped" << std::endl;
+        }
+
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        for (uint32_t* slot : ring)
+            memory::FreeAligned(slot);
+        ring.clear();
+    }
+
+    bool FrameCapture::Submit(const uint32_t* pixels, int frameWidth, int frameHeight) {
+        if (!IsActive())
+            return false;
+
+        submitted.fetch_add(1, std::memory_order_relaxed);
+
+        // Size changes (window resize) can't be represented in one stream, disk errors end the recording
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (frameWidth != width || frameHeight != height || failed.load(std::memory_order_relaxed) || h - tail.load(std::memory_order_acquire) >= ring.size()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        std::memcpy(ring[h % ring.size()], pixels, static_cast<std::size_t>(width) * height * sizeof(uint32_t));
+        head.store(h + 1, std::memory_order_release);
+        ready.release();
+        return true;
+    }
+
+    void FrameCapture::WriterLoop() {
+        while (true) {
+            ready.acquire();
+
+            uint64_t t = tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire)) {
+                // Only the stop token is left: every submitted frame has been written
+                if (stopping.load(std::memory_order_acquire))
+                    break;
+                continue;
+            }
+
+            if (!failed.load(std::memory_order_relaxed) && !WriteFrame(ring[t % ring.size()])) {
+                std::cerr << "Capture write failed, further frames are dropped" << std::endl;
+                failed.store(true, std::memory_order_relaxed);
+            }
+
+            // Hand the slot back to the render thread
+            tail.store(t + 1, std::memory_order_release);
+        }
+
+        std::fflush(file);
+    }
+
+    bool FrameCapture::WriteFrame(const uint32_t* pixels) {
+        std::size_t pixelCount = static_cast<std::size_t>(width) * height;
+
+        if (format == CaptureFormat::Raw) {
+            if (std::fwrite(pixels, sizeof(uint32_t), pixelCount, file) != pixelCount)
+                return false;
+        } else {
+            uint8_t* y = scratch.data();
+            uint8_t* u = y + pixelCount;
+            uint8_t* v = u + static_cast<std::size_t>((width + 1) / 2) * ((height + 1) / 2);
+            ConvertToI420(pixels, width, height, y, u, v);
+
+            if (std::fputs("FRAME\n", file) < 0 || std::fwrite(scratch.data(), 1, scratch.size(), file) != scratch.size())
+                return false;
+        }
+
+        written.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    CaptureFormat GuessCaptureFormat(const std::string& path) {
+        return path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0 ? CaptureFormat::Y4M : CaptureFormat::Raw;
+    }
+
+} // namespace x11engine
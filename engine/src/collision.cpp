@@ -0,0 +1,197 @@
+#include "x11engine/collision.hpp"
+#include "x11engine/objects.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace x11engine::collision {
+
+    namespace {
+        constexpr float Vec3::* COMPONENT[3] = {&Vec3::x, &Vec3::y, &Vec3::z};
+
+        inline uint64_t PairKey(BodyId a, BodyId b) { return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a; }
+
+        // Sort order of the endpoint lists: by value, mins before maxes on ties (so touching boxes overlap like in Overlaps)
+        inline bool Before(float value, uint32_t data, float otherValue, uint32_t otherData) {
+            return value < otherValue || (value == otherValue && !(data & 1) && (otherData & 1));
+        }
+    } // namespace
+
+    Aabb TransformAabb(const Mat4& m, const Aabb& local) {
+        Vec3 center = (local.min + local.max) * 0.5f;
+        Vec3 extent = (local.max - local.min) * 0.5f;
+
+        Vec3 worldCenter{m.c0.x * center.x + m.c1.x * center.y + m.c2.x * center.z + m.c3.x, m.c0.y * center.x + m.c1.y * center.y + m.c2.y * center.z + m.c3.y,
+                         m.c0.z * center.x + m.c1.z * center.y + m.c2.z * center.z + m.c3.z};
+        Vec3 worldExtent{std::abs(m.c0.x) * extent.x + std::abs(m.c1.x) * extent.y + std::abs(m.c2.x) * extent.z,
+                         std::abs(m.c0.y) * extent.x + std::abs(m.c1.y) * extent.y + std::abs(m.c2.y) * extent.z,
+                         std::abs(m.c0.z) * extent.x + std::abs(m.c1.z) * extent.y + std::abs(m.c2.z) * extent.z};
+        return {worldCenter - worldExtent, worldCenter + worldExtent};
+    }
+
+    // --- PairSet ---
+
+    void SweepAndPrune::PairSet::Insert(uint64_t key) {
+        if ((count + 1) * 2 > slots.size())
+            Grow();
+
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = Slot(key);; i = (i + 1) & mask) {
+            if (slots[i] == key)
+                return;
+            if (slots[i] == EMPTY) {
+                slots[i] = key;
+                count++;
+                return;
+            }
+        }
+    }
+
+    void SweepAndPrune::PairSet::Erase(uint64_t key) {
+        if (count == 0)
+            return;
+
+        std::size_t mask = slots.size() - 1;
+        std::size_t hole = Slot(key);
+        while (slots[hole] != key) {
+            if (slots[hole] == EMPTY)
+                return;
+            hole = (hole + 1) & mask;
+        }
+
+        // Backward shift: pull later keys of the probe run into the hole unless that would put them before their home slot
+        for (std::size_t j = (hole + 1) & mask; slots[j] != EMPTY; j = (j + 1) & mask) {
+            std::size_t home = Slot(slots[j]);
+            bool homeInRange = hole <= j ? (home > hole && home <= j) : (home > hole || home <= j);
+            if (!homeInRange) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole] = EMPTY;
+        count--;
+    }
+
+    void SweepAndPrune::PairSet::Grow() {
+        std::vector<uint64_t> old = std::move(slots);
+        slots.assign(std::max<std::size_t>(old.size() * 2, 64), EMPTY);
+        count = 0;
+        for (uint64_t key : old) {
+            if (key != EMPTY)
+                Insert(key);
+        }
+    }
+
+    // --- SweepAndPrune ---
+
+    BodyId SweepAndPrune::Add(const Aabb& bounds) {
+        BodyId id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+            bodies[id] = bounds;
+            alive[id] = true;
+        } else {
+            id = static_cast<BodyId>(bodies.size());
+            bodies.push_back(bounds);
+            alive.push_back(true);
+        }
+
+        // Appended past everything, i.e. overlapping nothing; Update sorts the endpoints in and picks up the pairs
+        for (std::vector<Endpoint>& axis : axes) {
+            axis.push_back({0.0f, id << 1});
+            axis.push_back({0.0f, (id << 1) | 1});
+        }
+        return id;
+    }
+
+    void SweepAndPrune::Remove(BodyId id) {
+        if (id >= bodies.size() || !alive[id])
+            return;
+
+        for (std::vector<Endpoint>& axis : axes)
+            std::erase_if(axis, [id](const Endpoint& e) { return (e.data >> 1) == id; });
+
+        // The set only changes in Update, so 'pairs' lists every key it holds
+        std::erase_if(pairs, [this, id](const CollisionPair& pair) {
+            if (pair.a != id && pair.b != id)
+                return false;
+            pairSet.Erase(PairKey(pair.a, pair.b));
+            return true;
+        });
+
+        alive[id] = false;
+        freeIds.push_back(id);
+    }
+
+    void SweepAndPrune::SortAxis(int axis) {
+        std::vector<Endpoint>& list = axes[axis];
+        float Vec3::*component = COMPONENT[axis];
+
+        // 1. Refresh the endpoint values, the order is still last step's
+        for (Endpoint& e : list) {
+            const Aabb& box = bodies[e.data >> 1];
+            e.value = (e.data & 1) ? box.max.*component : box.min.*component;
+        }
+
+        // 2. Insertion sort. Every inversion is fixed by exactly one swap of the two endpoints involved.
+        for (std::size_t i = 1; i < list.size(); ++i) {
+            Endpoint moving = list[i];
+            BodyId body = moving.data >> 1;
+            bool isMax = moving.data & 1;
+
+            std::size_t j = i;
+            for (; j > 0 && Before(moving.value, moving.data, list[j - 1].value, list[j - 1].data); --j) {
+                const Endpoint& passed = list[j - 1];
+                BodyId other = passed.data >> 1;
+                bool otherIsMax = passed.data & 1;
+
+                if (!isMax && otherIsMax) {
+                    // A min moved below another box's max: they now overlap on this axis, maybe on all three
+                    if (Overlaps(bodies[body], bodies[other]))
+                        pairSet.Insert(PairKey(body, other));
+                } else if (isMax && !otherIsMax) {
+                    // A max moved below another box's min: they no longer overlap
+                    pairSet.Erase(PairKey(body, other));
+                }
+                list[j] = passed;
+            }
+            list[j] = moving;
+        }
+    }
+
+    void SweepAndPrune::Update() {
+        for (int axis = 0; axis < 3; ++axis)
+            SortAxis(axis);
+
+        pairs.clear();
+        pairSet.ForEach([this](uint64_t key) { pairs.push_back({static_cast<BodyId>(key >> 32), static_cast<BodyId>(key)}); });
+        std::sort(pairs.begin(), pairs.end(), [](const CollisionPair& l, const CollisionPair& r) { return l.a != r.a ? l.a < r.a : l.b < r.b; });
+    }
+
+    // --- CollisionWorld ---
+
+    BodyId CollisionWorld::Add(objects::Object3D& object) {
+        BodyId id = broadphase.Add(TransformAabb(object.GetModelMatrix(), object.GetLocalBounds()));
+        if (id >= objects.size())
+            objects.resize(id + 1, nullptr);
+        objects[id] = &object;
+        return id;
+    }
+
+    void CollisionWorld::Remove(BodyId id) {
+        if (id < objects.size() && objects[id]) {
+            broadphase.Remove(id);
+            objects[id] = nullptr;
+        }
+    }
+
+    void CollisionWorld::Update() {
+        for (BodyId id = 0; id < objects.size(); ++id) {
+            if (objects[id])
+                broadphase.SetBounds(id, TransformAabb(objects[id]->GetModelMatrix(), objects[id]->GetLocalBounds()));
+        }
+        broadphase.Update();
+    }
+
+} // namespace x11engine::collision
@@ -0,0 +1,7 @@
+#pragma once
+
+// Each variant is compiled for its own ISA with a target attribute instead of per-file flags,
+// so no inline function from a header can be emitted with AVX and leak into baseline code.
+// Pick the variant at runtime from kernels::Get().level.
+#define X11ENGINE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define X11ENGINE_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
@@ -1,14 +1,19 @@
 #include "x11engine/engine.hpp"
 #include "x11engine/application.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <unistd.h>
 
 namespace x11engine {
 
     Engine::Engine(int width, int height, const std::string& title, Application* app)
-        : frame(width, height, title), renderer(width, height), app(app), running(true) {}
+        : frame(width, height, title), renderer(width, height), useEventThread(false), rawMotion(false), pendingInput{}, pendingInputHead(0), pendingInputCount(0), unpresentedInput(0), resolution(1.0 / TARGET_FPS), dynamicResolution(false), targetFps(TARGET_FPS), allocationCheck(memory::AllocationCheck::Off), allocationWarmup(120), steadyFrame(0), steadyFrames(0),
+          allocatingFrames(0), steadyAllocations{}, app(app), running(true) {}
 
     Engine::~Engine() {
         // Cleanup if needed
@@ -25,18 +30,89 @@ namespace x11engine {
         if (app) {
             app->renderer = &renderer;
             app->input = &input;
+            app->jobs = &jobs;
+            app->post = &post;
             if (!app->OnCreate())
                 return false;
         }
 
         WaitForMapNotify();
+
+        if (const char* mode = std::getenv("X11ENGINE_EVENT_THREAD"))
+            SetEventThread(std::string(mode) != "0", std::string(mode) == "raw");
+        if (useEventThread && frame.GetBackend() != WindowBackend::Headless && !eventThread.Start(frame.GetWindow(), rawMotion, inputEvents))
+            std::cerr << "Reading input on the main thread" << std::endl;
+
+        if (const char* path = std::getenv("X11ENGINE_CAPTURE"))
+            StartCapture(path);
+
+        if (const char* name = std::getenv("X11ENGINE_TELEMETRY"))
+            StartTelemetry(std::string(name) == "1" ? "" : name);
+
+        if (const char* check = std::getenv("X11ENGINE_ALLOC")) {
+            std::string name = check;
+            if (name == "track")
+                SetAllocationCheck(memory::AllocationCheck::Track, allocationWarmup);
+            else if (name == "assert")
+                SetAllocationCheck(memory::AllocationCheck::Assert, allocationWarmup);
+            else
+                std::cerr << "Unknown X11ENGINE_ALLOC '" << name << "', expected track or assert" << std::endl;
+        }
         return true;
     }
 
+    void Engine::SetAllocationCheck(memory::AllocationCheck check, int warmupFrames) {
+        if (check != memory::AllocationCheck::Off && !memory::IsAllocationTrackingAvailable()) {
+            std::cerr << "Allocation checks need a build with X11ENGINE_ALLOC_TRACKING=ON" << std::endl;
+            check = memory::AllocationCheck::Off;
+        }
+        allocationCheck = check;
+        allocationWarmup = warmupFrames;
+    }
+
+    bool Engine::StartCapture(const std::string& path) {
+        // The recording has the window's size at this point; frames after a resize are dropped.
+        // Uncapped runs have no fixed rate, the header gets the default cap.
+        int fps = static_cast<int>(std::lround(targetFps > 0.0 ? targetFps : TARGET_FPS));
+        return capture.Start(path, GuessCaptureFormat(path), renderer.GetWindowWidth(), renderer.GetWindowHeight(), std::max(fps, 1));
+    }
+
+    void Engine::StopCapture() { capture.Stop(); }
+
+    bool Engine::StartTelemetry(const std::string& name) {
+        if (name.empty())
+            return telemetry.Open(GetDefaultTelemetryName(getpid()));
+        return telemetry.Open(name.front() == '/' ? name : "/" + name);
+    }
+
+    void Engine::StopTelemetry() { telemetry.Close(); }
+
+    void Engine::SetWindowBackend(WindowBackend backend) { frame.SetBackend(backend); }
+
+    bool Engine::PushInput(const InputEvent& event) { return !eventThread.IsRunning() && inputEvents.Push(event); }
+
+    void Engine::SetEventThread(bool enabled, bool raw) {
+        useEventThread = enabled;
+        rawMotion = raw;
+    }
+
+    void Engine::SetTargetFps(double fps) {
+        targetFps = fps;
+        if (fps > 0.0)
+            resolution.SetTargetFrameTime(1.0 / fps);
+    }
+
+    void Engine::SetDynamicResolution(bool enabled, float minScale) {
+        dynamicResolution = enabled;
+        resolution.SetLimits(minScale, 1.0f);
+        if (!enabled)
+            renderer.SetRenderScale(frame, 1.0f);
+    }
+
     void Engine::WaitForMapNotify() {
         XEvent event;
         while (true) {
-            XNextEvent(frame.GetDisplay(), &event);
+            frame.WaitEvent(event);
             if (event.type == MapNotify)
                 break;
         }
@@ -44,25 +120,45 @@ namespace x11engine {
 
     void Engine::HandleEvents() {
         XEvent event;
-        while (XPending(frame.GetDisplay()) > 0) {
-            XNextEvent(frame.GetDisplay(), &event);
 
+        // A window drag floods the queue with ConfigureNotify, only the last one matters
+        int pendingW = 0;
+        int pendingH = 0;
+
+        while (frame.PollEvent(event)) {
             if (event.type == ClientMessage) {
                 if ((Atom)event.xclient.data.l[0] == frame.GetWMDeleteMessage())
                     running = false;
             }
 
             if (event.type == ConfigureNotify) {
-                int newW = event.xconfigure.width;
-                int newH = event.xconfigure.height;
-                if (newW != renderer.GetWidth() || newH != renderer.GetHeight()) {
-                    renderer.Resize(frame, newW, newH);
-                    if (app)
-                        app->OnResize(newW, newH);
-                }
+                pendingW = event.xconfigure.width;
+                pendingH = event.xconfigure.height;
             }
 
-            input.ProcessEvent(event);
+            // The event thread reads keys on its own connection. Here a key is stamped when the frame reads it, so the time it
+            // sat in the queue until then is missing from its input latency (the event thread's stamps are exact).
+            if ((event.type == KeyPress || event.type == KeyRelease) && !eventThread.IsRunning()) {
+                InputEvent key{};
+                key.type = event.type == KeyPress ? InputEventType::KeyDown : InputEventType::KeyUp;
+                key.time = Profiler::Now();
+                key.serverTime = static_cast<uint32_t>(event.xkey.time);
+                key.key = frame.LookupKeysym(event.xkey);
+                key.x = event.xkey.x;
+                key.y = event.xkey.y;
+                inputEvents.Push(key);
+            }
+        }
+
+        if (pendingW > 0 && pendingH > 0 && (pendingW != renderer.GetWindowWidth() || pendingH != renderer.GetWindowHeight())) {
+            // Buffers are reallocated, the allocation checks warm up again
+            memory::ForbidThreadAllocations(false);
+            memory::RecordAllocationSites(false);
+            steadyFrame = profiler.GetFrameCount() + allocationWarmup;
+
+            renderer.Resize(frame, pendingW, pendingH);
+            if (app)
+                app->OnResize(pendingW, pendingH);
         }
     }
 
@@ -76,11 +172,15 @@ namespace x11engine {
         const double tickRate = TICK_RATE; // Logic updates per second
         const double dt = 1.0 / tickRate;  // Constant time step
 
-        double targetFps = TARGET_FPS;         // Desired rendering FPS
-        double minFrameTime = 1.0 / targetFps; // Minimum duration of one frame
+        double minFrameTime = targetFps > 0.0 ? 1.0 / targetFps : 0.0; // Minimum duration of one frame
 
         double accumulator = 0.0;
         int frameCount = 0;
+        char title[64];
+
+        bool trackAllocations = allocationCheck != memory::AllocationCheck::Off;
+        memory::TrackThreadAllocations(trackAllocations);
+        steadyFrame = profiler.GetFrameCount() + allocationWarmup;
 
         while (running) {
             if (app && app->ShouldClose())
@@ -95,39 +195,167 @@ namespace x11engine {
 
             accumulator += frameTime;
 
+            profiler.BeginFrame();
+            renderer.ResetStats();
+
+            bool steady = trackAllocations && profiler.GetFrameCount() >= steadyFrame;
+            memory::ForbidThreadAllocations(steady && allocationCheck == memory::AllocationCheck::Assert);
+            memory::RecordAllocationSites(steady && allocationCheck == memory::AllocationCheck::Track);
+
             // 1. Process Events (Input)
+            profiler.BeginPhase(FramePhase::Events);
+            RetireInput();
             HandleEvents();
+            profiler.EndPhase(FramePhase::Events);
 
             // 2. Fixed Update Loop
+            profiler.BeginPhase(FramePhase::Update);
+            double tickClock = Profiler::Now(); // The ticks below catch the simulation up to this moment
             while (accumulator >= dt) {
+                DeliverInput(tickClock - (accumulator - dt), accumulator - dt < dt);
+
                 // In the new structure, we delegate Update to the App!
                 if (app)
                     app->OnUpdate(dt);
                 accumulator -= dt;
             }
+            profiler.EndPhase(FramePhase::Update);
 
             // 3. Render
+            profiler.BeginPhase(FramePhase::Render);
             if (app)
                 app->OnRender();
+            profiler.EndPhase(FramePhase::Render);
+
+            profiler.BeginPhase(FramePhase::Post);
+            post.Apply(renderer, &jobs);
+            profiler.EndPhase(FramePhase::Post);
+
+            profiler.BeginPhase(FramePhase::Present);
             renderer.Present(frame);
 
+            // This frame's presses wait for its present to complete (Xlib: already, XSync returned; XCB: its fence reply)
+            for (std::size_t i = pendingInputCount - unpresentedInput; i < pendingInputCount; ++i)
+                pendingInput[(pendingInputHead + i) % pendingInput.size()].present = frame.GetPresentCount();
+            unpresentedInput = 0;
+            RetireInput();
+            if (capture.IsActive())
+                capture.Submit(renderer.GetPresentedImage(), renderer.GetWindowWidth(), renderer.GetWindowHeight());
+            profiler.EndPhase(FramePhase::Present);
+
             // 4. Performance Monitoring
             frameCount++;
             auto elapsedTotal = duration_cast<seconds>(currentTime - startTime).count();
             if (elapsedTotal >= 1) {
-                std::string newTitle = "X11 Engine - FPS: " + std::to_string(frameCount) + " | TPS: " + std::to_string((int)tickRate);
-                XStoreName(frame.GetDisplay(), frame.GetWindow(), newTitle.c_str());
+                std::snprintf(title, sizeof(title), "X11 Engine - FPS: %d | TPS: %d", frameCount, (int)tickRate);
+                frame.SetTitle(title);
                 frameCount = 0;
                 startTime = currentTime;
             }
 
-            // 5. FPS Capping
-            auto frameEndTime = high_resolution_clock::now();
-            double actualFrameDuration = duration<double>(frameEndTime - currentTime).count();
+            profiler.EndFrame();
+            memory::ForbidThreadAllocations(false);
+            memory::RecordAllocationSites(false);
+
+            const FrameTiming& timing = profiler.GetLastFrame();
+            if (trackAllocations && timing.frame >= steadyFrame) {
+                steadyFrames++;
+                allocatingFrames += timing.allocations.count > 0;
+                for (std::size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+                    steadyAllocations[i] += timing.phaseAllocations[i];
+            }
+
+            if (telemetry.IsOpen())
+                PublishTelemetry();
 
+            if (app)
+                app->OnFrameEnd(profiler.GetLastFrame());
+
+            double actualFrameDuration = profiler.GetLastFrame().total;
+
+            // 5. Dynamic Resolution (takes effect on the next frame)
+            if (dynamicResolution)
+                renderer.SetRenderScale(frame, resolution.Update(actualFrameDuration));
+
+            // 6. FPS Capping
             if (actualFrameDuration < minFrameTime)
                 usleep(static_cast<useconds_t>((minFrameTime - actualFrameDuration) * 1000000));
         }
+
+        if (allocationCheck == memory::AllocationCheck::Track)
+            ReportAllocations();
+        memory::TrackThreadAllocations(false);
+    }
+
+    void Engine::DeliverInput(double tickEnd, bool lastTick) {
+        // A tick gets the events that arrived before its end; the frame's last tick takes everything queued so far,
+        // input is never held back for a tick that will only run next frame
+        input.BeginTick(tickEnd - 1.0 / TICK_RATE, tickEnd);
+        for (const InputEvent* event = inputEvents.Peek(); event && (lastTick || event->time <= tickEnd); event = inputEvents.Peek()) {
+            bool press = event->type == InputEventType::KeyDown || event->type == InputEventType::ButtonDown;
+            if (press && pendingInputCount < pendingInput.size()) {
+                pendingInput[(pendingInputHead + pendingInputCount++) % pendingInput.size()] = {event->time, 0};
+                unpresentedInput++;
+            }
+            input.Process(*event);
+            inputEvents.Pop();
+        }
+    }
+
+    void Engine::RetireInput() {
+        // Completion is noticed when polled (after each present and at the start of each frame), which bounds how late the stamp can be
+        if (pendingInputCount == unpresentedInput)
+            return;
+        uint64_t completed = frame.PollCompletedPresents();
+        double now = Profiler::Now();
+        while (pendingInputCount > unpresentedInput && pendingInput[pendingInputHead].present <= completed) {
+            profiler.RecordInputLatency(now - pendingInput[pendingInputHead].arrival);
+            pendingInputHead = (pendingInputHead + 1) % pendingInput.size();
+            pendingInputCount--;
+        }
+    }
+
+    void Engine::PublishTelemetry() {
+        const FrameTiming& timing = profiler.GetLastFrame();
+        RenderStats stats = renderer.GetStats();
+
+        TelemetrySample sample{};
+        sample.frame = timing.frame;
+        sample.time = Profiler::Now();
+        sample.frameTime = timing.total;
+        for (std::size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+            sample.phases[i] = timing.phases[i];
+        sample.objects = stats.objects;
+        sample.lines = stats.lines;
+        sample.pixels = stats.pixels;
+        sample.allocations = timing.allocations.count;
+        sample.allocatedBytes = timing.allocations.bytes;
+        sample.inputEvents = timing.inputEvents;
+        sample.inputLatency = timing.inputLatency;
+
+        const LatencyHistogram& latency = profiler.GetInputLatency();
+        sample.inputLatencyCount = latency.GetCount();
+        sample.inputLatencyMean = latency.GetMean();
+        std::copy(latency.GetBuckets().begin(), latency.GetBuckets().end(), sample.inputLatencyBuckets);
+        telemetry.Publish(sample);
+    }
+
+    void Engine::ReportAllocations() const {
+        memory::AllocationStats total{};
+        for (const memory::AllocationStats& phase : steadyAllocations)
+            total += phase;
+
+        std::cerr << "Allocations: " << total.count << " (" << total.bytes << " bytes) in " << allocatingFrames << " of " << steadyFrames << " steady-state frames";
+        for (std::size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+            std::cerr << (i ? ", " : " - ") << GetFramePhaseName(static_cast<FramePhase>(i)) << " " << steadyAllocations[i].count;
+        std::cerr << std::endl;
+
+        std::array<memory::AllocationSite, 8> sites;
+        std::size_t count = memory::GetAllocationSites(sites);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::cerr << "  " << sites[i].count << " allocations, " << sites[i].bytes << " bytes at:" << std::endl;
+            memory::PrintAllocationSite(sites[i]);
+        }
     }
 
 } // namespace x11engine
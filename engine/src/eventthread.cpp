@@ -0,0 +1,191 @@
+#include "x11engine/eventthread.hpp"
+#include "x11engine/profiler.hpp"
+
+#include <X11/Xutil.h>
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(X11ENGINE_HAS_XI2) && __has_include(<X11/extensions/XInput2.h>)
+#include <X11/extensions/XInput2.h>
+#define X11ENGINE_XI2 1
+#endif
+
+namespace x11engine {
+
+    InputEventQueue::InputEventQueue(std::size_t capacity) : ring(std::bit_ceil(std::max<std::size_t>(capacity, 2))), mask(ring.size() - 1) {}
+
+    bool InputEventQueue::Push(const InputEvent& event) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == ring.size()) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        ring[h & mask] = event;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    const InputEvent* InputEventQueue::Peek() const {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return nullptr;
+        return &ring[t & mask];
+    }
+
+    void InputEventQueue::Pop() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    EventThread::~EventThread() { Stop(); }
+
+    bool EventThread::Start(Window target, bool rawMotion, InputEventQueue& events) {
+        Stop();
+
+        // 1. A connection of our own: Xlib connections aren't thread-safe, but two of them on two threads are fine
+        display = XOpenDisplay(NULL);
+        if (!display) {
+            std::cerr << "Event thread: failed to open X display" << std::endl;
+            return false;
+        }
+        if (pipe2(wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+            std::cerr << "Event thread: failed to create wake pipe" << std::endl;
+            XCloseDisplay(display);
+            display = nullptr;
+            return false;
+        }
+
+        // 2. Any client may select input on any window; button presses are exclusive, the window connection doesn't take them
+        window = target;
+        XSelectInput(display, window, KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask);
+        if (rawMotion && !EnableRawMotion())
+            std::cerr << "Event thread: XInput2 raw motion not available" << std::endl;
+        XFlush(display);
+
+        queue = &events;
+        stopping = false;
+        thread = std::thread([this] { Loop(); });
+        return true;
+    }
+
+    void EventThread::Stop() {
+        if (thread.joinable()) {
+            stopping = true;
+            char byte = 0;
+            [[maybe_unused]] ssize_t written = write(wake[1], &byte, 1);
+            thread.join();
+
+            if (uint64_t dropped = queue->GetDroppedEvents())
+                std::cerr << "Event thread: dropped " << dropped << " events (queue full)" << std::endl;
+        }
+
+        if (display) {
+            XCloseDisplay(display);
+            display = nullptr;
+        }
+        for (int& fd : wake) {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+        xiOpcode = -1;
+        queue = nullptr;
+    }
+
+    bool EventThread::EnableRawMotion() {
+#ifdef X11ENGINE_XI2
+        int opcode = 0, event = 0, error = 0;
+        if (!XQueryExtension(display, "XInputExtension", &opcode, &event, &error))
+            return false;
+        int major = 2, minor = 0;
+        if (XIQueryVersion(display, &major, &minor) != Success)
+            return false;
+
+        // Raw events are only delivered to the root window
+        unsigned char bits[XIMaskLen(XI_LASTEVENT)] = {};
+        XISetMask(bits, XI_RawMotion);
+        XIEventMask eventMask{XIAllMasterDevices, static_cast<int>(sizeof(bits)), bits};
+        if (XISelectEvents(display, DefaultRootWindow(display), &eventMask, 1) != Success)
+            return false;
+        xiOpcode = opcode;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void EventThread::Loop() {
+        pollfd fds[2] = {{ConnectionNumber(display), POLLIN, 0}, {wake[0], POLLIN, 0}};
+        XEvent event;
+        InputEvent out;
+
+        while (!stopping.load(std::memory_order_relaxed)) {
+            // 1. Everything already read or waiting on the socket, stamped as it is taken off
+            while (XPending(display) > 0) {
+                XNextEvent(display, &event);
+                if (Translate(event, out)) {
+                    out.time = Profiler::Now();
+                    queue->Push(out);
+                }
+            }
+
+            // 2. Sleep until the server sends more (or Stop)
+            if (poll(fds, 2, -1) < 0 && errno != EINTR)
+                break;
+        }
+    }
+
+    bool EventThread::Translate(XEvent& event, InputEvent& out) {
+        out = {};
+        switch (event.type) {
+            case KeyPress:
+            case KeyRelease:
+                out.type = event.type == KeyPress ? InputEventType::KeyDown : InputEventType::KeyUp;
+                out.serverTime = static_cast<uint32_t>(event.xkey.time);
+                out.key = XLookupKeysym(&event.xkey, 0);
+                out.x = event.xkey.x;
+                out.y = event.xkey.y;
+                return true;
+            case ButtonPress:
+            case ButtonRelease:
+                out.type = event.type == ButtonPress ? InputEventType::ButtonDown : InputEventType::ButtonUp;
+                out.serverTime = static_cast<uint32_t>(event.xbutton.time);
+                out.button = static_cast<int>(event.xbutton.button);
+                out.x = event.xbutton.x;
+                out.y = event.xbutton.y;
+                return true;
+            case MotionNotify:
+                out.type = InputEventType::Motion;
+                out.serverTime = static_cast<uint32_t>(event.xmotion.time);
+                out.x = event.xmotion.x;
+                out.y = event.xmotion.y;
+                return true;
+            default:
+                break;
+        }
+
+#ifdef X11ENGINE_XI2
+        if (event.type == GenericEvent && event.xcookie.extension == xiOpcode && XGetEventData(display, &event.xcookie)) {
+            bool translated = false;
+            if (event.xcookie.evtype == XI_RawMotion) {
+                // raw_values holds one value per set bit of the valuator mask; axes 0 and 1 are x and y
+                const XIRawEvent* raw = static_cast<const XIRawEvent*>(event.xcookie.data);
+                const double* value = raw->raw_values;
+                for (int axis = 0; axis < 2 && axis < raw->valuators.mask_len * 8; ++axis) {
+                    if (XIMaskIsSet(raw->valuators.mask, axis))
+                        (axis == 0 ? out.dx : out.dy) = *value++;
+                }
+                out.type = InputEventType::RawMotion;
+                out.serverTime = static_cast<uint32_t>(raw->time);
+                translated = true;
+            }
+            XFreeEventData(display, &event.xcookie);
+            return translated;
+        }
+#endif
+        return false;
+    }
+
+} // namespace x11engine
@@ -1,51 +1,220 @@
 #include "x11engine/frame.hpp"
+#include "frame_backend.hpp"
 
 #include <X11/Xutil.h>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 namespace x11engine {
 
-    Frame::Frame(int width, int height, const std::string& title) : width(width), height(height), title(title), display(nullptr), window(0) {}
+    namespace {
+        class XlibBackend final : public FrameBackend {
+        public:
+            ~XlibBackend() override {
+                if (display) {
+                    XDestroyWindow(display, window);
+                    XCloseDisplay(display);
+                }
+            }
 
-    Frame::~Frame() {
-        if (display) {
-            XDestroyWindow(display, window);
-            XCloseDisplay(display);
-        }
-    }
+            bool Init(int width, int height, const std::string& title) override {
+                display = XOpenDisplay(NULL);
+                if (!display) {
+                    std::cerr << "Failed to open X display" << std::endl;
+                    return false;
+                }
 
-    bool Frame::Init() {
-        display = XOpenDisplay(NULL);
-        if (!display) {
-            std::cerr << "Failed to open X display" << std::endl;
-            return false;
-        }
+                screen = DefaultScreen(display);
+                Window root = RootWindow(display, screen);
+
+                window = XCreateSimpleWindow(display, root, 10, 10, width, height, 1, BlackPixel(display, screen), WhitePixel(display, screen));
+
+                XSelectInput(display, window, ExposureMask | KeyPressMask | KeyReleaseMask | StructureNotifyMask);
+                XStoreName(display, window, title.c_str());
+
+                wmDeleteMessage = XInternAtom(display, "WM_DELETE_WINDOW", False);
+                XSetWMProtocols(display, window, &wmDeleteMessage, 1);
+
+                XMapWindow(display, window);
+
+                // The visual never changes for a window: negotiate its pixel layout once
+                visual = DefaultVisual(display, screen);
+                pixelFormat = DescribeVisual(display, visual, DefaultDepth(display, screen));
+                return true;
+            }
+
+            void Resize(int width, int height) override { XResizeWindow(display, window, width, height); }
+            void SetTitle(const std::string& title) override { XStoreName(display, window, title.c_str()); }
+
+            bool PollEvent(XEvent& event) override {
+                if (XPending(display) == 0)
+                    return false;
+                XNextEvent(display, &event);
+                return true;
+            }
+
+            void WaitEvent(XEvent& event) override { XNextEvent(display, &event); }
+
+            KeySym LookupKeysym(const XKeyEvent& event) const override { return XLookupKeysym(const_cast<XKeyEvent*>(&event), 0); }
+
+            void PresentImage(const void* data, int width, int height, int bytesPerLine) override {
+                presents++; // Done when this returns, shown or dropped
+
+                // Describe the caller's buffer in place, no XImage allocation per frame or per resize
+                image.width = width;
+                image.height = height;
+                image.xoffset = 0;
+                image.format = ZPixmap;
+                image.data = const_cast<char*>(static_cast<const char*>(data));
+                image.byte_order = ImageByteOrder(display);
+                image.bitmap_unit = BitmapUnit(display);
+                image.bitmap_bit_order = BitmapBitOrder(display);
+                image.bitmap_pad = pixelFormat.scanlinePad;
+                image.depth = pixelFormat.depth;
+                image.bytes_per_line = bytesPerLine;
+                image.bits_per_pixel = pixelFormat.bitsPerPixel;
+                image.red_mask = visual->red_mask;
+                image.green_mask = visual->green_mask;
+                image.blue_mask = visual->blue_mask;
+                if (!XInitImage(&image))
+                    return;
+
+                XPutImage(display, window, DefaultGC(display, screen), &image, 0, 0, 0, 0, width, height);
+
+                // Sync to ensure commands are processed
+                XSync(display, False);
+            }
+
+            uint64_t PollCompletedPresents() override { return presents; }
+
+            const PixelFormatInfo& GetPixelFormat() const override { return pixelFormat; }
+            Display* GetDisplay() const override { return display; }
+            Window GetWindow() const override { return window; }
+            int GetScreen() const override { return screen; }
+            Atom GetWMDeleteMessage() const override { return wmDeleteMessage; }
+
+        private:
+            Display* display = nullptr;
+            Window window = 0;
+            int screen = 0;
+            Atom wmDeleteMessage = 0;
+            Visual* visual = nullptr;
+            PixelFormatInfo pixelFormat{};
+            XImage image{};
+            uint64_t presents = 0;
+        };
 
-        screen = DefaultScreen(display);
-        Window root = RootWindow(display, screen);
+        class HeadlessBackend final : public FrameBackend {
+        public:
+            bool Init(int, int, const std::string&) override {
+                // Same layout as the framebuffer, so Present never converts
+                bool lsb = std::endian::native == std::endian::little;
+                pixelFormat = DescribePixelFormat(24, 32, 32, 0xFF0000, 0x00FF00, 0x0000FF, lsb, true);
+                return true;
+            }
 
-        window = XCreateSimpleWindow(display, root, 10, 10, width, height, 1, BlackPixel(display, screen), WhitePixel(display, screen));
+            void Resize(int, int) override {}
+            void SetTitle(const std::string&) override {}
 
-        XSelectInput(display, window, ExposureMask | KeyPressMask | KeyReleaseMask | StructureNotifyMask);
-        XStoreName(display, window, title.c_str());
+            bool PollEvent(XEvent&) override { return false; }
 
-        wmDeleteMessage = XInternAtom(display, "WM_DELETE_WINDOW", False);
-        XSetWMProtocols(display, window, &wmDeleteMessage, 1);
+            void WaitEvent(XEvent& event) override {
+                // The only event anyone waits for is the window being mapped
+                event = XEvent{};
+                event.type = MapNotify;
+            }
 
-        XMapWindow(display, window);
+            KeySym LookupKeysym(const XKeyEvent&) const override { return NoSymbol; }
+            void PresentImage(const void*, int, int, int) override { presents++; }
+            uint64_t PollCompletedPresents() override { return presents; }
 
-        return true;
+            const PixelFormatInfo& GetPixelFormat() const override { return pixelFormat; }
+            Display* GetDisplay() const override { return nullptr; }
+            Window GetWindow() const override { return 0; }
+            int GetScreen() const override { return 0; }
+            Atom GetWMDeleteMessage() const override { return 0; }
+
+        private:
+            PixelFormatInfo pixelFormat{};
+            uint64_t presents = 0;
+        };
+    } // namespace
+
+    Frame::Frame(int width, int height, const std::string& title) : width(width), height(height), title(title), backend(WindowBackend::Xlib), presentCount(0) {}
+
+    Frame::~Frame() = default;
+
+    void Frame::SetBackend(WindowBackend newBackend) {
+        if (!impl)
+            backend = newBackend;
+    }
+
+    bool Frame::Init() {
+        // 1. Launch-time override
+        if (const char* env = std::getenv("X11ENGINE_BACKEND")) {
+            if (std::strcmp(env, "xcb") == 0)
+                backend = WindowBackend::Xcb;
+            else if (std::strcmp(env, "xlib") == 0)
+                backend = WindowBackend::Xlib;
+            else if (std::strcmp(env, "headless") == 0)
+                backend = WindowBackend::Headless;
+        }
+
+        // 2. Create the backend, XCB falls back to Xlib when it wasn't compiled in
+        if (backend == WindowBackend::Xcb) {
+            impl = CreateXcbBackend();
+            if (!impl) {
+                std::cerr << "XCB backend not available in this build, using Xlib" << std::endl;
+                backend = WindowBackend::Xlib;
+            }
+        }
+        if (backend == WindowBackend::Headless)
+            impl = std::make_unique<HeadlessBackend>();
+        if (!impl)
+            impl = std::make_unique<XlibBackend>();
+
+        return impl->Init(width, height, title);
     }
 
     void Frame::Resize(int newWidth, int newHeight) {
         width = newWidth;
         height = newHeight;
-        XResizeWindow(display, window, width, height);
+        impl->Resize(width, height);
+    }
+
+    void Frame::SetTitle(std::string_view newTitle) {
+        title.assign(newTitle);
+        impl->SetTitle(title);
+    }
+
+    bool Frame::PollEvent(XEvent& event) { return impl->PollEvent(event); }
+    void Frame::WaitEvent(XEvent& event) { impl->WaitEvent(event); }
+    KeySym Frame::LookupKeysym(const XKeyEvent& event) const { return impl->LookupKeysym(event); }
+
+    void Frame::PresentImage(const void* data, int width, int height, int bytesPerLine) {
+        presentCount++;
+        impl->PresentImage(data, width, height, bytesPerLine);
     }
 
-    Display* Frame::GetDisplay() const { return display; }
-    Window Frame::GetWindow() const { return window; }
-    int Frame::GetScreen() const { return screen; }
-    Atom Frame::GetWMDeleteMessage() const { return wmDeleteMessage; }
+    uint64_t Frame::PollCompletedPresents() { return impl ? impl->PollCompletedPresents() : presentCount; }
+
+    const PixelFormatInfo& Frame::GetPixelFormat() const { return impl->GetPixelFormat(); }
+    Display* Frame::GetDisplay() const { return impl ? impl->GetDisplay() : nullptr; }
+    Window Frame::GetWindow() const { return impl ? impl->GetWindow() : 0; }
+    int Frame::GetScreen() const { return impl ? impl->GetScreen() : 0; }
+    Atom Frame::GetWMDeleteMessage() const { return impl ? impl->GetWMDeleteMessage() : 0; }
+
+    const char* GetWindowBackendName(WindowBackend backend) {
+        switch (backend) {
+            case WindowBackend::Xcb:
+                return "XCB";
+            case WindowBackend::Headless:
+                return "Headless";
+            default:
+                return "Xlib";
+        }
+    }
 
-} // namespace x11engine
\ No newline at end of file
+} // namespace x11engine
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "x11engine/frame.hpp"
+
+#include <memory>
+
+namespace x11engine {
+
+    // Interface each windowing library implements for Frame (frame.cpp: Xlib, frame_xcb.cpp: XCB)
+    class FrameBackend {
+    public:
+        virtual ~FrameBackend() = default;
+
+        virtual bool Init(int width, int height, const std::string& title) = 0;
+        virtual void Resize(int width, int height) = 0;
+        virtual void SetTitle(const std::string& title) = 0;
+
+        virtual bool PollEvent(XEvent& event) = 0;
+        virtual void WaitEvent(XEvent& event) = 0;
+        virtual KeySym LookupKeysym(const XKeyEvent& event) const = 0;
+
+        virtual void PresentImage(const void* data, int width, int height, int bytesPerLine) = 0;
+        virtual uint64_t PollCompletedPresents() = 0; // See Frame::PollCompletedPresents
+
+        virtual const PixelFormatInfo& GetPixelFormat() const = 0;
+        virtual Display* GetDisplay() const = 0;
+        virtual Window GetWindow() const = 0;
+        virtual int GetScreen() const = 0;
+        virtual Atom GetWMDeleteMessage() const = 0;
+    };
+
+    // nullptr when the engine was built without XCB
+    std::unique_ptr<FrameBackend> CreateXcbBackend();
+
+} // namespace x11engine
@@ -0,0 +1,341 @@
+#include "frame_backend.hpp"
+
+#ifdef X11ENGINE_HAS_XCB
+
+#include <xcb/xcb.h>
+#include <xcb/xcbext.h>
+#include <xcb/xproto.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace x11engine {
+
+    namespace {
+        // Frames that may be queued in the server before Present waits. Bounds latency like a swap chain.
+        constexpr int FRAMES_IN_FLIGHT = 2;
+        constexpr uint32_t PUT_IMAGE_HEADER = 24; // Bytes of a PutImage request before the pixel data
+
+        class XcbBackend final : public FrameBackend {
+        public:
+            ~XcbBackend() override {
+                if (!connection)
+                    return;
+                if (window) {
+                    xcb_free_gc(connection, gc);
+                    xcb_destroy_window(connection, window);
+                    xcb_flush(connection);
+                }
+                xcb_disconnect(connection);
+            }
+
+            bool Init(int width, int height, const std::string& title) override {
+                connection = xcb_connect(nullptr, &screen);
+                if (xcb_connection_has_error(connection)) {
+                    std::cerr << "Failed to open XCB connection" << std::endl;
+                    return false;
+                }
+
+                const xcb_setup_t* setup = xcb_get_setup(connection);
+                xcb_screen_iterator_t it = xcb_setup_roots_iterator(setup);
+                for (int i = 0; i < screen; ++i)
+                    xcb_screen_next(&it);
+                xcb_screen_t* root = it.data;
+
+                // 1. Fire every query up front, the replies are collected once the window exists
+                xcb_prefetch_maximum_request_length(connection);
+                xcb_intern_atom_cookie_t protocolsCookie = xcb_intern_atom(connection, 0, 12, "WM_PROTOCOLS");
+                xcb_intern_atom_cookie_t deleteCookie = xcb_intern_atom(connection, 0, 16, "WM_DELETE_WINDOW");
+                minKeycode = setup->min_keycode;
+                xcb_get_keyboard_mapping_cookie_t keymapCookie = xcb_get_keyboard_mapping(connection, setup->min_keycode, setup->max_keycode - setup->min_keycode + 1);
+
+                // 2. Window and GC (same attributes as XCreateSimpleWindow)
+                window = xcb_generate_id(connection);
+                uint32_t eventMask = XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+                uint32_t values[] = {root->white_pixel, root->black_pixel, eventMask};
+                xcb_create_window(connection, XCB_COPY_FROM_PARENT, window, root->root, 10, 10, width, height, 1, XCB_WINDOW_CLASS_INPUT_OUTPUT, root->root_visual,
+                                  XCB_CW_BACK_PIXEL | XCB_CW_BORDER_PIXEL | XCB_CW_EVENT_MASK, values);
+
+                gc = xcb_generate_id(connection);
+                xcb_create_gc(connection, gc, window, 0, nullptr);
+                SetTitle(title);
+
+                // 3. Collect the replies
+                xcb_intern_atom_reply_t* protocols = xcb_intern_atom_reply(connection, protocolsCookie, nullptr);
+                xcb_intern_atom_reply_t* deleteWindow = xcb_intern_atom_reply(connection, deleteCookie, nullptr);
+                if (protocols && deleteWindow) {
+                    wmDeleteMessage = deleteWindow->atom;
+                    xcb_change_property(connection, XCB_PROP_MODE_REPLACE, window, protocols->atom, XCB_ATOM_ATOM, 32, 1, &deleteWindow->atom);
+                }
+                std::free(protocols);
+                std::free(deleteWindow);
+
+                if (xcb_get_keyboard_mapping_reply_t* keymap = xcb_get_keyboard_mapping_reply(connection, keymapCookie, nullptr)) {
+                    keysymsPerKeycode = keymap->keysyms_per_keycode;
+                    const xcb_keysym_t* syms = xcb_get_keyboard_mapping_keysyms(keymap);
+                    keysyms.assign(syms, syms + xcb_get_keyboard_mapping_keysyms_length(keymap));
+                    std::free(keymap);
+                }
+
+                maxRequestBytes = std::min<uint32_t>(xcb_get_maximum_request_length(connection), 1u << 28) * 4;
+                pixelFormat = DescribeScreen(setup, root);
+
+                xcb_map_window(connection, window);
+                xcb_flush(connection);
+                return true;
+            }
+
+            void Resize(int width, int height) override {
+                uint32_t values[] = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+                xcb_configure_window(connection, window, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, values);
+                xcb_flush(connection);
+            }
+
+            void SetTitle(const std::string& title) override {
+                xcb_change_property(connection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, static_cast<uint32_t>(title.size()), title.data());
+                xcb_flush(connection);
+            }
+
+            bool PollEvent(XEvent& event) override {
+                while (xcb_generic_event_t* raw = xcb_poll_for_event(connection)) {
+                    bool translated = Translate(raw, event);
+                    std::free(raw);
+                    if (translated)
+                        return true;
+                }
+                return ConnectionLost(event);
+            }
+
+            void WaitEvent(XEvent& event) override {
+                while (xcb_generic_event_t* raw = xcb_wait_for_event(connection)) {
+                    bool translated = Translate(raw, event);
+                    std::free(raw);
+                    if (translated)
+                        return;
+                }
+                ConnectionLost(event);
+            }
+
+            KeySym LookupKeysym(const XKeyEvent& event) const override {
+                // Column 0 of the core keymap, like XLookupKeysym(event, 0)
+                int keycode = static_cast<int>(event.keycode);
+                if (keycode < minKeycode)
+                    return NoSymbol;
+                std::size_t index = static_cast<std::size_t>(keycode - minKeycode) * static_cast<std::size_t>(keysymsPerKeycode);
+                return index < keysyms.size() ? keysyms[index] : NoSymbol;
+            }
+
+            void PresentImage(const void* data, int width, int height, int bytesPerLine) override {
+                // 1. Retire the frame that last used this slot. Its fence reply proves the server got past those
+                //    PutImage requests, so checking their cookies no longer costs a round-trip.
+                InFlight& frame = inFlight[slot];
+                Retire(frame);
+
+                // 2. Send the image in bands that fit the maximum request length (BIG-REQUESTS when the server has it)
+                int bandRows = static_cast<int>(std::max<uint32_t>(1, (maxRequestBytes - PUT_IMAGE_HEADER) / static_cast<uint32_t>(bytesPerLine)));
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                for (int y = 0; y < height; y += bandRows) {
+                    int rows = std::min(bandRows, height - y);
+                    frame.puts.push_back(xcb_put_image_checked(connection, XCB_IMAGE_FORMAT_Z_PIXMAP, window, gc, width, rows, 0, y, 0, pixelFormat.depth,
+                                                               static_cast<uint32_t>(rows) * bytesPerLine, bytes + static_cast<std::size_t>(y) * bytesPerLine));
+                }
+
+                // 3. Cheapest request with a reply, used as a fence. Flush without waiting for anything.
+                frame.fence = xcb_get_input_focus(connection);
+                frame.pending = true;
+                xcb_flush(connection);
+
+                slot = (slot + 1) % FRAMES_IN_FLIGHT;
+            }
+
+            uint64_t PollCompletedPresents() override {
+                // Fences come back in request order: check the in-flight frames from the oldest ('slot' is reused next)
+                for (int i = 0; i < FRAMES_IN_FLIGHT; ++i) {
+                    InFlight& frame = inFlight[(slot + i) % FRAMES_IN_FLIGHT];
+                    if (!frame.pending || frame.fenced)
+                        continue;
+                    void* reply = nullptr;
+                    xcb_generic_error_t* error = nullptr;
+                    if (!xcb_poll_for_reply(connection, frame.fence.sequence, &reply, &error))
+                        break;
+                    std::free(reply);
+                    std::free(error);
+                    frame.fenced = true;
+                    completed++;
+                }
+                return completed;
+            }
+
+            const PixelFormatInfo& GetPixelFormat() const override { return pixelFormat; }
+            Display* GetDisplay() const override { return nullptr; }
+            Window GetWindow() const override { return window; }
+            int GetScreen() const override { return screen; }
+            Atom GetWMDeleteMessage() const override { return wmDeleteMessage; }
+
+        private:
+            struct InFlight {
+                std::vector<xcb_void_cookie_t> puts;
+                xcb_get_input_focus_cookie_t fence{};
+                bool pending = false;
+                bool fenced = false; // Fence reply already taken by PollCompletedPresents
+            };
+
+            void Retire(InFlight& frame) {
+                if (!frame.pending)
+                    return;
+
+                if (!frame.fenced) {
+                    std::free(xcb_get_input_focus_reply(connection, frame.fence, nullptr));
+                    completed++;
+                }
+                for (xcb_void_cookie_t cookie : frame.puts) {
+                    if (xcb_generic_error_t* error = xcb_request_check(connection, cookie)) {
+                        std::cerr << "xcb_put_image failed (error " << static_cast<int>(error->error_code) << ")" << std::endl;
+                        std::free(error);
+                    }
+                }
+                frame.puts.clear();
+                frame.pending = false;
+                frame.fenced = false;
+            }
+
+            static PixelFormatInfo DescribeScreen(const xcb_setup_t* setup, const xcb_screen_t* root) {
+                int bitsPerPixel = 32;
+                int scanlinePad = 32;
+                for (xcb_format_iterator_t it = xcb_setup_pixmap_formats_iterator(setup); it.rem; xcb_format_next(&it)) {
+                    if (it.data->depth == root->root_depth) {
+                        bitsPerPixel = it.data->bits_per_pixel;
+                        scanlinePad = it.data->scanline_pad;
+                        break;
+                    }
+                }
+
+                for (xcb_depth_iterator_t depth = xcb_screen_allowed_depths_iterator(root); depth.rem; xcb_depth_next(&depth)) {
+                    for (xcb_visualtype_iterator_t visual = xcb_depth_visuals_iterator(depth.data); visual.rem; xcb_visualtype_next(&visual)) {
+                        if (visual.data->visual_id != root->root_visual)
+                            continue;
+                        bool trueColor = visual.data->_class == XCB_VISUAL_CLASS_TRUE_COLOR || visual.data->_class == XCB_VISUAL_CLASS_DIRECT_COLOR;
+                        return DescribePixelFormat(root->root_depth, bitsPerPixel, scanlinePad, visual.data->red_mask, visual.data->green_mask, visual.data->blue_mask,
+                                                   setup->image_byte_order == XCB_IMAGE_ORDER_LSB_FIRST, trueColor);
+                    }
+                }
+                return DescribePixelFormat(root->root_depth, bitsPerPixel, scanlinePad, 0xFF0000, 0x00FF00, 0x0000FF, setup->image_byte_order == XCB_IMAGE_ORDER_LSB_FIRST, true);
+            }
+
+            // Converts the events the engine listens to into their Xlib layout. False for anything else.
+            bool Translate(const xcb_generic_event_t* raw, XEvent& event) const {
+                event = XEvent{};
+                switch (raw->response_type & ~0x80) {
+                    case 0: {
+                        // Errors of unchecked requests (checked PutImage errors are reported by Retire)
+                        const xcb_generic_error_t* error = reinterpret_cast<const xcb_generic_error_t*>(raw);
+                        std::cerr << "X error " << static_cast<int>(error->error_code) << " (request " << static_cast<int>(error->major_code) << ")" << std::endl;
+                        return false;
+                    }
+                    case XCB_KEY_PRESS:
+                    case XCB_KEY_RELEASE: {
+                        const xcb_key_press_event_t* key = reinterpret_cast<const xcb_key_press_event_t*>(raw);
+                        event.xkey.type = (raw->response_type & ~0x80) == XCB_KEY_PRESS ? KeyPress : KeyRelease;
+                        event.xkey.serial = key->sequence;
+                        event.xkey.window = key->event;
+                        event.xkey.root = key->root;
+                        event.xkey.subwindow = key->child;
+                        event.xkey.time = key->time;
+                        event.xkey.x = key->event_x;
+                        event.xkey.y = key->event_y;
+                        event.xkey.x_root = key->root_x;
+                        event.xkey.y_root = key->root_y;
+                        event.xkey.state = key->state;
+                        event.xkey.keycode = key->detail;
+                        event.xkey.same_screen = key->same_screen;
+                        return true;
+                    }
+                    case XCB_CONFIGURE_NOTIFY: {
+                        const xcb_configure_notify_event_t* configure = reinterpret_cast<const xcb_configure_notify_event_t*>(raw);
+                        event.xconfigure.type = ConfigureNotify;
+                        event.xconfigure.serial = configure->sequence;
+                        event.xconfigure.event = configure->event;
+                        event.xconfigure.window = configure->window;
+                        event.xconfigure.x = configure->x;
+                        event.xconfigure.y = configure->y;
+                        event.xconfigure.width = configure->width;
+                        event.xconfigure.height = configure->height;
+                        event.xconfigure.border_width = configure->border_width;
+                        event.xconfigure.above = configure->above_sibling;
+                        event.xconfigure.override_redirect = configure->override_redirect;
+                        return true;
+                    }
+                    case XCB_CLIENT_MESSAGE: {
+                        const xcb_client_message_event_t* message = reinterpret_cast<const xcb_client_message_event_t*>(raw);
+                        event.xclient.type = ClientMessage;
+                        event.xclient.serial = message->sequence;
+                        event.xclient.window = message->window;
+                        event.xclient.message_type = message->type;
+                        event.xclient.format = message->format;
+                        for (int i = 0; i < 5; ++i)
+                            event.xclient.data.l[i] = message->data.data32[i];
+                        return true;
+                    }
+                    case XCB_MAP_NOTIFY:
+                        event.xmap.type = MapNotify;
+                        event.xmap.window = reinterpret_cast<const xcb_map_notify_event_t*>(raw)->window;
+                        return true;
+                    case XCB_EXPOSE:
+                        event.xexpose.type = Expose;
+                        event.xexpose.window = reinterpret_cast<const xcb_expose_event_t*>(raw)->window;
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            // Xlib exits the process when the server goes away; here the engine gets a regular close request instead
+            bool ConnectionLost(XEvent& event) {
+                if (lost || !xcb_connection_has_error(connection))
+                    return false;
+                lost = true;
+                event = XEvent{};
+                event.xclient.type = ClientMessage;
+                event.xclient.window = window;
+                event.xclient.format = 32;
+                event.xclient.data.l[0] = static_cast<long>(wmDeleteMessage);
+                return true;
+            }
+
+        private:
+            xcb_connection_t* connection = nullptr;
+            int screen = 0;
+            xcb_window_t window = 0;
+            xcb_gcontext_t gc = 0;
+            xcb_atom_t wmDeleteMessage = 0;
+            uint32_t maxRequestBytes = 0;
+            PixelFormatInfo pixelFormat{};
+
+            std::vector<xcb_keysym_t> keysyms;
+            int keysymsPerKeycode = 0;
+            int minKeycode = 0;
+
+            std::array<InFlight, FRAMES_IN_FLIGHT> inFlight;
+            int slot = 0;
+            uint64_t completed = 0; // Frames whose fence has replied
+            bool lost = false;
+        };
+    } // namespace
+
+    std::unique_ptr<FrameBackend> CreateXcbBackend() { return std::make_unique<XcbBackend>(); }
+
+} // namespace x11engine
+
+#else
+
+namespace x11engine {
+
+    std::unique_ptr<FrameBackend> CreateXcbBackend() { return nullptr; }
+
+} // namespace x11engine
+
+#endif
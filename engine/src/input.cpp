@@ -1,23 +1,87 @@
 #include "x11engine/input.hpp"
 
+#include <algorithm>
+
 namespace x11engine {
 
+    Input::Input() {
+        // Process stops recording at this capacity, so delivery never allocates
+        events.reserve(MAX_TICK_EVENTS);
+    }
+
     void Input::ProcessEvent(const XEvent& event) {
-        if (event.type == KeyPress) {
-            KeySym key = XLookupKeysym(const_cast<XKeyEvent*>(&event.xkey), 0);
-            keys[key] = true;
+        if (event.type == KeyPress || event.type == KeyRelease)
+            ProcessKey(XLookupKeysym(const_cast<XKeyEvent*>(&event.xkey), 0), event.type == KeyPress);
+    }
 
-        } else if (event.type == KeyRelease) {
-            KeySym key = XLookupKeysym(const_cast<XKeyEvent*>(&event.xkey), 0);
-            keys[key] = false;
+    namespace {
+        // Bit for keysyms in the 0x00xx and 0xffxx pages, -1 for everything else
+        inline int PageBit(KeySym key) {
+            if (key <= 0xff)
+                return static_cast<int>(key);
+            if (key >= 0xff00 && key <= 0xffff)
+                return static_cast<int>(key - 0xff00) + 256;
+            return -1;
         }
+    } // namespace
+
+    void Input::ProcessKey(KeySym key, bool pressed) {
+        if (int bit = PageBit(key); bit >= 0) {
+            pageKeys[bit] = pressed;
+            return;
+        }
+
+        // Other keysyms are listed only while held; past MAX_OTHER_KEYS held at once a press is ignored
+        auto end = otherKeys.begin() + otherKeyCount;
+        auto it = std::find(otherKeys.begin(), end, key);
+        if (pressed && it == end && otherKeyCount < MAX_OTHER_KEYS)
+            otherKeys[otherKeyCount++] = key;
+        else if (!pressed && it != end)
+            *it = otherKeys[--otherKeyCount];
     }
 
     bool Input::IsKeyDown(KeySym key) const {
-        auto it = keys.find(key);
-        if (it != keys.end())
-            return it->second;
-        return false;
+        if (int bit = PageBit(key); bit >= 0)
+            return pageKeys[bit];
+        auto end = otherKeys.begin() + otherKeyCount;
+        return std::find(otherKeys.begin(), end, key) != end;
+    }
+
+    void Input::BeginTick(double start, double end) {
+        events.clear();
+        tickStart = start;
+        tickEnd = end;
+        rawX = 0.0;
+        rawY = 0.0;
+    }
+
+    void Input::Process(const InputEvent& event) {
+        switch (event.type) {
+            case InputEventType::KeyDown:
+            case InputEventType::KeyUp:
+                ProcessKey(event.key, event.type == InputEventType::KeyDown);
+                break;
+            case InputEventType::ButtonDown:
+            case InputEventType::ButtonUp:
+                if (event.button > 0 && event.button < 32) {
+                    uint32_t bit = 1u << event.button;
+                    buttons = event.type == InputEventType::ButtonDown ? buttons | bit : buttons & ~bit;
+                }
+                break;
+            case InputEventType::Motion:
+                break;
+            case InputEventType::RawMotion:
+                rawX += event.dx;
+                rawY += event.dy;
+                break;
+        }
+
+        if (event.type != InputEventType::RawMotion) {
+            mouseX = event.x;
+            mouseY = event.y;
+        }
+        if (events.size() < MAX_TICK_EVENTS)
+            events.push_back(event);
     }
 
-} // namespace x11engine
\ No newline at end of file
+} // namespace x11engine
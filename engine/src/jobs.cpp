@@ -0,0 +1,80 @@
+#include "x11engine/jobs.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace x11engine {
+
+    ThreadPool::ThreadPool(unsigned threads) {
+        if (threads == 0) {
+            const char* env = std::getenv("X11ENGINE_THREADS");
+            threads = env ? static_cast<unsigned>(std::max(1, std::atoi(env))) : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        workers.reserve(threads - 1);
+        for (unsigned i = 1; i < threads; ++i)
+            workers.emplace_back([this] { WorkerLoop(); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        stopping = true;
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    void ThreadPool::Run(std::size_t count, std::size_t grain, ChunkFn fn, void* context) {
+        if (count == 0)
+            return;
+        grain = std::max<std::size_t>(grain, 1);
+
+        // Not worth waking anyone
+        if (workers.empty() || count <= grain) {
+            for (std::size_t begin = 0; begin < count; begin += grain)
+                fn(context, begin, std::min(begin + grain, count));
+            return;
+        }
+
+        // 1. Publish the job (the release on 'generation' makes the fields visible to the workers)
+        jobFn = fn;
+        jobContext = context;
+        jobCount = count;
+        jobGrain = grain;
+        nextChunk.store(0, std::memory_order_relaxed);
+        busy.store(static_cast<unsigned>(workers.size()), std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+
+        // 2. Help out
+        Work();
+
+        // 3. Wait for the workers still finishing their last chunk
+        for (unsigned remaining = busy.load(std::memory_order_acquire); remaining != 0; remaining = busy.load(std::memory_order_acquire))
+            busy.wait(remaining, std::memory_order_acquire);
+    }
+
+    void ThreadPool::Work() {
+        while (true) {
+            std::size_t begin = nextChunk.fetch_add(1, std::memory_order_relaxed) * jobGrain;
+            if (begin >= jobCount)
+                return;
+            jobFn(jobContext, begin, std::min(begin + jobGrain, jobCount));
+        }
+    }
+
+    void ThreadPool::WorkerLoop() {
+        uint32_t seen = 0;
+        while (true) {
+            generation.wait(seen, std::memory_order_acquire);
+            seen = generation.load(std::memory_order_acquire);
+            if (stopping)
+                return;
+
+            Work();
+            if (busy.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                busy.notify_one();
+        }
+    }
+
+} // namespace x11engine
@@ -0,0 +1,1759 @@
+#include "x11engine/kernels.hpp"
+#include "cpu_target.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cpuid.h>
+#include <cstdlib>
+#include <cstring>
+#include <immintrin.h>
+
+namespace x11engine::kernels {
+
+    namespace {
+        // Fills larger than this skip the cache (they would evict everything else anyway)
+        constexpr std::size_t STREAM_THRESHOLD = 256 * 1024 / sizeof(uint32_t);
+
+        // Shared line setup: pixel i is at base + i * majorStep + q(i) * minorStep,
+        // with q(i) = (major + 2 * i * minor) / (2 * major)
+        struct LineSetup {
+            uint32_t* base;
+            int count; // major + 1 pixels
+            int major;
+            int minor;
+            int majorStep;
+            int minorStep;
+        };
+
+        LineSetup SetupLine(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1) {
+            int adx = std::abs(x1 - x0);
+            int ady = std::abs(y1 - y0);
+            int sx = x0 < x1 ? 1 : -1;
+            int sy = y0 < y1 ? pitch : -pitch;
+
+            LineSetup s;
+            s.base = dst + static_cast<std::ptrdiff_t>(y0) * pitch + x0;
+            if (adx >= ady) {
+                s.major = adx;
+                s.minor = ady;
+                s.majorStep = sx;
+                s.minorStep = sy;
+            } else {
+                s.major = ady;
+                s.minor = adx;
+                s.majorStep = sy;
+                s.minorStep = sx;
+            }
+            s.count = s.major + 1;
+            return s;
+        }
+
+        // Visits pixels [first, count) of the line in order
+        template <class Plot>
+        void WalkLineScalar(const LineSetup& s, int first, Plot&& plot) {
+            if (s.major == 0) {
+                if (first == 0)
+                    plot(s.base);
+                return;
+            }
+
+            int twoMajor = 2 * s.major;
+            int64_t start = s.major + 2LL * first * s.minor;
+            int num = static_cast<int>(start % twoMajor);
+            uint32_t* p = s.base + static_cast<std::ptrdiff_t>(first) * s.majorStep + static_cast<std::ptrdiff_t>(start / twoMajor) * s.minorStep;
+
+            for (int i = first; i < s.count; ++i) {
+                plot(p);
+                p += s.majorStep;
+                num += 2 * s.minor;
+                if (num >= twoMajor) {
+                    num -= twoMajor;
+                    p += s.minorStep;
+                }
+            }
+        }
+
+        void LineScalar(const LineSetup& s, int first, uint32_t color) {
+            WalkLineScalar(s, first, [color](uint32_t* p) { *p = color; });
+        }
+
+        // Same walk in a tiled target: pixel i is at (x0, y0) + i * major + q(i) * minor, addressed with TiledOffset
+        struct TiledLineSetup {
+            uint32_t* dst;
+            int tilesPerRow;
+            int x0, y0;
+            int count;
+            int major;
+            int minor;
+            int majorX, majorY; // Unit steps along the major and minor axes
+            int minorX, minorY;
+        };
+
+        TiledLineSetup SetupTiledLine(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1) {
+            int adx = std::abs(x1 - x0);
+            int ady = std::abs(y1 - y0);
+            int sx = x0 < x1 ? 1 : -1;
+            int sy = y0 < y1 ? 1 : -1;
+
+            TiledLineSetup s{dst, tilesPerRow, x0, y0, 0, 0, 0, 0, 0, 0, 0};
+            if (adx >= ady) {
+                s.major = adx;
+                s.minor = ady;
+                s.majorX = sx;
+                s.minorY = sy;
+            } else {
+                s.major = ady;
+                s.minor = adx;
+                s.majorY = sy;
+                s.minorX = sx;
+            }
+            s.count = s.major + 1;
+            return s;
+        }
+
+        template <class Plot>
+        void WalkTiledLineScalar(const TiledLineSetup& s, int first, Plot&& plot) {
+            if (s.major == 0) {
+                if (first == 0)
+                    plot(s.dst + TiledOffset(s.x0, s.y0, s.tilesPerRow));
+                return;
+            }
+
+            int twoMajor = 2 * s.major;
+            int64_t start = s.major + 2LL * first * s.minor;
+            int num = static_cast<int>(start % twoMajor);
+            int q = static_cast<int>(start / twoMajor);
+            int x = s.x0 + first * s.majorX + q * s.minorX;
+            int y = s.y0 + first * s.majorY + q * s.minorY;
+
+            for (int i = first; i < s.count; ++i) {
+                plot(s.dst + TiledOffset(x, y, s.tilesPerRow));
+                x += s.majorX;
+                y += s.majorY;
+                num += 2 * s.minor;
+                if (num >= twoMajor) {
+                    num -= twoMajor;
+                    x += s.minorX;
+                    y += s.minorY;
+                }
+            }
+        }
+
+        void LineTiledScalar(const TiledLineSetup& s, int first, uint32_t color) {
+            WalkTiledLineScalar(s, first, [color](uint32_t* p) { *p = color; });
+        }
+
+        // Right edge of a target whose width isn't a multiple of TILE
+        void DetilePartial(uint32_t* dst, std::size_t pitch, const uint32_t* tile, int width, int rows) {
+            for (int r = 0; r < rows; ++r)
+                std::memcpy(dst + r * pitch, tile + r * TILE, width * sizeof(uint32_t));
+        }
+
+        // --- Post-processing ---
+
+        inline uint32_t LutPixel(uint32_t p, const uint32_t* lut) { return lut[p & 0xFF] | lut[256 + ((p >> 8) & 0xFF)] | lut[512 + ((p >> 16) & 0xFF)]; }
+
+        // ch * 257 maps 255 to 65535, so a factor of 65535 keeps every channel as it is
+        inline uint32_t VignettePixel(uint32_t p, const uint16_t* factors, uint16_t rowFactor) {
+            uint32_t out = 0;
+            for (int c = 0; c < 4; ++c) {
+                uint32_t f = (static_cast<uint32_t>(factors[c]) * rowFactor) >> 16;
+                uint32_t ch = (p >> (8 * c)) & 0xFF;
+                out |= (((ch * 257 * f) >> 16) >> 8) << (8 * c);
+            }
+            return out;
+        }
+
+        inline int Luma(uint32_t p) { return static_cast<int>(((p >> 16) & 0xFF) + 2 * ((p >> 8) & 0xFF) + (p & 0xFF)); }
+
+        inline uint32_t SmoothPixel(uint32_t c, uint32_t n, uint32_t s, uint32_t w, uint32_t e, int threshold) {
+            int lc = Luma(c), ln = Luma(n), ls = Luma(s), lw = Luma(w), le = Luma(e);
+            int lmax = std::max({lc, ln, ls, lw, le});
+            int lmin = std::min({lc, ln, ls, lw, le});
+            if (lmax - lmin < std::max(threshold, lmax >> 3))
+                return c;
+
+            uint32_t out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t sum = 4 * ((c >> shift) & 0xFF) + ((n >> shift) & 0xFF) + ((s >> shift) & 0xFF) + ((w >> shift) & 0xFF) + ((e >> shift) & 0xFF);
+                out |= ((sum + 4) >> 3) << shift;
+            }
+            return out;
+        }
+
+        // Pixels [x0, x1) of a smoothed row, clamping the neighbours at the edges
+        void SmoothRowScalar(uint32_t* out, const uint32_t* above, const uint32_t* row, const uint32_t* below, int x0, int x1, int width, int threshold) {
+            for (int x = x0; x < x1; ++x)
+                out[x] = SmoothPixel(row[x], above[x], below[x], row[std::max(x - 1, 0)], row[std::min(x + 1, width - 1)], threshold);
+        }
+
+        // --- Blending: every mode is out = saturate(dst * factor / 255 + add), per byte ---
+
+        struct BlendOp {
+            uint32_t factor; // Per-byte multiplier (0..255); the top byte keeps dst's padding byte
+            uint32_t add;    // Per-byte saturating addend
+        };
+
+        BlendOp MakeBlendOp(uint32_t color, color::BlendMode mode) {
+            uint32_t rgb = color & 0xFFFFFF;
+            uint32_t inverse = 255 - color::Alpha(color);
+            switch (mode) {
+                case color::BlendMode::Alpha:
+                    return {0xFF000000 | inverse * 0x010101, rgb};
+                case color::BlendMode::Additive:
+                    return {0xFFFFFFFF, rgb};
+                case color::BlendMode::Multiply: {
+                    // Premultiplied src: channel factor is src + (255 - a), at most 255 for well-formed colors
+                    uint32_t factor = 0xFF000000;
+                    for (int shift = 0; shift < 24; shift += 8)
+                        factor |= std::min<uint32_t>(((rgb >> shift) & 0xFF) + inverse, 255) << shift;
+                    return {factor, 0};
+                }
+                default:
+                    return {0xFF000000, rgb};
+            }
+        }
+
+        // Exact round(x / 255) for x <= 255 * 255
+        inline uint32_t Div255(uint32_t x) {
+            x += 128;
+            return (x + (x >> 8)) >> 8;
+        }
+
+        inline uint32_t BlendPixel(uint32_t dst, const BlendOp& op) {
+            uint32_t out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t v = Div255(((dst >> shift) & 0xFF) * ((op.factor >> shift) & 0xFF)) + ((op.add >> shift) & 0xFF);
+                out |= std::min<uint32_t>(v, 255) << shift;
+            }
+            return out;
+        }
+
+        // --- Sprite rows ---
+
+        constexpr uint32_t RGB_MASK = 0x00FFFFFF;
+
+        inline uint32_t OverPixel(uint32_t dst, uint32_t src) {
+            uint32_t inverse = 255 - (src >> 24);
+            uint32_t out = 0;
+            for (int shift = 0; shift < 24; shift += 8) {
+                uint32_t v = Div255(((dst >> shift) & 0xFF) * inverse) + ((src >> shift) & 0xFF);
+                out |= std::min<uint32_t>(v, 255) << shift;
+            }
+            return out;
+        }
+
+        // --- Clip-space lines ---
+
+        enum : int { CLIP_LEFT = 1, CLIP_RIGHT = 2, CLIP_BOTTOM = 4, CLIP_TOP = 8, CLIP_NEAR = 16, CLIP_FAR = 32, CLIP_W = 64 };
+
+        // ToScreen divides by w: lines are also clipped to w >= MIN_CLIP_W (near and far alone allow w = 0, e.g. at the origin)
+        constexpr float MIN_CLIP_W = 1e-5f;
+
+        // Planes 'v' is outside of, with x and y tested against band * w (1 = the viewport)
+        inline int ClipCode(const math::Vec4& v, float band) {
+            float bw = band * v.w;
+            return (v.x < -bw ? CLIP_LEFT : 0) | (v.x > bw ? CLIP_RIGHT : 0) | (v.y < -bw ? CLIP_BOTTOM : 0) | (v.y > bw ? CLIP_TOP : 0) | (v.z < -v.w ? CLIP_NEAR : 0) |
+                   (v.z > v.w ? CLIP_FAR : 0) | (!(v.w >= MIN_CLIP_W) ? CLIP_W : 0);
+        }
+
+        inline void ToScreen(const math::Vec4& v, const ClipViewport& vp, int& x, int& y) {
+            float invW = 1.0f / v.w;
+            x = static_cast<int>((v.x * invW + 1.0f) * vp.halfWidth);
+            y = static_cast<int>((1.0f - v.y * invW) * vp.halfHeight);
+        }
+
+        // One edge, start to finish. The SIMD kernels only come here for lanes that need exact clipping.
+        bool ClipLine(math::Vec4 a, math::Vec4 b, const ClipViewport& vp, ScreenLine& out) {
+            if (ClipCode(a, 1.0f) & ClipCode(b, 1.0f))
+                return false;
+
+            float g = vp.guardBand;
+            if (ClipCode(a, g) | ClipCode(b, g)) {
+                // Liang-Barsky in homogeneous space against the guard planes, near, far and min w (d >= 0 is inside)
+                const float da[7] = {a.x + g * a.w, g * a.w - a.x, a.y + g * a.w, g * a.w - a.y, a.z + a.w, a.w - a.z, a.w - MIN_CLIP_W};
+                const float db[7] = {b.x + g * b.w, g * b.w - b.x, b.y + g * b.w, g * b.w - b.y, b.z + b.w, b.w - b.z, b.w - MIN_CLIP_W};
+
+                float t0 = 0.0f;
+                float t1 = 1.0f;
+                for (int p = 0; p < 7; ++p) {
+                    if (da[p] < 0.0f && db[p] < 0.0f)
+                        return false;
+                    if (da[p] < 0.0f)
+                        t0 = std::max(t0, da[p] / (da[p] - db[p]));
+                    else if (db[p] < 0.0f)
+                        t1 = std::min(t1, da[p] / (da[p] - db[p]));
+                }
+                if (t0 > t1)
+                    return false;
+
+                math::Vec4 d = b - a;
+                if (t1 < 1.0f)
+                    b = a + d * t1;
+                if (t0 > 0.0f)
+                    a = a + d * t0;
+            }
+
+            ToScreen(a, vp, out.x0, out.y0);
+            ToScreen(b, vp, out.x1, out.y1);
+            return true;
+        }
+
+        inline bool ValidEdge(const std::array<int, 2>& e, std::size_t vertexCount) { return static_cast<std::size_t>(e[0]) < vertexCount && static_cast<std::size_t>(e[1]) < vertexCount; }
+
+        std::size_t ClipLinesScalar(const math::Vec4* verts, std::size_t vertexCount, const std::array<int, 2>* edges, std::size_t edgeCount, const ClipViewport& vp, ScreenLine* out) {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < edgeCount; ++i) {
+                if (ValidEdge(edges[i], vertexCount))
+                    n += ClipLine(verts[edges[i][0]], verts[edges[i][1]], vp, out[n]);
+            }
+            return n;
+        }
+
+        // Writes the lanes of one SIMD batch in edge order: projected as-is, clipped exactly, or dropped
+        inline std::size_t EmitLanes(int lanes, int rejectMask, int clipMask, const int* sx0, const int* sy0, const int* sx1, const int* sy1, const math::Vec4* verts,
+                                     const std::array<int, 2>* edges, const ClipViewport& vp, ScreenLine* out) {
+            std::size_t n = 0;
+            for (int l = 0; l < lanes; ++l) {
+                if (rejectMask & (1 << l))
+                    continue;
+                if (clipMask & (1 << l))
+                    n += ClipLine(verts[edges[l][0]], verts[edges[l][1]], vp, out[n]);
+                else
+                    out[n++] = {sx0[l], sy0[l], sx1[l], sy1[l]};
+            }
+            return n;
+        }
+
+        // --- Particles ---
+
+        std::size_t IntegrateParticlesScalar(const ParticleStreams& s, std::size_t begin, std::size_t end, const ParticleStep& step) {
+            std::size_t dead = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                s.vx[i] = (s.vx[i] + step.ax) * step.drag;
+                s.vy[i] = (s.vy[i] + step.ay) * step.drag;
+                s.vz[i] = (s.vz[i] + step.az) * step.drag;
+                s.px[i] = s.px[i] + s.vx[i] * step.dt;
+                s.py[i] = s.py[i] + s.vy[i] * step.dt;
+                s.pz[i] = s.pz[i] + s.vz[i] * step.dt;
+                s.life[i] = s.life[i] - step.dt;
+                dead += s.life[i] <= 0.0f;
+            }
+            return dead;
+        }
+
+        // Near/far in clip space, x/y against the target in pixels (so no float -> int overflow)
+        inline uint32_t ProjectParticle(const math::Mat4& m, float x, float y, float z, const ClipViewport& vp, int width, int height) {
+            float cx = m.c0.x * x + m.c1.x * y + m.c2.x * z + m.c3.x;
+            float cy = m.c0.y * x + m.c1.y * y + m.c2.y * z + m.c3.y;
+            float cz = m.c0.z * x + m.c1.z * y + m.c2.z * z + m.c3.z;
+            float cw = m.c0.w * x + m.c1.w * y + m.c2.w * z + m.c3.w;
+            if (!(cz >= -cw && cz <= cw))
+                return PARTICLE_CULLED;
+
+            float invW = 1.0f / cw;
+            float fx = (cx * invW + 1.0f) * vp.halfWidth;
+            float fy = (1.0f - cy * invW) * vp.halfHeight;
+            if (!(fx >= 0.0f && fx < static_cast<float>(width) && fy >= 0.0f && fy < static_cast<float>(height)))
+                return PARTICLE_CULLED;
+            return static_cast<uint32_t>(static_cast<int>(fy) * width + static_cast<int>(fx));
+        }
+
+        void ProjectParticlesScalar(const math::Mat4& m, const float* x, const float* y, const float* z, std::size_t count, const ClipViewport& vp, int width, int height, uint32_t* offsets) {
+            for (std::size_t i = 0; i < count; ++i)
+                offsets[i] = ProjectParticle(m, x[i], y[i], z[i], vp, width, height);
+        }
+
+        // Texture sampling reference (tails). The SIMD paths reproduce it bit for bit.
+        constexpr int TEXEL_WEIGHT_BITS = 7; // Bilinear weights in 0..128, so (b - a) * w fits a signed 16-bit lane
+        constexpr float TEXEL_WEIGHT_ONE = 1 << TEXEL_WEIGHT_BITS;
+
+        // cvttps2dq: NaN and anything outside the int range give INT_MIN (a plain cast would be undefined)
+        inline int TruncateToInt(float f) { return f >= -2147483648.0f && f < 2147483648.0f ? static_cast<int>(f) : INT_MIN; }
+
+        // Wraps like the vector floor, so huge coordinates still land on some texel
+        inline int FloorToInt(float f) {
+            int i = TruncateToInt(f);
+            return f < static_cast<float>(i) ? static_cast<int>(static_cast<unsigned>(i) - 1u) : i;
+        }
+
+        inline uint32_t LerpTexel(uint32_t a, uint32_t b, int w) {
+            uint32_t out = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                int ca = (a >> shift) & 0xFF;
+                int cb = (b >> shift) & 0xFF;
+                out |= static_cast<uint32_t>(ca + (((cb - ca) * w) >> TEXEL_WEIGHT_BITS)) << shift;
+            }
+            return out;
+        }
+
+        inline uint32_t SampleNearestScalar(const TextureLevel& l, float u, float v) { return l.texels[TextureOffset(l, FloorToInt(u * l.width), FloorToInt(v * l.height))]; }
+
+        inline uint32_t SampleBilinearScalar(const TextureLevel& l, float u, float v) {
+            float fx = u * l.width - 0.5f;
+            float fy = v * l.height - 0.5f;
+            int x = FloorToInt(fx);
+            int y = FloorToInt(fy);
+            int x1 = static_cast<int>(static_cast<unsigned>(x) + 1u);
+            int y1 = static_cast<int>(static_cast<unsigned>(y) + 1u);
+
+            // In 0..128 for any coordinate the floor could represent; only garbage beyond the int range is clamped
+            int wx = std::clamp(TruncateToInt((fx - static_cast<float>(x)) * TEXEL_WEIGHT_ONE), 0, 1 << TEXEL_WEIGHT_BITS);
+            int wy = std::clamp(TruncateToInt((fy - static_cast<float>(y)) * TEXEL_WEIGHT_ONE), 0, 1 << TEXEL_WEIGHT_BITS);
+
+            uint32_t top = LerpTexel(l.texels[TextureOffset(l, x, y)], l.texels[TextureOffset(l, x1, y)], wx);
+            uint32_t bottom = LerpTexel(l.texels[TextureOffset(l, x, y1)], l.texels[TextureOffset(l, x1, y1)], wx);
+            return LerpTexel(top, bottom, wy);
+        }
+
+        template <TextureFilter F>
+        inline uint32_t SampleTexelScalar(const TextureLevel& l, float u, float v) {
+            return F == TextureFilter::Nearest ? SampleNearestScalar(l, u, v) : SampleBilinearScalar(l, u, v);
+        }
+
+        // ==========================
+        // SSE2 (x86-64 baseline)
+        // ==========================
+        namespace sse2 {
+
+            void TransformPoints(const math::Mat4& m, const math::Vec3* in, math::Vec4* out, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    __m128 res = _mm_add_ps(m.c3.mm, _mm_mul_ps(m.c0.mm, _mm_set1_ps(in[i].x)));
+                    res = _mm_add_ps(res, _mm_mul_ps(m.c1.mm, _mm_set1_ps(in[i].y)));
+                    res = _mm_add_ps(res, _mm_mul_ps(m.c2.mm, _mm_set1_ps(in[i].z)));
+                    _mm_store_ps(&out[i].x, res);
+                }
+            }
+
+            void Fill(uint32_t* dst, std::size_t count, uint32_t color) {
+                std::size_t i = 0;
+                while (i < count && (reinterpret_cast<uintptr_t>(dst + i) & 15))
+                    dst[i++] = color;
+
+                __m128i v = _mm_set1_epi32(static_cast<int>(color));
+                if (count >= STREAM_THRESHOLD) {
+                    for (; i + 4 <= count; i += 4)
+                        _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i), v);
+                    _mm_sfence();
+                } else {
+                    for (; i + 4 <= count; i += 4)
+                        _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), v);
+                }
+
+                for (; i < count; ++i)
+                    dst[i] = color;
+            }
+
+            void Line(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color) { LineScalar(SetupLine(dst, pitch, x0, y0, x1, y1), 0, color); }
+
+            void LineTiled(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color) {
+                LineTiledScalar(SetupTiledLine(dst, tilesPerRow, x0, y0, x1, y1), 0, color);
+            }
+
+            // Outside masks of 4 endpoints (SoA) against the planes of ClipCode
+            struct ClipMasks4 {
+                __m128 viewport[6];
+                __m128 guard; // Any guard plane, near or far
+            };
+
+            inline ClipMasks4 Classify4(__m128 x, __m128 y, __m128 z, __m128 w, __m128 guard) {
+                const __m128 zero = _mm_setzero_ps();
+                __m128 gw = _mm_mul_ps(guard, w);
+                __m128 ngw = _mm_sub_ps(zero, gw);
+                __m128 nw = _mm_sub_ps(zero, w);
+
+                ClipMasks4 m;
+                m.viewport[0] = _mm_cmplt_ps(x, nw);
+                m.viewport[1] = _mm_cmpgt_ps(x, w);
+                m.viewport[2] = _mm_cmplt_ps(y, nw);
+                m.viewport[3] = _mm_cmpgt_ps(y, w);
+                m.viewport[4] = _mm_cmplt_ps(z, nw);
+                m.viewport[5] = _mm_cmpgt_ps(z, w);
+                m.guard = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, ngw), _mm_cmpgt_ps(x, gw)), _mm_or_ps(_mm_cmplt_ps(y, ngw), _mm_cmpgt_ps(y, gw)));
+                m.guard = _mm_or_ps(m.guard, _mm_or_ps(m.viewport[4], m.viewport[5]));
+                m.guard = _mm_or_ps(m.guard, _mm_cmpnge_ps(w, _mm_set1_ps(MIN_CLIP_W))); // ClipLine handles w near 0
+                return m;
+            }
+
+            inline void Project4(__m128 x, __m128 y, __m128 w, __m128 halfW, __m128 halfH, int* sx, int* sy) {
+                const __m128 one = _mm_set1_ps(1.0f);
+                __m128 invW = _mm_div_ps(one, w);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(sx), _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(x, invW), one), halfW)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(sy), _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(y, invW)), halfH)));
+            }
+
+            std::size_t ClipLines(const math::Vec4* verts, std::size_t vertexCount, const std::array<int, 2>* edges, std::size_t edgeCount, const ClipViewport& vp, ScreenLine* out) {
+                const __m128 guard = _mm_set1_ps(vp.guardBand);
+                const __m128 halfW = _mm_set1_ps(vp.halfWidth);
+                const __m128 halfH = _mm_set1_ps(vp.halfHeight);
+
+                std::size_t n = 0;
+                std::size_t i = 0;
+                for (; i + 4 <= edgeCount; i += 4) {
+                    const std::array<int, 2>* e = edges + i;
+                    if (!(ValidEdge(e[0], vertexCount) && ValidEdge(e[1], vertexCount) && ValidEdge(e[2], vertexCount) && ValidEdge(e[3], vertexCount))) {
+                        n += ClipLinesScalar(verts, vertexCount, e, 4, vp, out + n);
+                        continue;
+                    }
+
+                    // Endpoints to SoA: rows become x, y, z, w
+                    __m128 ax = verts[e[0][0]].mm, ay = verts[e[1][0]].mm, az = verts[e[2][0]].mm, aw = verts[e[3][0]].mm;
+                    __m128 bx = verts[e[0][1]].mm, by = verts[e[1][1]].mm, bz = verts[e[2][1]].mm, bw = verts[e[3][1]].mm;
+                    _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+                    _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+                    ClipMasks4 ma = Classify4(ax, ay, az, aw, guard);
+                    ClipMasks4 mb = Classify4(bx, by, bz, bw, guard);
+
+                    // Both ends outside the same viewport plane: nothing of the line is visible
+                    __m128 reject = _mm_setzero_ps();
+                    for (int p = 0; p < 6; ++p)
+                        reject = _mm_or_ps(reject, _mm_and_ps(ma.viewport[p], mb.viewport[p]));
+                    __m128 clip = _mm_andnot_ps(reject, _mm_or_ps(ma.guard, mb.guard));
+
+                    alignas(16) int sx0[4], sy0[4], sx1[4], sy1[4];
+                    Project4(ax, ay, aw, halfW, halfH, sx0, sy0);
+                    Project4(bx, by, bw, halfW, halfH, sx1, sy1);
+
+                    n += EmitLanes(4, _mm_movemask_ps(reject), _mm_movemask_ps(clip), sx0, sy0, sx1, sy1, verts, e, vp, out + n);
+                }
+
+                return n + ClipLinesScalar(verts, vertexCount, edges + i, edgeCount - i, vp, out + n);
+            }
+
+            std::size_t IntegrateParticles(const ParticleStreams& s, std::size_t begin, std::size_t end, const ParticleStep& step) {
+                const __m128 dt = _mm_set1_ps(step.dt);
+                const __m128 drag = _mm_set1_ps(step.drag);
+                const __m128 ax = _mm_set1_ps(step.ax), ay = _mm_set1_ps(step.ay), az = _mm_set1_ps(step.az);
+                const __m128 zero = _mm_setzero_ps();
+
+                std::size_t dead = 0;
+                std::size_t i = begin;
+                for (; i + 4 <= end; i += 4) {
+                    __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.vx + i), ax), drag);
+                    __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.vy + i), ay), drag);
+                    __m128 vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.vz + i), az), drag);
+                    _mm_storeu_ps(s.vx + i, vx);
+                    _mm_storeu_ps(s.vy + i, vy);
+                    _mm_storeu_ps(s.vz + i, vz);
+                    _mm_storeu_ps(s.px + i, _mm_add_ps(_mm_loadu_ps(s.px + i), _mm_mul_ps(vx, dt)));
+                    _mm_storeu_ps(s.py + i, _mm_add_ps(_mm_loadu_ps(s.py + i), _mm_mul_ps(vy, dt)));
+                    _mm_storeu_ps(s.pz + i, _mm_add_ps(_mm_loadu_ps(s.pz + i), _mm_mul_ps(vz, dt)));
+
+                    __m128 life = _mm_sub_ps(_mm_loadu_ps(s.life + i), dt);
+                    _mm_storeu_ps(s.life + i, life);
+                    dead += __builtin_popcount(_mm_movemask_ps(_mm_cmple_ps(life, zero)));
+                }
+                return dead + IntegrateParticlesScalar(s, i, end, step);
+            }
+
+            void ProjectParticles(const math::Mat4& m, const float* x, const float* y, const float* z, std::size_t count, const ClipViewport& vp, int width, int height, uint32_t* offsets) {
+                const __m128 one = _mm_set1_ps(1.0f);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 halfW = _mm_set1_ps(vp.halfWidth);
+                const __m128 halfH = _mm_set1_ps(vp.halfHeight);
+                const __m128 widthF = _mm_set1_ps(static_cast<float>(width));
+                const __m128 heightF = _mm_set1_ps(static_cast<float>(height));
+
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+                    auto row = [&](float r0, float r1, float r2, float r3) {
+                        return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r0), px), _mm_mul_ps(_mm_set1_ps(r1), py)), _mm_mul_ps(_mm_set1_ps(r2), pz)), _mm_set1_ps(r3));
+                    };
+                    __m128 cx = row(m.c0.x, m.c1.x, m.c2.x, m.c3.x);
+                    __m128 cy = row(m.c0.y, m.c1.y, m.c2.y, m.c3.y);
+                    __m128 cz = row(m.c0.z, m.c1.z, m.c2.z, m.c3.z);
+                    __m128 cw = row(m.c0.w, m.c1.w, m.c2.w, m.c3.w);
+
+                    __m128 invW = _mm_div_ps(one, cw);
+                    __m128 fx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cx, invW), one), halfW);
+                    __m128 fy = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(cy, invW)), halfH);
+                    __m128 in = _mm_and_ps(_mm_cmpge_ps(cz, _mm_sub_ps(zero, cw)), _mm_cmple_ps(cz, cw));
+                    in = _mm_and_ps(in, _mm_and_ps(_mm_cmpge_ps(fx, zero), _mm_cmplt_ps(fx, widthF)));
+                    in = _mm_and_ps(in, _mm_and_ps(_mm_cmpge_ps(fy, zero), _mm_cmplt_ps(fy, heightF)));
+
+                    // No 32-bit multiply before SSE4.1: finish the offsets per lane
+                    alignas(16) int ix[4], iy[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(ix), _mm_cvttps_epi32(fx));
+                    _mm_store_si128(reinterpret_cast<__m128i*>(iy), _mm_cvttps_epi32(fy));
+                    int mask = _mm_movemask_ps(in);
+                    for (int l = 0; l < 4; ++l)
+                        offsets[i + l] = (mask & (1 << l)) ? static_cast<uint32_t>(iy[l] * width + ix[l]) : PARTICLE_CULLED;
+                }
+                ProjectParticlesScalar(m, x + i, y + i, z + i, count - i, vp, width, height, offsets + i);
+            }
+
+            // 4 pixels: widen to 16-bit lanes, multiply, divide by 255, narrow and add
+            inline __m128i Blend4(__m128i d, __m128i factor, __m128i add) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i half = _mm_set1_epi16(128);
+                __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), factor), half);
+                __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), factor), half);
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+                return _mm_adds_epu8(_mm_packus_epi16(lo, hi), add);
+            }
+
+            void BlendFill(uint32_t* dst, std::size_t count, uint32_t color, color::BlendMode mode) {
+                BlendOp op = MakeBlendOp(color, mode);
+                const __m128i factor = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(op.factor)), _mm_setzero_si128());
+                const __m128i add = _mm_set1_epi32(static_cast<int>(op.add));
+
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+                    _mm_storeu_si128(p, Blend4(_mm_loadu_si128(p), factor, add));
+                }
+                for (; i < count; ++i)
+                    dst[i] = BlendPixel(dst[i], op);
+            }
+
+            // Blends the pixels a line walk visits. They are never adjacent in memory: batch 4 addresses, blend them as one vector.
+            template <class Walk>
+            void BlendWalk(const BlendOp& op, Walk&& walk) {
+                const __m128i factor = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(op.factor)), _mm_setzero_si128());
+                const __m128i add = _mm_set1_epi32(static_cast<int>(op.add));
+
+                uint32_t* batch[4];
+                int n = 0;
+                walk([&](uint32_t* p) {
+                    batch[n++] = p;
+                    if (n < 4)
+                        return;
+                    __m128i d = _mm_setr_epi32(static_cast<int>(*batch[0]), static_cast<int>(*batch[1]), static_cast<int>(*batch[2]), static_cast<int>(*batch[3]));
+                    alignas(16) uint32_t out[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(out), Blend4(d, factor, add));
+                    for (int k = 0; k < 4; ++k)
+                        *batch[k] = out[k];
+                    n = 0;
+                });
+                for (int k = 0; k < n; ++k)
+                    *batch[k] = BlendPixel(*batch[k], op);
+            }
+
+            void BlendLine(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
+                LineSetup s = SetupLine(dst, pitch, x0, y0, x1, y1);
+                BlendWalk(MakeBlendOp(color, mode), [&](auto&& plot) { WalkLineScalar(s, 0, plot); });
+            }
+
+            void BlendLineTiled(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
+                TiledLineSetup s = SetupTiledLine(dst, tilesPerRow, x0, y0, x1, y1);
+                BlendWalk(MakeBlendOp(color, mode), [&](auto&& plot) { WalkTiledLineScalar(s, 0, plot); });
+            }
+
+            void CopyRow(uint32_t* dst, const uint32_t* src, std::size_t count) {
+                const __m128i rgb = _mm_set1_epi32(RGB_MASK);
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), rgb));
+                for (; i < count; ++i)
+                    dst[i] = src[i] & RGB_MASK;
+            }
+
+            void KeyRow(uint32_t* dst, const uint32_t* src, std::size_t count, uint32_t key) {
+                const __m128i rgb = _mm_set1_epi32(RGB_MASK);
+                const __m128i vKey = _mm_set1_epi32(static_cast<int>(key & RGB_MASK));
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128i s = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), rgb);
+                    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+                    __m128i keep = _mm_cmpeq_epi32(s, vKey);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, s)));
+                }
+                for (; i < count; ++i) {
+                    uint32_t s = src[i] & RGB_MASK;
+                    if (s != (key & RGB_MASK))
+                        dst[i] = s;
+                }
+            }
+
+            // dst * (255 - a) / 255 + src with each pixel's own alpha broadcast across its 16-bit lanes
+            inline __m128i Over4(__m128i d, __m128i s) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i full = _mm_set1_epi16(255);
+                const __m128i half = _mm_set1_epi16(128);
+                __m128i sLo = _mm_unpacklo_epi8(s, zero);
+                __m128i sHi = _mm_unpackhi_epi8(s, zero);
+                __m128i invLo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, 0xFF), 0xFF));
+                __m128i invHi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, 0xFF), 0xFF));
+                __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), invLo), half);
+                __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), invHi), half);
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+                return _mm_and_si128(_mm_adds_epu8(_mm_packus_epi16(lo, hi), s), _mm_set1_epi32(RGB_MASK));
+            }
+
+            void AlphaRow(uint32_t* dst, const uint32_t* src, std::size_t count) {
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+                    _mm_storeu_si128(d, Over4(_mm_loadu_si128(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+                }
+                for (; i < count; ++i)
+                    dst[i] = OverPixel(dst[i], src[i]);
+            }
+
+            void DetileRow(uint32_t* dst, std::size_t pitch, const uint32_t* tiles, int width, int rows) {
+                int full = width >> TILE_SHIFT;
+                for (int t = 0; t < full; ++t, tiles += TILE_PIXELS) {
+                    for (int r = 0; r < rows; ++r) {
+                        const __m128i* src = reinterpret_cast<const __m128i*>(tiles + r * TILE);
+                        __m128i* out = reinterpret_cast<__m128i*>(dst + r * pitch + t * TILE);
+                        _mm_storeu_si128(out, _mm_load_si128(src));
+                        _mm_storeu_si128(out + 1, _mm_load_si128(src + 1));
+                    }
+                }
+                DetilePartial(dst + full * TILE, pitch, tiles, width & (TILE - 1), rows);
+            }
+
+            // No gathers before AVX2
+            void LutRow(uint32_t* px, std::size_t count, const uint32_t* lut) {
+                for (std::size_t i = 0; i < count; ++i)
+                    px[i] = LutPixel(px[i], lut);
+            }
+
+            inline __m128i Vignette2(__m128i ch, __m128i columns, __m128i rowFactor) {
+                __m128i f = _mm_mulhi_epu16(columns, rowFactor);
+                return _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(ch, _mm_set1_epi16(257)), f), 8);
+            }
+
+            void VignetteRow(uint32_t* px, std::size_t count, const uint16_t* columns, uint16_t rowFactor) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i row = _mm_set1_epi16(static_cast<short>(rowFactor));
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128i* p = reinterpret_cast<__m128i*>(px + i);
+                    __m128i d = _mm_loadu_si128(p);
+                    const __m128i* f = reinterpret_cast<const __m128i*>(columns + 4 * i);
+                    __m128i lo = Vignette2(_mm_unpacklo_epi8(d, zero), _mm_loadu_si128(f), row);
+                    __m128i hi = Vignette2(_mm_unpackhi_epi8(d, zero), _mm_loadu_si128(f + 1), row);
+                    _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+                }
+                for (; i < count; ++i)
+                    px[i] = VignettePixel(px[i], columns + 4 * i, rowFactor);
+            }
+
+            inline __m128i Luma4(__m128i p) {
+                const __m128i mask = _mm_set1_epi32(0xFF);
+                __m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+                return _mm_add_epi32(_mm_add_epi32(_mm_and_si128(p, mask), _mm_and_si128(_mm_srli_epi32(p, 16), mask)), _mm_add_epi32(g, g));
+            }
+
+            // SSE2 has no 32-bit min/max
+            inline __m128i Max4(__m128i a, __m128i b) {
+                __m128i gt = _mm_cmpgt_epi32(a, b);
+                return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+            }
+
+            inline __m128i Min4(__m128i a, __m128i b) {
+                __m128i gt = _mm_cmpgt_epi32(a, b);
+                return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+            }
+
+            inline __m128i SmoothSum2(__m128i c, __m128i n, __m128i s, __m128i w, __m128i e) {
+                __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(c, 2), _mm_set1_epi16(4)), _mm_add_epi16(_mm_add_epi16(n, s), _mm_add_epi16(w, e)));
+                return _mm_srli_epi16(sum, 3);
+            }
+
+            void SmoothRow(uint32_t* out, const uint32_t* above, const uint32_t* row, const uint32_t* below, int width, int threshold) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i vThreshold = _mm_set1_epi32(threshold);
+
+                // Edge columns clamp their neighbours: scalar
+                SmoothRowScalar(out, above, row, below, 0, std::min(width, 1), width, threshold);
+                int x = 1;
+                for (; x + 4 < width; x += 4) {
+                    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+                    __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + x));
+                    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + x));
+                    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1));
+                    __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1));
+
+                    __m128i lc = Luma4(c), ln = Luma4(n), ls = Luma4(s), lw = Luma4(w), le = Luma4(e);
+                    __m128i lmax = Max4(Max4(Max4(lc, ln), Max4(ls, lw)), le);
+                    __m128i lmin = Min4(Min4(Min4(lc, ln), Min4(ls, lw)), le);
+                    __m128i keep = _mm_cmpgt_epi32(Max4(vThreshold, _mm_srli_epi32(lmax, 3)), _mm_sub_epi32(lmax, lmin));
+
+                    __m128i lo = SmoothSum2(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(n, zero), _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(w, zero), _mm_unpacklo_epi8(e, zero));
+                    __m128i hi = SmoothSum2(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(n, zero), _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(w, zero), _mm_unpackhi_epi8(e, zero));
+                    __m128i smooth = _mm_packus_epi16(lo, hi);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_or_si128(_mm_and_si128(keep, c), _mm_andnot_si128(keep, smooth)));
+                }
+                SmoothRowScalar(out, above, row, below, std::max(x, std::min(width, 1)), width, width, threshold);
+            }
+
+            void SinCos(const float* angles, float* s, float* c, std::size_t count) {
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128 vs, vc;
+                    math::sincos(_mm_loadu_ps(angles + i), vs, vc);
+                    _mm_storeu_ps(s + i, vs);
+                    _mm_storeu_ps(c + i, vc);
+                }
+                for (; i < count; ++i)
+                    math::sincos(angles[i], s[i], c[i]);
+            }
+
+            // Texture sampling, 4 texels per step
+            inline __m128i FloorTexels(__m128 f) {
+                __m128i i = _mm_cvttps_epi32(f);
+                return _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(f, _mm_cvtepi32_ps(i)))); // -1 where truncation rounded up
+            }
+
+            inline __m128i TexelOffsets(const TextureLevel& l, __m128i x, __m128i y) {
+                x = _mm_and_si128(x, _mm_set1_epi32(l.widthMask));
+                y = _mm_and_si128(y, _mm_set1_epi32(l.heightMask));
+                const __m128i three = _mm_set1_epi32(3);
+                __m128i tile = _mm_or_si128(_mm_sll_epi32(_mm_srli_epi32(y, 2), _mm_cvtsi32_si128(l.tileShift)), _mm_slli_epi32(_mm_srli_epi32(x, 2), 4));
+                return _mm_or_si128(tile, _mm_or_si128(_mm_slli_epi32(_mm_and_si128(y, three), 2), _mm_and_si128(x, three)));
+            }
+
+            inline __m128i FetchTexels(const TextureLevel& l, __m128i offsets) {
+                alignas(16) uint32_t o[4];
+                _mm_store_si128(reinterpret_cast<__m128i*>(o), offsets);
+                return _mm_setr_epi32(static_cast<int>(l.texels[o[0]]), static_cast<int>(l.texels[o[1]]), static_cast<int>(l.texels[o[2]]), static_cast<int>(l.texels[o[3]]));
+            }
+
+            // a + ((b - a) * w >> 7) per channel, with each texel's weight broadcast over its four 16-bit lanes
+            inline __m128i LerpTexels(__m128i a, __m128i b, __m128i w) {
+                __m128i w16 = _mm_packs_epi32(w, w);
+                w16 = _mm_unpacklo_epi16(w16, w16);
+                __m128i wLo = _mm_unpacklo_epi32(w16, w16);
+                __m128i wHi = _mm_unpackhi_epi32(w16, w16);
+
+                const __m128i zero = _mm_setzero_si128();
+                __m128i aLo = _mm_unpacklo_epi8(a, zero);
+                __m128i aHi = _mm_unpackhi_epi8(a, zero);
+                __m128i lo = _mm_add_epi16(aLo, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(b, zero), aLo), wLo), TEXEL_WEIGHT_BITS));
+                __m128i hi = _mm_add_epi16(aHi, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(b, zero), aHi), wHi), TEXEL_WEIGHT_BITS));
+                return _mm_packus_epi16(lo, hi);
+            }
+
+            template <TextureFilter F>
+            inline __m128i SampleTexels4(const TextureLevel& l, __m128 u, __m128 v) {
+                const __m128 width = _mm_set1_ps(l.width);
+                const __m128 height = _mm_set1_ps(l.height);
+                if constexpr (F == TextureFilter::Nearest) {
+                    return FetchTexels(l, TexelOffsets(l, FloorTexels(_mm_mul_ps(u, width)), FloorTexels(_mm_mul_ps(v, height))));
+                } else {
+                    const __m128 half = _mm_set1_ps(0.5f);
+                    const __m128 one = _mm_set1_ps(TEXEL_WEIGHT_ONE);
+                    const __m128i step = _mm_set1_epi32(1);
+                    __m128 fx = _mm_sub_ps(_mm_mul_ps(u, width), half);
+                    __m128 fy = _mm_sub_ps(_mm_mul_ps(v, height), half);
+                    __m128i x = FloorTexels(fx);
+                    __m128i y = FloorTexels(fy);
+                    __m128i wx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(fx, _mm_cvtepi32_ps(x)), one));
+                    __m128i wy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(fy, _mm_cvtepi32_ps(y)), one));
+                    __m128i x1 = _mm_add_epi32(x, step);
+                    __m128i y1 = _mm_add_epi32(y, step);
+
+                    __m128i top = LerpTexels(FetchTexels(l, TexelOffsets(l, x, y)), FetchTexels(l, TexelOffsets(l, x1, y)), wx);
+                    __m128i bottom = LerpTexels(FetchTexels(l, TexelOffsets(l, x, y1)), FetchTexels(l, TexelOffsets(l, x1, y1)), wx);
+                    return LerpTexels(top, bottom, wy);
+                }
+            }
+
+            template <TextureFilter F>
+            void SampleTexels(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) {
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), SampleTexels4<F>(l, _mm_loadu_ps(u + i), _mm_loadu_ps(v + i)));
+                for (; i < count; ++i)
+                    out[i] = SampleTexelScalar<F>(l, u[i], v[i]);
+            }
+
+            template <TextureFilter F>
+            void SampleTexelSpan(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) {
+                int i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                    __m128 q = _mm_add_ps(_mm_set1_ps(s.oneOverW), _mm_mul_ps(index, _mm_set1_ps(s.oneOverWStep)));
+                    __m128 u = _mm_div_ps(_mm_add_ps(_mm_set1_ps(s.uOverW), _mm_mul_ps(index, _mm_set1_ps(s.uOverWStep))), q);
+                    __m128 v = _mm_div_ps(_mm_add_ps(_mm_set1_ps(s.vOverW), _mm_mul_ps(index, _mm_set1_ps(s.vOverWStep))), q);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), SampleTexels4<F>(l, u, v));
+                }
+                for (; i < count; ++i) {
+                    float index = static_cast<float>(i);
+                    float q = s.oneOverW + index * s.oneOverWStep;
+                    out[i] = SampleTexelScalar<F>(l, (s.uOverW + index * s.uOverWStep) / q, (s.vOverW + index * s.vOverWStep) / q);
+                }
+            }
+
+            void SampleNearest(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) { SampleTexels<TextureFilter::Nearest>(l, u, v, count, out); }
+            void SampleBilinear(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) { SampleTexels<TextureFilter::Bilinear>(l, u, v, count, out); }
+            void SampleSpanNearest(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) { SampleTexelSpan<TextureFilter::Nearest>(l, s, count, out); }
+            void SampleSpanBilinear(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) { SampleTexelSpan<TextureFilter::Bilinear>(l, s, count, out); }
+
+        } // namespace sse2
+
+        // ==========================
+        // AVX2 + FMA
+        // ==========================
+        namespace avx2 {
+
+            X11ENGINE_TARGET_AVX2 void TransformPoints(const math::Mat4& m, const math::Vec3* in, math::Vec4* out, std::size_t count) {
+                // Two vertices per register: one in each 128-bit half
+                __m256 c0 = _mm256_broadcast_ps(&m.c0.mm);
+                __m256 c1 = _mm256_broadcast_ps(&m.c1.mm);
+                __m256 c2 = _mm256_broadcast_ps(&m.c2.mm);
+                __m256 c3 = _mm256_broadcast_ps(&m.c3.mm);
+
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    __m256 x = _mm256_set_m128(_mm_set1_ps(in[i + 1].x), _mm_set1_ps(in[i].x));
+                    __m256 y = _mm256_set_m128(_mm_set1_ps(in[i + 1].y), _mm_set1_ps(in[i].y));
+                    __m256 z = _mm256_set_m128(_mm_set1_ps(in[i + 1].z), _mm_set1_ps(in[i].z));
+
+                    __m256 res = _mm256_fmadd_ps(c0, x, c3);
+                    res = _mm256_fmadd_ps(c1, y, res);
+                    res = _mm256_fmadd_ps(c2, z, res);
+                    _mm256_storeu_ps(&out[i].x, res);
+                }
+
+                if (i < count)
+                    sse2::TransformPoints(m, in + i, out + i, count - i);
+            }
+
+            X11ENGINE_TARGET_AVX2 void Fill(uint32_t* dst, std::size_t count, uint32_t color) {
+                std::size_t i = 0;
+                while (i < count && (reinterpret_cast<uintptr_t>(dst + i) & 31))
+                    dst[i++] = color;
+
+                __m256i v = _mm256_set1_epi32(static_cast<int>(color));
+                if (count >= STREAM_THRESHOLD) {
+                    for (; i + 8 <= count; i += 8)
+                        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i), v);
+                    _mm_sfence();
+                } else {
+                    for (; i + 8 <= count; i += 8)
+                        _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), v);
+                }
+
+                for (; i < count; ++i)
+                    dst[i] = color;
+            }
+
+            // Calls step(i, q(i)) for each full group of 8 pixels, returns the index the scalar tail starts at.
+            // 8 pixels per step: the minor coordinate advances by Q, plus one when the remainder wraps.
+            template <class Step>
+            X11ENGINE_TARGET_AVX2 inline int StepLine8(int count, int major, int minor, Step&& step) {
+                int twoMajor = 2 * major;
+                int Q = (16 * minor) / twoMajor;
+                int R = (16 * minor) % twoMajor;
+
+                alignas(32) int num0[8], q0[8];
+                for (int k = 0; k < 8; ++k) {
+                    int start = major + 2 * k * minor;
+                    num0[k] = start % twoMajor;
+                    q0[k] = start / twoMajor;
+                }
+
+                __m256i num = _mm256_load_si256(reinterpret_cast<const __m256i*>(num0));
+                __m256i q = _mm256_load_si256(reinterpret_cast<const __m256i*>(q0));
+                __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                const __m256i eight = _mm256_set1_epi32(8);
+                const __m256i vQ = _mm256_set1_epi32(Q);
+                const __m256i vR = _mm256_set1_epi32(R);
+                const __m256i vTwoMajorMinus1 = _mm256_set1_epi32(twoMajor - 1);
+                const __m256i vTwoMajor = _mm256_set1_epi32(twoMajor);
+
+                int i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    step(idx, q);
+
+                    idx = _mm256_add_epi32(idx, eight);
+                    num = _mm256_add_epi32(num, vR);
+                    __m256i wrap = _mm256_cmpgt_epi32(num, vTwoMajorMinus1);
+                    num = _mm256_sub_epi32(num, _mm256_and_si256(wrap, vTwoMajor));
+                    q = _mm256_sub_epi32(_mm256_add_epi32(q, vQ), wrap); // wrap is -1 when set
+                }
+                return i;
+            }
+
+            // Calls plot(offsets from s.base) for each full group of 8 pixels
+            template <class Plot>
+            X11ENGINE_TARGET_AVX2 inline int WalkLine8(const LineSetup& s, Plot&& plot) {
+                const __m256i vMajorStep = _mm256_set1_epi32(s.majorStep);
+                const __m256i vMinorStep = _mm256_set1_epi32(s.minorStep);
+                return StepLine8(s.count, s.major, s.minor, [&](__m256i idx, __m256i q) X11ENGINE_TARGET_AVX2 {
+                    plot(_mm256_add_epi32(_mm256_mullo_epi32(idx, vMajorStep), _mm256_mullo_epi32(q, vMinorStep)));
+                });
+            }
+
+            // Calls plot(offsets from s.dst) for each full group of 8 pixels: coordinates first, then TiledOffset in every lane
+            template <class Plot>
+            X11ENGINE_TARGET_AVX2 inline int WalkTiledLine8(const TiledLineSetup& s, Plot&& plot) {
+                const __m256i x0 = _mm256_set1_epi32(s.x0);
+                const __m256i y0 = _mm256_set1_epi32(s.y0);
+                const __m256i majorX = _mm256_set1_epi32(s.majorX);
+                const __m256i majorY = _mm256_set1_epi32(s.majorY);
+                const __m256i minorX = _mm256_set1_epi32(s.minorX);
+                const __m256i minorY = _mm256_set1_epi32(s.minorY);
+                const __m256i tilesPerRow = _mm256_set1_epi32(s.tilesPerRow);
+                const __m256i inTile = _mm256_set1_epi32(TILE - 1);
+                return StepLine8(s.count, s.major, s.minor, [&](__m256i idx, __m256i q) X11ENGINE_TARGET_AVX2 {
+                    __m256i x = _mm256_add_epi32(x0, _mm256_add_epi32(_mm256_mullo_epi32(idx, majorX), _mm256_mullo_epi32(q, minorX)));
+                    __m256i y = _mm256_add_epi32(y0, _mm256_add_epi32(_mm256_mullo_epi32(idx, majorY), _mm256_mullo_epi32(q, minorY)));
+                    __m256i tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(y, TILE_SHIFT), tilesPerRow), _mm256_srli_epi32(x, TILE_SHIFT));
+                    __m256i local = _mm256_add_epi32(_mm256_slli_epi32(_mm256_and_si256(y, inTile), TILE_SHIFT), _mm256_and_si256(x, inTile));
+                    plot(_mm256_add_epi32(_mm256_slli_epi32(tile, 2 * TILE_SHIFT), local));
+                });
+            }
+
+            X11ENGINE_TARGET_AVX2 void Line(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color) {
+                LineSetup s = SetupLine(dst, pitch, x0, y0, x1, y1);
+                if (s.count < 16) {
+                    LineScalar(s, 0, color);
+                    return;
+                }
+
+                alignas(32) int offsets[8];
+                int i = WalkLine8(s, [&](__m256i offset) X11ENGINE_TARGET_AVX2 {
+                    _mm256_store_si256(reinterpret_cast<__m256i*>(offsets), offset);
+                    for (int k = 0; k < 8; ++k)
+                        s.base[offsets[k]] = color;
+                });
+
+                LineScalar(s, i, color);
+            }
+
+            X11ENGINE_TARGET_AVX2 void LineTiled(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color) {
+                TiledLineSetup s = SetupTiledLine(dst, tilesPerRow, x0, y0, x1, y1);
+                int i = 0;
+                if (s.count >= 16) {
+                    alignas(32) int offsets[8];
+                    i = WalkTiledLine8(s, [&](__m256i offset) X11ENGINE_TARGET_AVX2 {
+                        _mm256_store_si256(reinterpret_cast<__m256i*>(offsets), offset);
+                        for (int k = 0; k < 8; ++k)
+                            s.dst[offsets[k]] = color;
+                    });
+                }
+                LineTiledScalar(s, i, color);
+            }
+
+            // Outside masks of 8 endpoints (SoA) against the planes of ClipCode
+            struct ClipMasks8 {
+                __m256 viewport[6];
+                __m256 guard; // Any guard plane, near or far
+            };
+
+            X11ENGINE_TARGET_AVX2 inline ClipMasks8 Classify8(__m256 x, __m256 y, __m256 z, __m256 w, __m256 guard) {
+                const __m256 zero = _mm256_setzero_ps();
+                __m256 gw = _mm256_mul_ps(guard, w);
+                __m256 ngw = _mm256_sub_ps(zero, gw);
+                __m256 nw = _mm256_sub_ps(zero, w);
+
+                ClipMasks8 m;
+                m.viewport[0] = _mm256_cmp_ps(x, nw, _CMP_LT_OQ);
+                m.viewport[1] = _mm256_cmp_ps(x, w, _CMP_GT_OQ);
+                m.viewport[2] = _mm256_cmp_ps(y, nw, _CMP_LT_OQ);
+                m.viewport[3] = _mm256_cmp_ps(y, w, _CMP_GT_OQ);
+                m.viewport[4] = _mm256_cmp_ps(z, nw, _CMP_LT_OQ);
+                m.viewport[5] = _mm256_cmp_ps(z, w, _CMP_GT_OQ);
+                m.guard = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(x, ngw, _CMP_LT_OQ), _mm256_cmp_ps(x, gw, _CMP_GT_OQ)),
+                                       _mm256_or_ps(_mm256_cmp_ps(y, ngw, _CMP_LT_OQ), _mm256_cmp_ps(y, gw, _CMP_GT_OQ)));
+                m.guard = _mm256_or_ps(m.guard, _mm256_or_ps(m.viewport[4], m.viewport[5]));
+                m.guard = _mm256_or_ps(m.guard, _mm256_cmp_ps(w, _mm256_set1_ps(MIN_CLIP_W), _CMP_NGE_UQ)); // ClipLine handles w near 0
+                return m;
+            }
+
+            X11ENGINE_TARGET_AVX2 inline void Project8(__m256 x, __m256 y, __m256 w, __m256 halfW, __m256 halfH, int* sx, int* sy) {
+                const __m256 one = _mm256_set1_ps(1.0f);
+                __m256 invW = _mm256_div_ps(one, w);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(sx), _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(x, invW), one), halfW)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(sy), _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(y, invW)), halfH)));
+            }
+
+            X11ENGINE_TARGET_AVX2 std::size_t ClipLines(const math::Vec4* verts, std::size_t vertexCount, const std::array<int, 2>* edges, std::size_t edgeCount, const ClipViewport& vp,
+                                                        ScreenLine* out) {
+                const __m256 guard = _mm256_set1_ps(vp.guardBand);
+                const __m256 halfW = _mm256_set1_ps(vp.halfWidth);
+                const __m256 halfH = _mm256_set1_ps(vp.halfHeight);
+                const __m256i limit = _mm256_set1_epi32(static_cast<int>(std::min<std::size_t>(vertexCount, 0x7FFFFFFF)));
+                const float* base = &verts[0].x;
+
+                std::size_t n = 0;
+                std::size_t i = 0;
+                for (; i + 8 <= edgeCount; i += 8) {
+                    const std::array<int, 2>* e = edges + i;
+
+                    // Deinterleave 8 index pairs: shuffle gives edges 0 1 4 5 | 2 3 6 7, the permute restores the order
+                    __m256 lo = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(e)));
+                    __m256 hi = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(e + 4)));
+                    __m256i ia = _mm256_castpd_si256(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0)));
+                    __m256i ib = _mm256_castpd_si256(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0)));
+
+                    // 0 <= index < vertexCount for all 16, otherwise let the scalar path skip the bad ones
+                    __m256i bad = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), ia), _mm256_cmpgt_epi32(_mm256_setzero_si256(), ib)),
+                                                  _mm256_or_si256(_mm256_cmpgt_epi32(ia, _mm256_sub_epi32(limit, _mm256_set1_epi32(1))), _mm256_cmpgt_epi32(ib, _mm256_sub_epi32(limit, _mm256_set1_epi32(1)))));
+                    if (!_mm256_testz_si256(bad, bad)) {
+                        n += ClipLinesScalar(verts, vertexCount, e, 8, vp, out + n);
+                        continue;
+                    }
+
+                    __m256i oa = _mm256_slli_epi32(ia, 2);
+                    __m256i ob = _mm256_slli_epi32(ib, 2);
+                    __m256 ax = _mm256_i32gather_ps(base, oa, 4), ay = _mm256_i32gather_ps(base + 1, oa, 4), az = _mm256_i32gather_ps(base + 2, oa, 4), aw = _mm256_i32gather_ps(base + 3, oa, 4);
+                    __m256 bx = _mm256_i32gather_ps(base, ob, 4), by = _mm256_i32gather_ps(base + 1, ob, 4), bz = _mm256_i32gather_ps(base + 2, ob, 4), bw = _mm256_i32gather_ps(base + 3, ob, 4);
+
+                    ClipMasks8 ma = Classify8(ax, ay, az, aw, guard);
+                    ClipMasks8 mb = Classify8(bx, by, bz, bw, guard);
+
+                    __m256 reject = _mm256_setzero_ps();
+                    for (int p = 0; p < 6; ++p)
+                        reject = _mm256_or_ps(reject, _mm256_and_ps(ma.viewport[p], mb.viewport[p]));
+                    __m256 clip = _mm256_andnot_ps(reject, _mm256_or_ps(ma.guard, mb.guard));
+
+                    alignas(32) int sx0[8], sy0[8], sx1[8], sy1[8];
+                    Project8(ax, ay, aw, halfW, halfH, sx0, sy0);
+                    Project8(bx, by, bw, halfW, halfH, sx1, sy1);
+
+                    n += EmitLanes(8, _mm256_movemask_ps(reject), _mm256_movemask_ps(clip), sx0, sy0, sx1, sy1, verts, e, vp, out + n);
+                }
+
+                return n + sse2::ClipLines(verts, vertexCount, edges + i, edgeCount - i, vp, out + n);
+            }
+
+            X11ENGINE_TARGET_AVX2 std::size_t IntegrateParticles(const ParticleStreams& s, std::size_t begin, std::size_t end, const ParticleStep& step) {
+                const __m256 dt = _mm256_set1_ps(step.dt);
+                const __m256 drag = _mm256_set1_ps(step.drag);
+                const __m256 ax = _mm256_set1_ps(step.ax), ay = _mm256_set1_ps(step.ay), az = _mm256_set1_ps(step.az);
+                const __m256 zero = _mm256_setzero_ps();
+
+                // Separate mul and add (no FMA) so positions match the SSE2 kernel bit for bit
+                std::size_t dead = 0;
+                std::size_t i = begin;
+                for (; i + 8 <= end; i += 8) {
+                    __m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.vx + i), ax), drag);
+                    __m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.vy + i), ay), drag);
+                    __m256 vz = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.vz + i), az), drag);
+                    _mm256_storeu_ps(s.vx + i, vx);
+                    _mm256_storeu_ps(s.vy + i, vy);
+                    _mm256_storeu_ps(s.vz + i, vz);
+                    _mm256_storeu_ps(s.px + i, _mm256_add_ps(_mm256_loadu_ps(s.px + i), _mm256_mul_ps(vx, dt)));
+                    _mm256_storeu_ps(s.py + i, _mm256_add_ps(_mm256_loadu_ps(s.py + i), _mm256_mul_ps(vy, dt)));
+                    _mm256_storeu_ps(s.pz + i, _mm256_add_ps(_mm256_loadu_ps(s.pz + i), _mm256_mul_ps(vz, dt)));
+
+                    __m256 life = _mm256_sub_ps(_mm256_loadu_ps(s.life + i), dt);
+                    _mm256_storeu_ps(s.life + i, life);
+                    dead += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(life, zero, _CMP_LE_OQ)));
+                }
+                return dead + sse2::IntegrateParticles(s, i, end, step);
+            }
+
+            X11ENGINE_TARGET_AVX2 void ProjectParticles(const math::Mat4& m, const float* x, const float* y, const float* z, std::size_t count, const ClipViewport& vp, int width, int height,
+                                                        uint32_t* offsets) {
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 halfW = _mm256_set1_ps(vp.halfWidth);
+                const __m256 halfH = _mm256_set1_ps(vp.halfHeight);
+                const __m256 widthF = _mm256_set1_ps(static_cast<float>(width));
+                const __m256 heightF = _mm256_set1_ps(static_cast<float>(height));
+                const __m256i pitch = _mm256_set1_epi32(width);
+                const __m256i culled = _mm256_set1_epi32(static_cast<int>(PARTICLE_CULLED));
+
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+                    auto row = [&](float r0, float r1, float r2, float r3) X11ENGINE_TARGET_AVX2 {
+                        return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(r0), px), _mm256_mul_ps(_mm256_set1_ps(r1), py)), _mm256_mul_ps(_mm256_set1_ps(r2), pz)),
+                                             _mm256_set1_ps(r3));
+                    };
+                    __m256 cx = row(m.c0.x, m.c1.x, m.c2.x, m.c3.x);
+                    __m256 cy = row(m.c0.y, m.c1.y, m.c2.y, m.c3.y);
+                    __m256 cz = row(m.c0.z, m.c1.z, m.c2.z, m.c3.z);
+                    __m256 cw = row(m.c0.w, m.c1.w, m.c2.w, m.c3.w);
+
+                    __m256 invW = _mm256_div_ps(one, cw);
+                    __m256 fx = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(cx, invW), one), halfW);
+                    __m256 fy = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(cy, invW)), halfH);
+                    __m256 in = _mm256_and_ps(_mm256_cmp_ps(cz, _mm256_sub_ps(zero, cw), _CMP_GE_OQ), _mm256_cmp_ps(cz, cw, _CMP_LE_OQ));
+                    in = _mm256_and_ps(in, _mm256_and_ps(_mm256_cmp_ps(fx, zero, _CMP_GE_OQ), _mm256_cmp_ps(fx, widthF, _CMP_LT_OQ)));
+                    in = _mm256_and_ps(in, _mm256_and_ps(_mm256_cmp_ps(fy, zero, _CMP_GE_OQ), _mm256_cmp_ps(fy, heightF, _CMP_LT_OQ)));
+
+                    __m256i offset = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(fy), pitch), _mm256_cvttps_epi32(fx));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(offsets + i), _mm256_blendv_epi8(culled, offset, _mm256_castps_si256(in)));
+                }
+                sse2::ProjectParticles(m, x + i, y + i, z + i, count - i, vp, width, height, offsets + i);
+            }
+
+            // Same arithmetic as sse2::Blend4 on 8 pixels (unpack/pack stay within 128-bit lanes, so order is kept)
+            X11ENGINE_TARGET_AVX2 inline __m256i Blend8(__m256i d, __m256i factor, __m256i add) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i half = _mm256_set1_epi16(128);
+                __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), factor), half);
+                __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), factor), half);
+                lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+                hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+                return _mm256_adds_epu8(_mm256_packus_epi16(lo, hi), add);
+            }
+
+            X11ENGINE_TARGET_AVX2 void BlendFill(uint32_t* dst, std::size_t count, uint32_t color, color::BlendMode mode) {
+                BlendOp op = MakeBlendOp(color, mode);
+                const __m256i factor = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(op.factor)), _mm256_setzero_si256());
+                const __m256i add = _mm256_set1_epi32(static_cast<int>(op.add));
+
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+                    _mm256_storeu_si256(p, Blend8(_mm256_loadu_si256(p), factor, add));
+                }
+                for (; i < count; ++i)
+                    dst[i] = BlendPixel(dst[i], op);
+            }
+
+            // Gather 8 line pixels, blend, write back (AVX2 has no scatter)
+            X11ENGINE_TARGET_AVX2 inline void BlendGather8(uint32_t* base, __m256i offset, __m256i factor, __m256i add) {
+                alignas(32) int offsets[8];
+                alignas(32) uint32_t out[8];
+                __m256i d = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), offset, 4);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(out), Blend8(d, factor, add));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(offsets), offset);
+                for (int k = 0; k < 8; ++k)
+                    base[offsets[k]] = out[k];
+            }
+
+            X11ENGINE_TARGET_AVX2 void BlendLine(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
+                BlendOp op = MakeBlendOp(color, mode);
+                LineSetup s = SetupLine(dst, pitch, x0, y0, x1, y1);
+                int i = 0;
+
+                if (s.count >= 16) {
+                    const __m256i factor = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(op.factor)), _mm256_setzero_si256());
+                    const __m256i add = _mm256_set1_epi32(static_cast<int>(op.add));
+                    i = WalkLine8(s, [&](__m256i offset) X11ENGINE_TARGET_AVX2 { BlendGather8(s.base, offset, factor, add); });
+                }
+
+                WalkLineScalar(s, i, [&](uint32_t* p) { *p = BlendPixel(*p, op); });
+            }
+
+            X11ENGINE_TARGET_AVX2 void BlendLineTiled(uint32_t* dst, int tilesPerRow, int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
+                BlendOp op = MakeBlendOp(color, mode);
+                TiledLineSetup s = SetupTiledLine(dst, tilesPerRow, x0, y0, x1, y1);
+                int i = 0;
+
+                if (s.count >= 16) {
+                    const __m256i factor = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(op.factor)), _mm256_setzero_si256());
+                    const __m256i add = _mm256_set1_epi32(static_cast<int>(op.add));
+                    i = WalkTiledLine8(s, [&](__m256i offset) X11ENGINE_TARGET_AVX2 { BlendGather8(s.dst, offset, factor, add); });
+                }
+
+                WalkTiledLineScalar(s, i, [&](uint32_t* p) { *p = BlendPixel(*p, op); });
+            }
+
+            X11ENGINE_TARGET_AVX2 void CopyRow(uint32_t* dst, const uint32_t* src, std::size_t count) {
+                const __m256i rgb = _mm256_set1_epi32(RGB_MASK);
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), rgb));
+                for (; i < count; ++i)
+                    dst[i] = src[i] & RGB_MASK;
+            }
+
+            X11ENGINE_TARGET_AVX2 void KeyRow(uint32_t* dst, const uint32_t* src, std::size_t count, uint32_t key) {
+                const __m256i rgb = _mm256_set1_epi32(RGB_MASK);
+                const __m256i vKey = _mm256_set1_epi32(static_cast<int>(key & RGB_MASK));
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i s = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), rgb);
+                    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(s, d, _mm256_cmpeq_epi32(s, vKey)));
+                }
+                for (; i < count; ++i) {
+                    uint32_t s = src[i] & RGB_MASK;
+                    if (s != (key & RGB_MASK))
+                        dst[i] = s;
+                }
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i Over8(__m256i d, __m256i s) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i full = _mm256_set1_epi16(255);
+                const __m256i half = _mm256_set1_epi16(128);
+                __m256i sLo = _mm256_unpacklo_epi8(s, zero);
+                __m256i sHi = _mm256_unpackhi_epi8(s, zero);
+                __m256i invLo = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sLo, 0xFF), 0xFF));
+                __m256i invHi = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(sHi, 0xFF), 0xFF));
+                __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), invLo), half);
+                __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), invHi), half);
+                lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+                hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+                return _mm256_and_si256(_mm256_adds_epu8(_mm256_packus_epi16(lo, hi), s), _mm256_set1_epi32(RGB_MASK));
+            }
+
+            X11ENGINE_TARGET_AVX2 void AlphaRow(uint32_t* dst, const uint32_t* src, std::size_t count) {
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+                    _mm256_storeu_si256(d, Over8(_mm256_loadu_si256(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+                }
+                for (; i < count; ++i)
+                    dst[i] = OverPixel(dst[i], src[i]);
+            }
+
+            // A tile row is exactly one register
+            X11ENGINE_TARGET_AVX2 void DetileRow(uint32_t* dst, std::size_t pitch, const uint32_t* tiles, int width, int rows) {
+                int full = width >> TILE_SHIFT;
+                for (int t = 0; t < full; ++t, tiles += TILE_PIXELS) {
+                    for (int r = 0; r < rows; ++r)
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + r * pitch + t * TILE), _mm256_load_si256(reinterpret_cast<const __m256i*>(tiles + r * TILE)));
+                }
+                DetilePartial(dst + full * TILE, pitch, tiles, width & (TILE - 1), rows);
+            }
+
+            // One gather per channel table
+            X11ENGINE_TARGET_AVX2 void LutRow(uint32_t* px, std::size_t count, const uint32_t* lut) {
+                const __m256i mask = _mm256_set1_epi32(0xFF);
+                const int* table = reinterpret_cast<const int*>(lut);
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i* p = reinterpret_cast<__m256i*>(px + i);
+                    __m256i d = _mm256_loadu_si256(p);
+                    __m256i b = _mm256_i32gather_epi32(table, _mm256_and_si256(d, mask), 4);
+                    __m256i g = _mm256_i32gather_epi32(table + 256, _mm256_and_si256(_mm256_srli_epi32(d, 8), mask), 4);
+                    __m256i r = _mm256_i32gather_epi32(table + 512, _mm256_and_si256(_mm256_srli_epi32(d, 16), mask), 4);
+                    _mm256_storeu_si256(p, _mm256_or_si256(_mm256_or_si256(b, g), r));
+                }
+                for (; i < count; ++i)
+                    px[i] = LutPixel(px[i], lut);
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i Vignette4(__m256i ch, __m256i columns, __m256i rowFactor) {
+                __m256i f = _mm256_mulhi_epu16(columns, rowFactor);
+                return _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(ch, _mm256_set1_epi16(257)), f), 8);
+            }
+
+            X11ENGINE_TARGET_AVX2 void VignetteRow(uint32_t* px, std::size_t count, const uint16_t* columns, uint16_t rowFactor) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i row = _mm256_set1_epi16(static_cast<short>(rowFactor));
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i* p = reinterpret_cast<__m256i*>(px + i);
+                    __m256i d = _mm256_loadu_si256(p);
+
+                    // Unpacks work per 128-bit lane: lo is pixels 0, 1, 4, 5 and hi 2, 3, 6, 7, so the factors are regrouped the same way
+                    const __m256i* f = reinterpret_cast<const __m256i*>(columns + 4 * i);
+                    __m256i f0 = _mm256_loadu_si256(f), f1 = _mm256_loadu_si256(f + 1);
+                    __m256i fLo = _mm256_permute2x128_si256(f0, f1, 0x20);
+                    __m256i fHi = _mm256_permute2x128_si256(f0, f1, 0x31);
+                    __m256i lo = Vignette4(_mm256_unpacklo_epi8(d, zero), fLo, row);
+                    __m256i hi = Vignette4(_mm256_unpackhi_epi8(d, zero), fHi, row);
+                    _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+                }
+                for (; i < count; ++i)
+                    px[i] = VignettePixel(px[i], columns + 4 * i, rowFactor);
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i Luma8(__m256i p) {
+                const __m256i mask = _mm256_set1_epi32(0xFF);
+                __m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 8), mask);
+                return _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(p, mask), _mm256_and_si256(_mm256_srli_epi32(p, 16), mask)), _mm256_add_epi32(g, g));
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i SmoothSum4(__m256i c, __m256i n, __m256i s, __m256i w, __m256i e) {
+                __m256i sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_slli_epi16(c, 2), _mm256_set1_epi16(4)), _mm256_add_epi16(_mm256_add_epi16(n, s), _mm256_add_epi16(w, e)));
+                return _mm256_srli_epi16(sum, 3);
+            }
+
+            X11ENGINE_TARGET_AVX2 void SmoothRow(uint32_t* out, const uint32_t* above, const uint32_t* row, const uint32_t* below, int width, int threshold) {
+                const __m256i zero = _mm256_setzero_si256();
+                const __m256i vThreshold = _mm256_set1_epi32(threshold);
+
+                SmoothRowScalar(out, above, row, below, 0, std::min(width, 1), width, threshold);
+                int x = 1;
+                for (; x + 8 < width; x += 8) {
+                    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+                    __m256i n = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x));
+                    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + x));
+                    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x - 1));
+                    __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 1));
+
+                    __m256i lc = Luma8(c), ln = Luma8(n), ls = Luma8(s), lw = Luma8(w), le = Luma8(e);
+                    __m256i lmax = _mm256_max_epi32(_mm256_max_epi32(_mm256_max_epi32(lc, ln), _mm256_max_epi32(ls, lw)), le);
+                    __m256i lmin = _mm256_min_epi32(_mm256_min_epi32(_mm256_min_epi32(lc, ln), _mm256_min_epi32(ls, lw)), le);
+                    __m256i keep = _mm256_cmpgt_epi32(_mm256_max_epi32(vThreshold, _mm256_srli_epi32(lmax, 3)), _mm256_sub_epi32(lmax, lmin));
+
+                    __m256i lo = SmoothSum4(_mm256_unpacklo_epi8(c, zero), _mm256_unpacklo_epi8(n, zero), _mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(w, zero), _mm256_unpacklo_epi8(e, zero));
+                    __m256i hi = SmoothSum4(_mm256_unpackhi_epi8(c, zero), _mm256_unpackhi_epi8(n, zero), _mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(w, zero), _mm256_unpackhi_epi8(e, zero));
+                    __m256i smooth = _mm256_packus_epi16(lo, hi);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), _mm256_blendv_epi8(smooth, c, keep));
+                }
+                SmoothRowScalar(out, above, row, below, std::max(x, std::min(width, 1)), width, width, threshold);
+            }
+
+            // 8-lane port of math::sincos (same reduction and coefficients, FMA for the polynomials)
+            X11ENGINE_TARGET_AVX2 void SinCos(const float* angles, float* s, float* c, std::size_t count) {
+                using namespace math::detail;
+
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256 x = _mm256_loadu_ps(angles + i);
+                    __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)));
+                    __m256 qf = _mm256_cvtepi32_ps(q);
+
+                    // Separate multiply and subtract: an FMA here would change the rounding of the reduction
+                    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_1)));
+                    r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_2)));
+                    r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(PIO2_3)));
+                    __m256 r2 = _mm256_mul_ps(r, r);
+
+                    __m256 ps = _mm256_fmadd_ps(r2, _mm256_set1_ps(SIN_C3), _mm256_set1_ps(SIN_C2));
+                    ps = _mm256_fmadd_ps(r2, ps, _mm256_set1_ps(SIN_C1));
+                    ps = _mm256_fmadd_ps(_mm256_mul_ps(r2, r), ps, r);
+
+                    __m256 pc = _mm256_fmadd_ps(r2, _mm256_set1_ps(COS_C3), _mm256_set1_ps(COS_C2));
+                    pc = _mm256_fmadd_ps(r2, pc, _mm256_set1_ps(COS_C1));
+                    pc = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), pc, _mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f)));
+
+                    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+                    __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+                    __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+                    _mm256_storeu_ps(s + i, _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sinSign));
+                    _mm256_storeu_ps(c + i, _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cosSign));
+                }
+
+                if (i < count)
+                    sse2::SinCos(angles + i, s + i, c + i, count - i);
+            }
+
+            // Texture sampling, 8 texels per step with hardware gathers
+            X11ENGINE_TARGET_AVX2 inline __m256i FloorTexels(__m256 f) {
+                __m256i i = _mm256_cvttps_epi32(f);
+                return _mm256_add_epi32(i, _mm256_castps_si256(_mm256_cmp_ps(f, _mm256_cvtepi32_ps(i), _CMP_LT_OQ)));
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i TexelOffsets(const TextureLevel& l, __m256i x, __m256i y) {
+                x = _mm256_and_si256(x, _mm256_set1_epi32(l.widthMask));
+                y = _mm256_and_si256(y, _mm256_set1_epi32(l.heightMask));
+                const __m256i three = _mm256_set1_epi32(3);
+                __m256i tile = _mm256_or_si256(_mm256_sll_epi32(_mm256_srli_epi32(y, 2), _mm_cvtsi32_si128(l.tileShift)), _mm256_slli_epi32(_mm256_srli_epi32(x, 2), 4));
+                return _mm256_or_si256(tile, _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(y, three), 2), _mm256_and_si256(x, three)));
+            }
+
+            X11ENGINE_TARGET_AVX2 inline __m256i FetchTexels(const TextureLevel& l, __m256i offsets) {
+                return _mm256_i32gather_epi32(reinterpret_cast<const int*>(l.texels), offsets, 4);
+            }
+
+            // Same as sse2::Lerp; the per-lane pack/unpack order matches the per-lane byte unpacks
+            X11ENGINE_TARGET_AVX2 inline __m256i LerpTexels(__m256i a, __m256i b, __m256i w) {
+                __m256i w16 = _mm256_packs_epi32(w, w);
+                w16 = _mm256_unpacklo_epi16(w16, w16);
+                __m256i wLo = _mm256_unpacklo_epi32(w16, w16);
+                __m256i wHi = _mm256_unpackhi_epi32(w16, w16);
+
+                const __m256i zero = _mm256_setzero_si256();
+                __m256i aLo = _mm256_unpacklo_epi8(a, zero);
+                __m256i aHi = _mm256_unpackhi_epi8(a, zero);
+                __m256i lo = _mm256_add_epi16(aLo, _mm256_srai_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(_mm256_unpacklo_epi8(b, zero), aLo), wLo), TEXEL_WEIGHT_BITS));
+                __m256i hi = _mm256_add_epi16(aHi, _mm256_srai_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(_mm256_unpackhi_epi8(b, zero), aHi), wHi), TEXEL_WEIGHT_BITS));
+                return _mm256_packus_epi16(lo, hi);
+            }
+
+            template <TextureFilter F>
+            X11ENGINE_TARGET_AVX2 inline __m256i SampleTexels8(const TextureLevel& l, __m256 u, __m256 v) {
+                const __m256 width = _mm256_set1_ps(l.width);
+                const __m256 height = _mm256_set1_ps(l.height);
+                if constexpr (F == TextureFilter::Nearest) {
+                    return FetchTexels(l, TexelOffsets(l, FloorTexels(_mm256_mul_ps(u, width)), FloorTexels(_mm256_mul_ps(v, height))));
+                } else {
+                    const __m256 half = _mm256_set1_ps(0.5f);
+                    const __m256 one = _mm256_set1_ps(TEXEL_WEIGHT_ONE);
+                    const __m256i step = _mm256_set1_epi32(1);
+                    __m256 fx = _mm256_sub_ps(_mm256_mul_ps(u, width), half);
+                    __m256 fy = _mm256_sub_ps(_mm256_mul_ps(v, height), half);
+                    __m256i x = FloorTexels(fx);
+                    __m256i y = FloorTexels(fy);
+                    __m256i wx = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(fx, _mm256_cvtepi32_ps(x)), one));
+                    __m256i wy = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(fy, _mm256_cvtepi32_ps(y)), one));
+                    __m256i x1 = _mm256_add_epi32(x, step);
+                    __m256i y1 = _mm256_add_epi32(y, step);
+
+                    __m256i top = LerpTexels(FetchTexels(l, TexelOffsets(l, x, y)), FetchTexels(l, TexelOffsets(l, x1, y)), wx);
+                    __m256i bottom = LerpTexels(FetchTexels(l, TexelOffsets(l, x, y1)), FetchTexels(l, TexelOffsets(l, x1, y1)), wx);
+                    return LerpTexels(top, bottom, wy);
+                }
+            }
+
+            template <TextureFilter F>
+            X11ENGINE_TARGET_AVX2 void SampleTexels(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) {
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), SampleTexels8<F>(l, _mm256_loadu_ps(u + i), _mm256_loadu_ps(v + i)));
+                for (; i < count; ++i)
+                    out[i] = SampleTexelScalar<F>(l, u[i], v[i]);
+            }
+
+            template <TextureFilter F>
+            X11ENGINE_TARGET_AVX2 void SampleTexelSpan(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) {
+                int i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+                    __m256 q = _mm256_add_ps(_mm256_set1_ps(s.oneOverW), _mm256_mul_ps(index, _mm256_set1_ps(s.oneOverWStep)));
+                    __m256 u = _mm256_div_ps(_mm256_add_ps(_mm256_set1_ps(s.uOverW), _mm256_mul_ps(index, _mm256_set1_ps(s.uOverWStep))), q);
+                    __m256 v = _mm256_div_ps(_mm256_add_ps(_mm256_set1_ps(s.vOverW), _mm256_mul_ps(index, _mm256_set1_ps(s.vOverWStep))), q);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), SampleTexels8<F>(l, u, v));
+                }
+                for (; i < count; ++i) {
+                    float index = static_cast<float>(i);
+                    float q = s.oneOverW + index * s.oneOverWStep;
+                    out[i] = SampleTexelScalar<F>(l, (s.uOverW + index * s.uOverWStep) / q, (s.vOverW + index * s.vOverWStep) / q);
+                }
+            }
+
+            X11ENGINE_TARGET_AVX2 void SampleNearest(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) { SampleTexels<TextureFilter::Nearest>(l, u, v, count, out); }
+            X11ENGINE_TARGET_AVX2 void SampleBilinear(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) { SampleTexels<TextureFilter::Bilinear>(l, u, v, count, out); }
+            X11ENGINE_TARGET_AVX2 void SampleSpanNearest(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) { SampleTexelSpan<TextureFilter::Nearest>(l, s, count, out); }
+            X11ENGINE_TARGET_AVX2 void SampleSpanBilinear(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) { SampleTexelSpan<TextureFilter::Bilinear>(l, s, count, out); }
+
+        } // namespace avx2
+
+        // ==========================
+        // AVX-512F
+        // ==========================
+        namespace avx512 {
+
+            X11ENGINE_TARGET_AVX512 void TransformPoints(const math::Mat4& m, const math::Vec3* in, math::Vec4* out, std::size_t count) {
+                // Four vertices per register; 4 packed Vec3 (12 floats) are spread with a permute
+                __m512 c0 = _mm512_broadcast_f32x4(m.c0.mm);
+                __m512 c1 = _mm512_broadcast_f32x4(m.c1.mm);
+                __m512 c2 = _mm512_broadcast_f32x4(m.c2.mm);
+                __m512 c3 = _mm512_broadcast_f32x4(m.c3.mm);
+
+                const __m512i splatX = _mm512_setr_epi32(0, 0, 0, 0, 3, 3, 3, 3, 6, 6, 6, 6, 9, 9, 9, 9);
+                const __m512i splatY = _mm512_setr_epi32(1, 1, 1, 1, 4, 4, 4, 4, 7, 7, 7, 7, 10, 10, 10, 10);
+                const __m512i splatZ = _mm512_setr_epi32(2, 2, 2, 2, 5, 5, 5, 5, 8, 8, 8, 8, 11, 11, 11, 11);
+
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m512 packed = _mm512_maskz_loadu_ps(0x0FFF, &in[i].x);
+
+                    __m512 res = _mm512_fmadd_ps(c0, _mm512_permutexvar_ps(splatX, packed), c3);
+                    res = _mm512_fmadd_ps(c1, _mm512_permutexvar_ps(splatY, packed), res);
+                    res = _mm512_fmadd_ps(c2, _mm512_permutexvar_ps(splatZ, packed), res);
+                    _mm512_storeu_ps(&out[i].x, res);
+                }
+
+                if (i < count)
+                    avx2::TransformPoints(m, in + i, out + i, count - i);
+            }
+
+            X11ENGINE_TARGET_AVX512 void Fill(uint32_t* dst, std::size_t count, uint32_t color) {
+                std::size_t i = 0;
+                while (i < count && (reinterpret_cast<uintptr_t>(dst + i) & 63))
+                    dst[i++] = color;
+
+                __m512i v = _mm512_set1_epi32(static_cast<int>(color));
+                if (count >= STREAM_THRESHOLD) {
+                    for (; i + 16 <= count; i += 16)
+                        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst + i), v);
+                    _mm_sfence();
+                } else {
+                    for (; i + 16 <= count; i += 16)
+                        _mm512_store_si512(reinterpret_cast<__m512i*>(dst + i), v);
+                }
+
+                // Masked tail instead of a scalar loop
+                if (i < count)
+                    _mm512_mask_storeu_epi32(dst + i, static_cast<__mmask16>((1u << (count - i)) - 1), v);
+            }
+
+            X11ENGINE_TARGET_AVX512 void Line(uint32_t* dst, int pitch, int x0, int y0, int x1, int y1, uint32_t color) {
+                LineSetup s = SetupLine(dst, pitch, x0, y0, x1, y1);
+                if (s.count < 32) {
+                    LineScalar(s, 0, color);
+                    return;
+                }
+
+                // Same scheme as AVX2 with 16 lanes, but pixels are written with a single scatter
+                int twoMajor = 2 * s.major;
+                int Q = (32 * s.minor) / twoMajor;
+                int R = (32 * s.minor) % twoMajor;
+
+                alignas(64) int num0[16], q0[16];
+                for (int k = 0; k < 16; ++k) {
+                    int start = s.major + 2 * k * s.minor;
+                    num0[k] = start % twoMajor;
+                    q0[k] = start / twoMajor;
+                }
+
+                __m512i num = _mm512_load_si512(num0);
+                __m512i q = _mm512_load_si512(q0);
+                __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+                const __m512i sixteen = _mm512_set1_epi32(16);
+                const __m512i vQ = _mm512_set1_epi32(Q);
+                const __m512i vR = _mm512_set1_epi32(R);
+                const __m512i vTwoMajor = _mm512_set1_epi32(twoMajor);
+                const __m512i vMajorStep = _mm512_set1_epi32(s.majorStep);
+                const __m512i vMinorStep = _mm512_set1_epi32(s.minorStep);
+                const __m512i vColor = _mm512_set1_epi32(static_cast<int>(color));
+                const __m512i vCount = _mm512_set1_epi32(s.count);
+
+                for (int i = 0; i < s.count; i += 16) {
+                    __m512i offset = _mm512_add_epi32(_mm512_mullo_epi32(idx, vMajorStep), _mm512_mullo_epi32(q, vMinorStep));
+                    __mmask16 live = _mm512_cmplt_epi32_mask(idx, vCount);
+                    _mm512_mask_i32scatter_epi32(s.base, live, offset, vColor, 4);
+
+                    idx = _mm512_add_epi32(idx, sixteen);
+                    num = _mm512_add_epi32(num, vR);
+                    __mmask16 wrap = _mm512_cmpge_epi32_mask(num, vTwoMajor);
+                    num = _mm512_mask_sub_epi32(num, wrap, num, vTwoMajor);
+                    q = _mm512_mask_add_epi32(_mm512_add_epi32(q, vQ), wrap, _mm512_add_epi32(q, vQ), _mm512_set1_epi32(1));
+                }
+            }
+
+            // Texture sampling, nearest only: bilinear weights need byte/word arithmetic (BW)
+            X11ENGINE_TARGET_AVX512 inline __m512i FloorTexels(__m512 f) {
+                __m512i i = _mm512_cvttps_epi32(f);
+                return _mm512_mask_sub_epi32(i, _mm512_cmp_ps_mask(f, _mm512_cvtepi32_ps(i), _CMP_LT_OQ), i, _mm512_set1_epi32(1));
+            }
+
+            X11ENGINE_TARGET_AVX512 inline __m512i NearestTexels16(const TextureLevel& l, __m512 u, __m512 v) {
+                __m512i x = _mm512_and_si512(FloorTexels(_mm512_mul_ps(u, _mm512_set1_ps(l.width))), _mm512_set1_epi32(l.widthMask));
+                __m512i y = _mm512_and_si512(FloorTexels(_mm512_mul_ps(v, _mm512_set1_ps(l.height))), _mm512_set1_epi32(l.heightMask));
+                const __m512i three = _mm512_set1_epi32(3);
+                __m512i tile = _mm512_or_si512(_mm512_sll_epi32(_mm512_srli_epi32(y, 2), _mm_cvtsi32_si128(l.tileShift)), _mm512_slli_epi32(_mm512_srli_epi32(x, 2), 4));
+                __m512i offsets = _mm512_or_si512(tile, _mm512_or_si512(_mm512_slli_epi32(_mm512_and_si512(y, three), 2), _mm512_and_si512(x, three)));
+                return _mm512_i32gather_epi32(offsets, l.texels, 4);
+            }
+
+            X11ENGINE_TARGET_AVX512 void SampleNearest(const TextureLevel& l, const float* u, const float* v, std::size_t count, uint32_t* out) {
+                std::size_t i = 0;
+                for (; i + 16 <= count; i += 16)
+                    _mm512_storeu_si512(out + i, NearestTexels16(l, _mm512_loadu_ps(u + i), _mm512_loadu_ps(v + i)));
+                if (i < count)
+                    avx2::SampleNearest(l, u + i, v + i, count - i, out + i);
+            }
+
+            X11ENGINE_TARGET_AVX512 void SampleSpanNearest(const TextureLevel& l, const TextureSpan& s, int count, uint32_t* out) {
+                const __m512 lane = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+                int i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m512 index = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(i)), lane);
+                    __m512 q = _mm512_add_ps(_mm512_set1_ps(s.oneOverW), _mm512_mul_ps(index, _mm512_set1_ps(s.oneOverWStep)));
+                    __m512 u = _mm512_div_ps(_mm512_add_ps(_mm512_set1_ps(s.uOverW), _mm512_mul_ps(index, _mm512_set1_ps(s.uOverWStep))), q);
+                    __m512 v = _mm512_div_ps(_mm512_add_ps(_mm512_set1_ps(s.vOverW), _mm512_mul_ps(index, _mm512_set1_ps(s.vOverWStep))), q);
+                    _mm512_storeu_si512(out + i, NearestTexels16(l, u, v));
+                }
+
+                // The tail continues the span from pixel i
+                for (; i < count; ++i) {
+                    float index = static_cast<float>(i);
+                    float q = s.oneOverW + index * s.oneOverWStep;
+                    out[i] = SampleNearestScalar(l, (s.uOverW + index * s.uOverWStep) / q, (s.vOverW + index * s.vOverWStep) / q);
+                }
+            }
+
+        } // namespace avx512
+
+        uint64_t ReadXcr0() {
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return (static_cast<uint64_t>(edx) << 32) | eax;
+        }
+
+        KernelTable BuildTable() {
+            CpuLevel level = DetectCpuLevel();
+
+            // Optional override, only ever lowers the level
+            if (const char* env = std::getenv("X11ENGINE_CPU")) {
+                CpuLevel requested = level;
+                if (std::strcmp(env, "sse2") == 0)
+                    requested = CpuLevel::SSE2;
+                else if (std::strcmp(env, "avx2") == 0)
+                    requested = CpuLevel::AVX2;
+                else if (std::strcmp(env, "avx512") == 0)
+                    requested = CpuLevel::AVX512;
+                if (requested < level)
+                    level = requested;
+            }
+
+            switch (level) {
+                case CpuLevel::AVX512:
+                    // AVX-512F has no byte/word arithmetic (that is AVX-512BW): blending and sprite rows stay on the AVX2 kernels.
+                    // Line clipping and particles are bound by gathers and memory traffic, 16 lanes would not buy anything.
+                    // Tiled lines and the detile are the same: tiled offsets take several multiplies per lane, a tile row is 256 bits.
+                    // Post-processing rows need byte arithmetic (BW) too, and the LUT is bound by its gathers.
+                    // Bilinear texture filtering needs BW as well; nearest sampling is plain gathers and gets the 16-lane kernels.
+                    return {level, avx512::TransformPoints, avx2::ClipLines, avx512::Fill, avx512::Line, avx2::BlendFill, avx2::BlendLine, avx2::LineTiled, avx2::BlendLineTiled, avx2::CopyRow, avx2::KeyRow, avx2::AlphaRow, avx2::DetileRow, avx2::LutRow, avx2::VignetteRow, avx2::SmoothRow, avx2::IntegrateParticles, avx2::ProjectParticles, avx2::SinCos, avx512::SampleNearest, avx2::SampleBilinear, avx512::SampleSpanNearest, avx2::SampleSpanBilinear};
+                case CpuLevel::AVX2:
+                    return {level, avx2::TransformPoints, avx2::ClipLines, avx2::Fill, avx2::Line, avx2::BlendFill, avx2::BlendLine, avx2::LineTiled, avx2::BlendLineTiled, avx2::CopyRow, avx2::KeyRow, avx2::AlphaRow, avx2::DetileRow, avx2::LutRow, avx2::VignetteRow, avx2::SmoothRow, avx2::IntegrateParticles, avx2::ProjectParticles, avx2::SinCos, avx2::SampleNearest, avx2::SampleBilinear, avx2::SampleSpanNearest, avx2::SampleSpanBilinear};
+                default:
+                    return {CpuLevel::SSE2, sse2::TransformPoints, sse2::ClipLines, sse2::Fill, sse2::Line, sse2::BlendFill, sse2::BlendLine, sse2::LineTiled, sse2::BlendLineTiled, sse2::CopyRow, sse2::KeyRow, sse2::AlphaRow, sse2::DetileRow, sse2::LutRow, sse2::VignetteRow, sse2::SmoothRow, sse2::IntegrateParticles, sse2::ProjectParticles, sse2::SinCos, sse2::SampleNearest, sse2::SampleBilinear, sse2::SampleSpanNearest, sse2::SampleSpanBilinear};
+            }
+        }
+    } // namespace
+
+    CpuLevel DetectCpuLevel() noexcept {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            return CpuLevel::SSE2;
+
+        bool osxsave = ecx & bit_OSXSAVE;
+        bool fma = ecx & bit_FMA;
+        if (!osxsave || !(ecx & bit_AVX))
+            return CpuLevel::SSE2;
+
+        // The OS must save the wide registers on context switches
+        uint64_t xcr0 = ReadXcr0();
+        bool ymmState = (xcr0 & 0x6) == 0x6;
+        bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+            return CpuLevel::SSE2;
+
+        bool avx2 = ebx & bit_AVX2;
+        bool avx512f = ebx & bit_AVX512F;
+
+        if (avx512f && avx2 && fma && zmmState)
+            return CpuLevel::AVX512;
+        if (avx2 && fma && ymmState)
+            return CpuLevel::AVX2;
+        return CpuLevel::SSE2;
+    }
+
+    const char* GetCpuLevelName(CpuLevel level) noexcept {
+        switch (level) {
+            case CpuLevel::AVX512:
+                return "AVX-512";
+            case CpuLevel::AVX2:
+                return "AVX2";
+            default:
+                return "SSE2";
+        }
+    }
+
+    const KernelTable& Get() noexcept {
+        // Resolved once, on first use (thread-safe static initialization)
+        static const KernelTable table = BuildTable();
+        return table;
+    }
+
+    void EulerToQuats(const math::Vec3* angles, math::Quat* out, std::size_t count) noexcept {
+        // Half angles are processed in fixed chunks on the stack: no allocation
+        constexpr std::size_t CHUNK = 64;
+        float half[CHUNK * 3], s[CHUNK * 3], c[CHUNK * 3];
+        const KernelTable& table = Get();
+
+        for (std::size_t base = 0; base < count; base += CHUNK) {
+            std::size_t n = std::min(CHUNK, count - base);
+            for (std::size_t i = 0; i < n; ++i) {
+                half[i] = angles[base + i].x * 0.5f;
+                half[CHUNK + i] = angles[base + i].y * 0.5f;
+                half[2 * CHUNK + i] = angles[base + i].z * 0.5f;
+            }
+
+            for (int axis = 0; axis < 3; ++axis)
+                table.sincos(half + axis * CHUNK, s + axis * CHUNK, c + axis * CHUNK, n);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                float sx = s[i], sy = s[CHUNK + i], sz = s[2 * CHUNK + i];
+                float cx = c[i], cy = c[CHUNK + i], cz = c[2 * CHUNK + i];
+                out[base + i] = {sx * cy * cz - cx * sy * sz, cx * sy * cz + sx * cy * sz, cx * cy * sz - sx * sy * cz, cx * cy * cz + sx * sy * sz};
+            }
+        }
+    }
+
+} // namespace x11engine::kernels
@@ -0,0 +1,35 @@
+#include "x11engine/memory.hpp"
+
+#include <cstdlib>
+#include <sys/mman.h>
+
+namespace x11engine::memory {
+
+    void* AllocateAligned(std::size_t bytes, std::size_t alignment, bool hugePages) noexcept {
+        if (bytes == 0)
+            return nullptr;
+
+        if (alignment < CACHE_LINE)
+            alignment = CACHE_LINE;
+
+        // Huge pages only pay off when the block spans at least one of them
+        bool useHuge = hugePages && bytes >= HUGE_PAGE;
+        if (useHuge)
+            alignment = HUGE_PAGE;
+
+        // aligned_alloc requires the size to be a multiple of the alignment
+        std::size_t size = AlignUp(bytes, alignment);
+        void* ptr = std::aligned_alloc(alignment, size);
+        if (!ptr)
+            return nullptr;
+
+        // Advisory only: ignore failures (THP disabled, non-Linux kernels, ...)
+        if (useHuge)
+            madvise(ptr, size, MADV_HUGEPAGE);
+
+        return ptr;
+    }
+
+    void FreeAligned(void* ptr) noexcept { std::free(ptr); }
+
+} // namespace x11engine::memory
@@ -0,0 +1,343 @@
+#include "x11engine/mesh.hpp"
+#include "x11engine/memory.hpp"
+#include "x11engine/input.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace x11engine::objects {
+
+    namespace {
+        constexpr std::size_t ARRAY_ALIGNMENT = memory::CACHE_LINE;
+
+        // Checks that [offset, offset + count * stride) is inside the file and suitably aligned
+        bool ValidRange(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize) {
+            if (offset % alignof(float) != 0 || offset > fileSize)
+                return false;
+            return count <= (fileSize - offset) / stride;
+        }
+
+        uint64_t EdgeKey(int a, int b) { return (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint32_t>(std::max(a, b)); }
+
+        // Packs a grid cell into a hash key (21 bits per axis is plenty for unit-scale meshes)
+        uint64_t CellKey(int64_t x, int64_t y, int64_t z) {
+            constexpr uint64_t mask = (1u << 21) - 1;
+            return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) | ((static_cast<uint64_t>(z) & mask) << 42);
+        }
+
+        // Maps every vertex to the first vertex within 'epsilon' of it (itself if none)
+        std::vector<int> WeldVertices(const std::vector<Vec3>& vertices, float epsilon) {
+            std::vector<int> remap(vertices.size());
+            std::unordered_map<uint64_t, std::vector<int>> grid;
+            float invCell = 1.0f / epsilon;
+            float epsilonSq = epsilon * epsilon;
+
+            for (int i = 0; i < static_cast<int>(vertices.size()); ++i) {
+                const Vec3& v = vertices[i];
+                int64_t cx = static_cast<int64_t>(std::floor(v.x * invCell));
+                int64_t cy = static_cast<int64_t>(std::floor(v.y * invCell));
+                int64_t cz = static_cast<int64_t>(std::floor(v.z * invCell));
+
+                // Cells are epsilon wide, so any match lies in one of the 27 neighbours
+                int match = i;
+                for (int dz = -1; dz <= 1 && match == i; ++dz) {
+                    for (int dy = -1; dy <= 1 && match == i; ++dy) {
+                        for (int dx = -1; dx <= 1 && match == i; ++dx) {
+                            auto it = grid.find(CellKey(cx + dx, cy + dy, cz + dz));
+                            if (it == grid.end())
+                                continue;
+                            for (int j : it->second) {
+                                Vec3 d = vertices[j] - v;
+                                if (math::dot(d, d) <= epsilonSq) {
+                                    match = j;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                remap[i] = match;
+                if (match == i)
+                    grid[CellKey(cx, cy, cz)].push_back(i);
+            }
+
+            return remap;
+        }
+    } // namespace
+
+    // --- Optimization ---
+
+    void OptimizeMesh(std::vector<Vec3>& vertices, std::vector<Edge>& edges, std::vector<Face>& faces, float weldEpsilon) {
+        int vertexCount = static_cast<int>(vertices.size());
+
+        // 1. Weld coincident vertices
+        std::vector<int> weld = WeldVertices(vertices, weldEpsilon);
+
+        // 2. Remap edges, dropping degenerate and duplicate ones
+        std::vector<Edge> cleanEdges;
+        cleanEdges.reserve(edges.size());
+        std::unordered_set<uint64_t> seen;
+        for (const Edge& e : edges) {
+            if (e[0] < 0 || e[1] < 0 || e[0] >= vertexCount || e[1] >= vertexCount)
+                continue;
+            int a = weld[e[0]];
+            int b = weld[e[1]];
+            if (a != b && seen.insert(EdgeKey(a, b)).second)
+                cleanEdges.push_back({a, b});
+        }
+
+        std::vector<Face> cleanFaces;
+        cleanFaces.reserve(faces.size());
+        for (const Face& f : faces) {
+            if (f[0] >= static_cast<uint32_t>(vertexCount) || f[1] >= static_cast<uint32_t>(vertexCount) || f[2] >= static_cast<uint32_t>(vertexCount))
+                continue;
+            Face w = {static_cast<uint32_t>(weld[f[0]]), static_cast<uint32_t>(weld[f[1]]), static_cast<uint32_t>(weld[f[2]])};
+            if (w[0] != w[1] && w[1] != w[2] && w[0] != w[2])
+                cleanFaces.push_back(w);
+        }
+
+        // 3. Vertex -> incident edges (CSR)
+        std::vector<int> adjStart(vertexCount + 1, 0);
+        for (const Edge& e : cleanEdges) {
+            adjStart[e[0] + 1]++;
+            adjStart[e[1] + 1]++;
+        }
+        for (int i = 0; i < vertexCount; ++i)
+            adjStart[i + 1] += adjStart[i];
+
+        std::vector<int> adjacency(adjStart[vertexCount]);
+        std::vector<int> cursor(adjStart.begin(), adjStart.end() - 1);
+        for (int i = 0; i < static_cast<int>(cleanEdges.size()); ++i) {
+            adjacency[cursor[cleanEdges[i][0]]++] = i;
+            adjacency[cursor[cleanEdges[i][1]]++] = i;
+        }
+
+        // 4. Greedy walks: keep following unused edges from the current vertex
+        std::vector<char> used(cleanEdges.size(), 0);
+        std::vector<int> next(adjStart.begin(), adjStart.end() - 1);
+        std::vector<Edge> orderedEdges;
+        orderedEdges.reserve(cleanEdges.size());
+
+        for (int start = 0; start < static_cast<int>(cleanEdges.size()); ++start) {
+            if (used[start])
+                continue;
+
+            int current = cleanEdges[start][0];
+            while (true) {
+                int edge = -1;
+                while (next[current] < adjStart[current + 1]) {
+                    int candidate = adjacency[next[current]++];
+                    if (!used[candidate]) {
+                        edge = candidate;
+                        break;
+                    }
+                }
+                if (edge < 0)
+                    break;
+
+                used[edge] = 1;
+                int other = cleanEdges[edge][0] == current ? cleanEdges[edge][1] : cleanEdges[edge][0];
+                orderedEdges.push_back({current, other});
+                current = other;
+            }
+        }
+
+        // 5. Renumber vertices by first use (edges first, then face-only vertices)
+        std::vector<int> newIndex(vertexCount, -1);
+        std::vector<Vec3> orderedVertices;
+        orderedVertices.reserve(vertexCount);
+        auto assign = [&](int old) {
+            if (newIndex[old] < 0) {
+                newIndex[old] = static_cast<int>(orderedVertices.size());
+                orderedVertices.push_back(vertices[old]);
+            }
+            return newIndex[old];
+        };
+
+        for (Edge& e : orderedEdges)
+            e = {assign(e[0]), assign(e[1])};
+        for (Face& f : cleanFaces)
+            f = {static_cast<uint32_t>(assign(f[0])), static_cast<uint32_t>(assign(f[1])), static_cast<uint32_t>(assign(f[2]))};
+
+        vertices = std::move(orderedVertices);
+        edges = std::move(orderedEdges);
+        faces = std::move(cleanFaces);
+    }
+
+    void OptimizeMesh(std::vector<Vec3>& vertices, std::vector<Edge>& edges, float weldEpsilon) {
+        std::vector<Face> faces;
+        OptimizeMesh(vertices, edges, faces, weldEpsilon);
+    }
+
+    // --- Writer ---
+
+    bool WriteMeshFile(const std::string& path, std::span<const Vec3> vertices, std::span<const Edge> edges, std::span<const Face> faces) {
+        MeshFileHeader header{};
+        header.magic = MESH_FILE_MAGIC;
+        header.version = MESH_FILE_VERSION;
+        header.vertexCount = static_cast<uint32_t>(vertices.size());
+        header.edgeCount = static_cast<uint32_t>(edges.size());
+        header.faceCount = static_cast<uint32_t>(faces.size());
+
+        // 1. Bounds
+        Vec3 lo = vertices.empty() ? Vec3{} : vertices[0];
+        Vec3 hi = lo;
+        for (const Vec3& v : vertices) {
+            for (int i = 0; i < 3; ++i) {
+                lo[i] = std::min(lo[i], v[i]);
+                hi[i] = std::max(hi[i], v[i]);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            header.boundsMin[i] = lo[i];
+            header.boundsMax[i] = hi[i];
+        }
+
+        // 2. Layout
+        header.vertexOffset = memory::AlignUp(sizeof(MeshFileHeader), ARRAY_ALIGNMENT);
+        header.edgeOffset = memory::AlignUp(header.vertexOffset + vertices.size_bytes(), ARRAY_ALIGNMENT);
+        header.faceOffset = memory::AlignUp(header.edgeOffset + edges.size_bytes(), ARRAY_ALIGNMENT);
+        header.fileSize = header.faceOffset + faces.size_bytes();
+
+        // 3. Write
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Failed to open mesh file for writing: " << path << std::endl;
+            return false;
+        }
+
+        auto writeAt = [&](uint64_t offset, const void* bytes, std::size_t count) {
+            static const char padding[ARRAY_ALIGNMENT] = {};
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(offset - position));
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(count));
+        };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(header.vertexOffset, vertices.data(), vertices.size_bytes());
+        writeAt(header.edgeOffset, edges.data(), edges.size_bytes());
+        writeAt(header.faceOffset, faces.data(), faces.size_bytes());
+
+        if (!file) {
+            std::cerr << "Failed to write mesh file: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // --- MappedMesh ---
+
+    MappedMesh::~MappedMesh() { Close(); }
+
+    MappedMesh::MappedMesh(MappedMesh&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), header(std::exchange(other.header, nullptr)) {}
+
+    MappedMesh& MappedMesh::operator=(MappedMesh&& other) noexcept {
+        if (this != &other) {
+            Close();
+            data = std::exchange(other.data, nullptr);
+            size = std::exchange(other.size, 0);
+            header = std::exchange(other.header, nullptr);
+        }
+        return *this;
+    }
+
+    bool MappedMesh::Open(const std::string& path) {
+        Close();
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Failed to open mesh file: " << path << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(MeshFileHeader)) {
+            std::cerr << "Mesh file is too small: " << path << std::endl;
+            close(fd);
+            return false;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        std::size_t fileSize = static_cast<std::size_t>(info.st_size);
+        void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Failed to map mesh file: " << path << std::endl;
+            return false;
+        }
+
+        data = static_cast<const std::byte*>(mapped);
+        size = fileSize;
+        header = reinterpret_cast<const MeshFileHeader*>(data);
+
+        // Only the header is validated; the arrays are used as-is without touching their pages
+        bool valid = header->magic == MESH_FILE_MAGIC && header->version == MESH_FILE_VERSION && header->fileSize <= size &&
+                     ValidRange(header->vertexOffset, header->vertexCount, sizeof(Vec3), size) && ValidRange(header->edgeOffset, header->edgeCount, sizeof(Edge), size) &&
+                     ValidRange(header->faceOffset, header->faceCount, sizeof(Face), size);
+
+        if (!valid) {
+            std::cerr << "Invalid mesh file: " << path << std::endl;
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedMesh::Close() {
+        if (data)
+            munmap(const_cast<std::byte*>(data), size);
+        data = nullptr;
+        size = 0;
+        header = nullptr;
+    }
+
+    std::span<const Vec3> MappedMesh::Vertices() const {
+        if (!header)
+            return {};
+        return {reinterpret_cast<const Vec3*>(data + header->vertexOffset), header->vertexCount};
+    }
+
+    std::span<const Edge> MappedMesh::Edges() const {
+        if (!header)
+            return {};
+        return {reinterpret_cast<const Edge*>(data + header->edgeOffset), header->edgeCount};
+    }
+
+    std::span<const Face> MappedMesh::Faces() const {
+        if (!header)
+            return {};
+        return {reinterpret_cast<const Face*>(data + header->faceOffset), header->faceCount};
+    }
+
+    // --- MeshObject ---
+
+    MeshObject::MeshObject(float x, float y, float z, float size, std::shared_ptr<const MappedMesh> mesh, uint32_t color) : Object3D(x, y, z, color), mesh(std::move(mesh)) {
+        scale = {size, size, size};
+    }
+
+    void MeshObject::Update(const Input&) {}
+
+    collision::Aabb MeshObject::GetLocalBounds() const {
+        if (!mesh || !mesh->IsOpen())
+            return Object3D::GetLocalBounds();
+        return {mesh->GetBoundsMin(), mesh->GetBoundsMax()};
+    }
+
+    void MeshObject::Prepare(const ViewContext& view, DrawList& out) const {
+        if (mesh && mesh->IsOpen())
+            DrawWireframe(view, out, mesh->Vertices(), mesh->Edges());
+    }
+
+} // namespace x11engine::objects
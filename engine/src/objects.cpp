@@ -1,110 +1,83 @@
 #include "x11engine/objects.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/mesh.hpp"
 #include "x11engine/renderer.hpp"
 #include "x11engine/input.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace x11engine::objects {
 
-    using math::Vec2;
     using math::Vec4;
 
+    // --- Object Implementation ---
+
+    void Object::Draw(Renderer& renderer, const Mat4& viewProj) {
+        static thread_local DrawList list;
+        list.Clear();
+        Prepare(MakeViewContext(viewProj, renderer.GetWidth(), renderer.GetHeight(), &lod), list);
+        renderer.DrawLines({0, 0, renderer.GetWidth(), renderer.GetHeight()}, list.lines, list.colors);
+        if (!list.lines.empty())
+            renderer.CountObjects(1);
+    }
+
     // --- Object3D Implementation ---
 
     Object3D::Object3D(float x, float y, float z, uint32_t color) : position{x, y, z}, rotation{0.0f, 0.0f, 0.0f}, scale{1.0f, 1.0f, 1.0f}, color(color) {}
 
     Mat4 Object3D::GetModelMatrix() const {
-        // 1. Scale
-        Mat4 matScale = Mat4::scale(scale.x, scale.y, scale.z);
+        // Translation * Rotation(Z * Y * X) * Scale, composed directly from a quaternion
+        math::Quat rot = math::Quat::fromEuler({math::radians(rotation.x), math::radians(rotation.y), math::radians(rotation.z)});
+        return math::composeTRS(position, rot, scale);
+    }
 
-        // 2. Rotation
-        Mat4 rotX = Mat4::rotationX(math::radians(rotation.x));
-        Mat4 rotY = Mat4::rotationY(math::radians(rotation.y));
-        Mat4 rotZ = Mat4::rotationZ(math::radians(rotation.z));
+    float Object3D::PixelsPerUnit(const ViewContext& view) const {
+        const Mat4& viewProj = view.viewProj;
 
-        Mat4 matRot = rotZ * rotY * rotX; // Z * Y * X
+        // Clip-space w of the center is its view depth
+        math::Vec4 center = viewProj * math::Vec4{position.x, position.y, position.z, 1.0f};
+        if (center.w <= 0.0f)
+            return 0.0f;
 
-        // 3. Translation
-        Mat4 matTrans = Mat4::translation(position.x, position.y, position.z);
+        // Row 1 of viewProj is the camera up axis scaled by the projection's focal length
+        float focal = math::length({viewProj.c0.y, viewProj.c1.y, viewProj.c2.y});
+        float maxScale = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
 
-        return matTrans * matRot * matScale;
+        return maxScale * focal * view.height * 0.5f / center.w;
     }
 
-    void Object3D::DrawWireframe(Renderer& renderer, const Mat4& viewProj, const std::vector<std::array<int, 2>>& edges) {
+    void Object3D::DrawWireframe(const ViewContext& view, DrawList& out, std::span<const Vec3> verts, std::span<const Edge> edges) const {
         Mat4 model = GetModelMatrix();
-        Mat4 mvp = viewProj * model;
-
-        // 1. Transform ALL vertices to Clip Space
-        std::vector<math::Vec4> clipSpaceVerts(vertices.size());
-        for (size_t i = 0; i < vertices.size(); ++i) {
-            clipSpaceVerts[i] = mvp * math::Vec4{vertices[i].x, vertices[i].y, vertices[i].z, 1.0f};
-        }
+        if (!IsVisible(view, model))
+            return;
+        Mat4 mvp = view.viewProj * model;
 
-        float halfW = renderer.GetWidth() * 0.5f;
-        float halfH = renderer.GetHeight() * 0.5f;
-        const float nearClip = 0.1f;
-
-        // Helper: Clip Space -> Screen Space
-        auto ToScreen = [&](const math::Vec4& v) -> math::Vec2 {
-            float invW = 1.0f / v.w;
-            return {(v.x * invW + 1.0f) * halfW, (1.0f - v.y * invW) * halfH};
-        };
-
-        // 2. Iterate over EDGES
-        for (const auto& edge : edges) {
-            int idx1 = edge[0];
-            int idx2 = edge[1];
-
-            // Safety check
-            if (idx1 >= clipSpaceVerts.size() || idx2 >= clipSpaceVerts.size())
-                continue;
-
-            math::Vec4 v1 = clipSpaceVerts[idx1];
-            math::Vec4 v2 = clipSpaceVerts[idx2];
-
-            bool v1In = v1.w >= nearClip;
-            bool v2In = v2.w >= nearClip;
-
-            // Both behind camera
-            if (!v1In && !v2In)
-                continue;
-
-            // Both visible
-            if (v1In && v2In) {
-                math::Vec2 p1 = ToScreen(v1);
-                math::Vec2 p2 = ToScreen(v2);
-                renderer.DrawLine((int)p1.x, (int)p1.y, (int)p2.x, (int)p2.y, color);
-                continue;
-            }
-
-            // One visible, one behind (Clipping)
-            if (!v1In) {
-                std::swap(v1, v2); // Ensure v1 is the visible one
-            }
+        // 1. Transform ALL vertices to Clip Space (scratch grows to the largest mesh, then stops allocating)
+        static thread_local std::vector<math::Vec4> clipSpaceVerts;
+        clipSpaceVerts.resize(verts.size());
+        kernels::Get().transformPoints(mvp, verts.data(), clipSpaceVerts.data(), verts.size());
 
-            // v1 is IN, v2 is OUT
-            float t = (nearClip - v1.w) / (v2.w - v1.w);
-            math::Vec4 vClipped = v1 + (v2 - v1) * t;
+        // 2. Clip and draw
+        DrawEdges(view, out, clipSpaceVerts, edges);
+    }
 
-            math::Vec2 p1 = ToScreen(v1);
-            math::Vec2 p2 = ToScreen(vClipped);
+    void Object3D::DrawEdges(const ViewContext& view, DrawList& out, std::span<const Vec4> clipSpaceVerts, std::span<const Edge> edges) const {
+        // Lines up to 4x the viewport's extent off-screen are left to the rasterizer's integer scissor: cheaper
+        // than clipping them exactly, and their pixel coordinates stay far from int overflow
+        const kernels::ClipViewport viewport{view.width * 0.5f, view.height * 0.5f, GUARD_BAND};
 
-            renderer.DrawLine((int)p1.x, (int)p1.y, (int)p2.x, (int)p2.y, color);
-        }
+        std::size_t first = out.lines.size();
+        out.lines.resize(first + edges.size());
+        std::size_t count = kernels::Get().clipLines(clipSpaceVerts.data(), clipSpaceVerts.size(), edges.data(), edges.size(), viewport, out.lines.data() + first);
+        out.lines.resize(first + count);
+        out.colors.resize(first + count, color);
     }
 
     // --- Cube Implementation ---
 
-    const std::vector<std::array<int, 2>> Cube::edges = {
-        {0, 1}, {1, 2}, {2, 3}, {3, 0}, // Bottom face
-        {4, 5}, {5, 6}, {6, 7}, {7, 4}, // Top face
-        {0, 4}, {1, 5}, {2, 6}, {3, 7}  // Connecting pillars
-    };
-
     Cube::Cube(float x, float y, float z, float size, uint32_t color) : Object3D(x, y, z, color) {
-        scale = {size, size, size};
-        // Unit Cube centered at 0,0,0
-        vertices = {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}};
+        scale = {size, size, size}; // Scale the unit cube (primitives::CUBE)
     }
 
     void Cube::Update(const Input& input) {
@@ -116,29 +89,12 @@ namespace x11engine::objects {
             rotation.y -= 360.0f;
     }
 
-    void Cube::Draw(Renderer& renderer, const Mat4& viewProj) { DrawWireframe(renderer, viewProj, edges); }
+    void Cube::Prepare(const ViewContext& view, DrawList& out) const { DrawWireframe(view, out, primitives::CUBE); }
 
     // --- TriangularPyramid Implementation ---
 
-    const std::vector<std::array<int, 2>> TriangularPyramid::edges = {
-        {0, 1}, {1, 2}, {2, 0}, // Base
-        {0, 3}, {1, 3}, {2, 3}  // Sides
-    };
-
     TriangularPyramid::TriangularPyramid(float x, float y, float z, float baseSize, float height, uint32_t color) : Object3D(x, y, z, color) {
-
         scale = {baseSize, height, baseSize};
-
-        // Equilateral triangle base math
-        float r = 0.5f;
-        float hOffset = std::sqrt(3.0f) * r * 0.5f;
-
-        vertices = {
-            {-0.5f, -0.5f, hOffset * 0.5f}, // 0: Base Left
-            {0.5f, -0.5f, hOffset * 0.5f},  // 1: Base Right
-            {0.0f, -0.5f, -hOffset},        // 2: Base Top (Back)
-            {0.0f, 0.5f, 0.0f}              // 3: Apex
-        };
     }
 
     void TriangularPyramid::Update(const Input& input) {
@@ -147,26 +103,12 @@ namespace x11engine::objects {
             rotation.y += 360.0f;
     }
 
-    void TriangularPyramid::Draw(Renderer& renderer, const Mat4& viewProj) { DrawWireframe(renderer, viewProj, edges); }
+    void TriangularPyramid::Prepare(const ViewContext& view, DrawList& out) const { DrawWireframe(view, out, primitives::TRIANGULAR_PYRAMID); }
 
     // --- SquarePyramid Implementation ---
 
-    const std::vector<std::array<int, 2>> SquarePyramid::edges = {
-        {0, 1}, {1, 2}, {2, 3}, {3, 0}, // Base
-        {0, 4}, {1, 4}, {2, 4}, {3, 4}  // Sides
-    };
-
     SquarePyramid::SquarePyramid(float x, float y, float z, float baseSize, float height, uint32_t color) : Object3D(x, y, z, color) {
-
         scale = {baseSize, height, baseSize};
-
-        vertices = {
-            {-0.5f, -0.5f, -0.5f}, // 0
-            {0.5f, -0.5f, -0.5f},  // 1
-            {0.5f, -0.5f, 0.5f},   // 2
-            {-0.5f, -0.5f, 0.5f},  // 3
-            {0.0f, 0.5f, 0.0f}     // 4 Apex
-        };
     }
 
     void SquarePyramid::Update(const Input& input) {
@@ -175,13 +117,42 @@ namespace x11engine::objects {
             rotation.y -= 360.0f;
     }
 
-    void SquarePyramid::Draw(Renderer& renderer, const Mat4& viewProj) { DrawWireframe(renderer, viewProj, edges); }
+    void SquarePyramid::Prepare(const ViewContext& view, DrawList& out) const { DrawWireframe(view, out, primitives::SQUARE_PYRAMID); }
 
     // --- Sphere Implementation ---
 
-    Sphere::Sphere(float x, float y, float z, float radius, int rings, int sectors, uint32_t color) : Object3D(x, y, z, color) {
-
+    SphereBase::SphereBase(float x, float y, float z, float radius, uint32_t color) : Object3D(x, y, z, color) {
         scale = {radius, radius, radius}; // Scale unit sphere to radius
+    }
+
+    void SphereBase::Update(const Input& input) {
+        // Simple rotation animation
+        rotation.x += 0.5f;
+        rotation.y -= 0.5f;
+        if (rotation.x > 360.0f)
+            rotation.x -= 360.0f;
+        if (rotation.y < -360.0f)
+            rotation.y += 360.0f;
+    }
+
+    TessellatedSphere::TessellatedSphere(float x, float y, float z, float radius, int rings, int sectors, uint32_t color) : SphereBase(x, y, z, radius, color) {
+        // Build the LOD chain, halving the tessellation per level
+        rings = std::max(rings, 2);
+        sectors = std::max(sectors, 3);
+        while (true) {
+            lods.push_back(BuildLevel(rings, sectors));
+
+            int nextRings = std::max(rings / 2, 2);
+            int nextSectors = std::max(sectors / 2, 3);
+            if (nextRings == rings && nextSectors == sectors)
+                break;
+            rings = nextRings;
+            sectors = nextSectors;
+        }
+    }
+
+    LodLevel TessellatedSphere::BuildLevel(int rings, int sectors) {
+        LodLevel level;
 
         // 1. Generate Vertices
         for (int r = 0; r <= rings; ++r) {
@@ -199,7 +170,7 @@ namespace x11engine::objects {
                 float vy = cosPhi;
                 float vz = sinTheta * sinPhi;
 
-                vertices.push_back({vx, vy, vz});
+                level.vertices.push_back({vx, vy, vz});
             }
         }
 
@@ -210,22 +181,26 @@ namespace x11engine::objects {
                 int next = current + 1;
                 int below = current + (sectors + 1);
 
-                sphereEdges.push_back({current, next});
-                sphereEdges.push_back({current, below});
+                level.edges.push_back({current, next});
+                level.edges.push_back({current, below});
             }
         }
-    }
 
-    void Sphere::Update(const Input& input) {
-        // Simple rotation animation
-        rotation.x += 0.5f;
-        rotation.y -= 0.5f;
-        if (rotation.x > 360.0f)
-            rotation.x -= 360.0f;
-        if (rotation.y < -360.0f)
-            rotation.y += 360.0f;
+        // 3. The grid duplicates the seam column and collapses each pole ring into one point:
+        //    weld them and drop the resulting zero-length and duplicate edges
+        OptimizeMesh(level.vertices, level.edges);
+
+        // 4. Depth of the widest facet's center below the unit sphere
+        // (half-angles: sectors span 2PI/sectors, rings span PI/rings)
+        level.error = primitives::UvSphereError(rings, sectors);
+
+        return level;
     }
 
-    void Sphere::Draw(Renderer& renderer, const Mat4& viewProj) { DrawWireframe(renderer, viewProj, sphereEdges); }
+    void TessellatedSphere::Prepare(const ViewContext& view, DrawList& out) const {
+        *view.lod = SelectLod(static_cast<int>(lods.size()), *view.lod, PixelsPerUnit(view), [&](int i) { return lods[i].error; });
+        const LodLevel& level = lods[*view.lod];
+        DrawWireframe(view, out, level.vertices, level.edges);
+    }
 
 } // namespace x11engine::objects
\ No newline at end of file
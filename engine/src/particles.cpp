@@ -0,0 +1,259 @@
+#include "x11engine/particles.hpp"
+#include "x11engine/jobs.hpp"
+#include "x11engine/objects.hpp"
+#include "x11engine/renderer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace x11engine::objects {
+
+    namespace {
+        uint32_t Lerp(uint32_t a, uint32_t b, uint32_t t) {
+            uint32_t out = 0;
+            for (int shift = 0; shift <= 16; shift += 8) {
+                int ca = (a >> shift) & 0xFF;
+                int cb = (b >> shift) & 0xFF;
+                out |= static_cast<uint32_t>(ca + (cb - ca) * static_cast<int>(t) / 255) << shift;
+            }
+            return out;
+        }
+    } // namespace
+
+    ParticleSystem::ParticleSystem(std::size_t capacity)
+        : capacity(std::min<std::size_t>(capacity, std::numeric_limits<uint32_t>::max())), count(0), acceleration{0.0f, 0.0f, 0.0f}, drag(0.0f), seed(0x9E3779B9u), bandStart{} {
+        // Everything is sized once here, Update and Draw never allocate
+        for (std::vector<float>* stream : {&px, &py, &pz, &vx, &vy, &vz, &life, &invLifetime})
+            stream->resize(this->capacity);
+        emitterOf.resize(this->capacity);
+
+        offsets.resize(this->capacity);
+        bandOffsets.resize(this->capacity);
+        bandColors.resize(this->capacity);
+        chunkBands.resize((this->capacity + CHUNK - 1) / CHUNK * BANDS);
+    }
+
+    int ParticleSystem::AddEmitter(const EmitterConfig& config) {
+        // Particles record their emitter as uint16_t
+        if (emitters.size() > std::numeric_limits<uint16_t>::max()) {
+            std::cerr << "Particle system is full (" << emitters.size() << " emitters)" << std::endl;
+            return -1;
+        }
+        emitters.push_back({config});
+        return static_cast<int>(emitters.size()) - 1;
+    }
+
+    void ParticleSystem::Burst(int emitter, std::size_t spawnCount) {
+        if (emitter >= 0 && static_cast<std::size_t>(emitter) < emitters.size())
+            emitters[emitter].bursts += spawnCount;
+    }
+
+    float ParticleSystem::Random() {
+        // xorshift32, top 24 bits as a float
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return static_cast<float>(seed >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
+    void ParticleSystem::Spawn(int emitter, std::size_t spawnCount) {
+        const EmitterConfig& config = emitters[emitter].config;
+        spawnCount = std::min(spawnCount, capacity - count);
+
+        for (std::size_t n = 0; n < spawnCount; ++n) {
+            std::size_t i = count++;
+            px[i] = config.position.x;
+            py[i] = config.position.y;
+            pz[i] = config.position.z;
+            vx[i] = config.velocity.x + config.spread * Random();
+            vy[i] = config.velocity.y + config.spread * Random();
+            vz[i] = config.velocity.z + config.spread * Random();
+            life[i] = std::max(config.lifetime * (1.0f + config.lifetimeJitter * Random()), 1e-3f);
+            invLifetime[i] = 1.0f / life[i];
+            emitterOf[i] = static_cast<uint16_t>(emitter);
+        }
+    }
+
+    void ParticleSystem::Compact() {
+        // Swap-remove: the last live particle fills each hole
+        std::size_t i = 0;
+        while (i < count) {
+            if (life[i] > 0.0f) {
+                ++i;
+                continue;
+            }
+            std::size_t last = --count;
+            px[i] = px[last];
+            py[i] = py[last];
+            pz[i] = pz[last];
+            vx[i] = vx[last];
+            vy[i] = vy[last];
+            vz[i] = vz[last];
+            life[i] = life[last];
+            invLifetime[i] = invLifetime[last];
+            emitterOf[i] = emitterOf[last];
+        }
+    }
+
+    void ParticleSystem::Update(float dt, ThreadPool* jobs) {
+        // 1. Emit (serial, the RNG sequence must not depend on the thread count)
+        for (std::size_t e = 0; e < emitters.size(); ++e) {
+            Emitter& emitter = emitters[e];
+            emitter.pending += emitter.config.rate * dt;
+            std::size_t spawnCount = static_cast<std::size_t>(emitter.pending);
+            emitter.pending -= static_cast<float>(spawnCount);
+            Spawn(static_cast<int>(e), spawnCount + emitter.bursts);
+            emitter.bursts = 0;
+        }
+
+        // 2. Integrate
+        const kernels::KernelTable& k = kernels::Get();
+        const kernels::ParticleStep step{dt, std::pow(std::clamp(1.0f - drag, 0.0f, 1.0f), dt), acceleration.x * dt, acceleration.y * dt, acceleration.z * dt};
+        const kernels::ParticleStreams streams = Streams();
+
+        std::size_t dead = 0;
+        if (jobs) {
+            std::atomic<std::size_t> deadCount{0};
+            jobs->ParallelFor(count, CHUNK, [&](std::size_t begin, std::size_t end) { deadCount.fetch_add(k.integrateParticles(streams, begin, end, step), std::memory_order_relaxed); });
+            dead = deadCount.load(std::memory_order_relaxed);
+        } else {
+            dead = k.integrateParticles(streams, 0, count, step);
+        }
+
+        // 3. Remove the dead
+        if (dead > 0)
+            Compact();
+    }
+
+    uint32_t ParticleSystem::ColorOf(std::size_t i) const {
+        float age = std::clamp(1.0f - life[i] * invLifetime[i], 0.0f, 1.0f);
+        return emitters[emitterOf[i]].gradient[static_cast<std::size_t>(age * (GRADIENT_STEPS - 1))];
+    }
+
+    void ParticleSystem::Draw(Renderer& renderer, const Mat4& viewProj, ThreadPool* jobs, ParticleStyle style, float streakTime) {
+        if (count == 0)
+            return;
+
+        // Emitter colors may have changed through GetEmitter
+        for (Emitter& emitter : emitters) {
+            for (uint32_t t = 0; t < GRADIENT_STEPS; ++t)
+                emitter.gradient[t] = Lerp(emitter.config.colorStart, emitter.config.colorEnd, t * 255 / (GRADIENT_STEPS - 1));
+        }
+
+        if (style == ParticleStyle::Streaks)
+            DrawStreaks(renderer, viewProj, streakTime);
+        else
+            DrawPoints(renderer, viewProj, jobs);
+    }
+
+    void ParticleSystem::DrawPoints(Renderer& renderer, const Mat4& viewProj, ThreadPool* jobs) {
+        const kernels::KernelTable& k = kernels::Get();
+        const int width = renderer.GetWidth();
+        const int height = renderer.GetHeight();
+        const kernels::ClipViewport viewport{width * 0.5f, height * 0.5f, 1.0f};
+        uint32_t* framebuffer = renderer.GetFramebuffer();
+
+        // Projected offsets are linear (and so are the bands below); a tiled target is addressed at the write
+        const bool tiled = renderer.GetLayout() == FramebufferLayout::Tiled;
+        auto pixel = [&](uint32_t offset) -> uint32_t& {
+            return tiled ? framebuffer[renderer.GetPixelOffset(static_cast<int>(offset % width), static_cast<int>(offset / width))] : framebuffer[offset];
+        };
+
+        if (!jobs || jobs->GetThreadCount() == 1) {
+            k.projectParticles(viewProj, px.data(), py.data(), pz.data(), count, viewport, width, height, offsets.data());
+            std::size_t visible = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (offsets[i] != kernels::PARTICLE_CULLED) {
+                    pixel(offsets[i]) = ColorOf(i);
+                    visible++;
+                }
+            }
+            renderer.CountPixels(visible);
+            return;
+        }
+
+        // Threads can't write the framebuffer straight from their chunks: two particles on one pixel would race.
+        // The points are regrouped into row bands instead (a counting sort that keeps particle order), then each band is written by one thread.
+        const std::size_t rowsPerBand = (static_cast<std::size_t>(height) + BANDS - 1) / BANDS;
+        const std::size_t bandPixels = std::max<std::size_t>(rowsPerBand * static_cast<std::size_t>(width), 1);
+        const std::size_t chunks = (count + CHUNK - 1) / CHUNK;
+
+        // 1. Project and count each chunk's points per band
+        jobs->ParallelFor(count, CHUNK, [&](std::size_t begin, std::size_t end) {
+            k.projectParticles(viewProj, px.data() + begin, py.data() + begin, pz.data() + begin, end - begin, viewport, width, height, offsets.data() + begin);
+
+            uint32_t* counts = chunkBands.data() + begin / CHUNK * BANDS;
+            std::fill_n(counts, BANDS, 0u);
+            for (std::size_t i = begin; i < end; ++i) {
+                if (offsets[i] != kernels::PARTICLE_CULLED)
+                    counts[offsets[i] / bandPixels]++;
+            }
+        });
+
+        // 2. Band-major prefix sums: within a band, chunks (and so particles) stay in order
+        std::size_t total = 0;
+        for (std::size_t band = 0; band < BANDS; ++band) {
+            bandStart[band] = total;
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                uint32_t& slot = chunkBands[chunk * BANDS + band];
+                uint32_t bandCount = slot;
+                slot = static_cast<uint32_t>(total);
+                total += bandCount;
+            }
+        }
+        bandStart[BANDS] = total;
+
+        // 3. Scatter the visible points with their colors
+        jobs->ParallelFor(count, CHUNK, [&](std::size_t begin, std::size_t end) {
+            uint32_t* cursors = chunkBands.data() + begin / CHUNK * BANDS;
+            for (std::size_t i = begin; i < end; ++i) {
+                uint32_t offset = offsets[i];
+                if (offset == kernels::PARTICLE_CULLED)
+                    continue;
+                uint32_t slot = cursors[offset / bandPixels]++;
+                bandOffsets[slot] = offset;
+                bandColors[slot] = ColorOf(i);
+            }
+        });
+
+        // 4. Write
+        jobs->ParallelFor(BANDS, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = bandStart[begin]; j < bandStart[end]; ++j)
+                pixel(bandOffsets[j]) = bandColors[j];
+        });
+        renderer.CountPixels(total);
+    }
+
+    void ParticleSystem::DrawStreaks(Renderer& renderer, const Mat4& viewProj, float streakTime) {
+        static constexpr std::size_t BATCH = 256;
+        static constexpr Edge STREAK = {0, 1};
+
+        const kernels::KernelTable& k = kernels::Get();
+        const kernels::ClipViewport viewport{renderer.GetWidth() * 0.5f, renderer.GetHeight() * 0.5f, GUARD_BAND};
+
+        Vec3 ends[BATCH * 2];
+        Vec4 clipSpace[BATCH * 2];
+        for (std::size_t base = 0; base < count; base += BATCH) {
+            std::size_t n = std::min(BATCH, count - base);
+
+            // 1. Head at the particle, tail where it was 'streakTime' ago
+            for (std::size_t j = 0; j < n; ++j) {
+                std::size_t i = base + j;
+                ends[j * 2] = {px[i], py[i], pz[i]};
+                ends[j * 2 + 1] = {px[i] - vx[i] * streakTime, py[i] - vy[i] * streakTime, pz[i] - vz[i] * streakTime};
+            }
+            k.transformPoints(viewProj, ends, clipSpace, n * 2);
+
+            // 2. Clip one streak at a time so each keeps its own color
+            for (std::size_t j = 0; j < n; ++j) {
+                kernels::ScreenLine line;
+                if (k.clipLines(clipSpace + j * 2, 2, &STREAK, 1, viewport, &line))
+                    renderer.DrawLine(line.x0, line.y0, line.x1, line.y1, ColorOf(base + j));
+            }
+        }
+    }
+
+} // namespace x11engine::objects
@@ -0,0 +1,269 @@
+#include "x11engine/pixelformat.hpp"
+#include "x11engine/kernels.hpp"
+#include "cpu_target.hpp"
+
+#include <X11/Xutil.h>
+#include <bit>
+#include <cstring>
+#include <emmintrin.h>
+#include <immintrin.h>
+#include <iostream>
+
+namespace x11engine {
+
+    namespace {
+        // --- Byte swaps (server byte order differs from ours) ---
+
+        inline __m128i Swap32(__m128i v) {
+            v = _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));
+            const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+            return _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask), 8), _mm_and_si128(_mm_srli_epi32(v, 8), mask));
+        }
+
+        inline __m128i Swap16(__m128i v) { return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)); }
+
+        // --- Per-format pixel packing (4 pixels in 32-bit lanes, plus a scalar twin for tails) ---
+
+        template <PixelFormat F>
+        inline __m128i Pack4(__m128i p) {
+            if constexpr (F == PixelFormat::XBGR8888) {
+                const __m128i keep = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+                const __m128i low = _mm_set1_epi32(0xFF);
+                __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+                __m128i b = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+                return _mm_or_si128(_mm_and_si128(p, keep), _mm_or_si128(r, b));
+            } else if constexpr (F == PixelFormat::RGB565) {
+                __m128i r = _mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0xF800));
+                __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07E0));
+                __m128i b = _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001F));
+                return _mm_or_si128(r, _mm_or_si128(g, b));
+            } else if constexpr (F == PixelFormat::RGB555) {
+                __m128i r = _mm_and_si128(_mm_srli_epi32(p, 9), _mm_set1_epi32(0x7C00));
+                __m128i g = _mm_and_si128(_mm_srli_epi32(p, 6), _mm_set1_epi32(0x03E0));
+                __m128i b = _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001F));
+                return _mm_or_si128(r, _mm_or_si128(g, b));
+            } else {
+                return p;
+            }
+        }
+
+        template <PixelFormat F>
+        inline uint32_t Pack1(uint32_t p) {
+            if constexpr (F == PixelFormat::XBGR8888)
+                return (p & 0xFF00FF00) | ((p >> 16) & 0xFF) | ((p & 0xFF) << 16);
+            else if constexpr (F == PixelFormat::RGB565)
+                return ((p >> 8) & 0xF800) | ((p >> 5) & 0x07E0) | ((p >> 3) & 0x001F);
+            else if constexpr (F == PixelFormat::RGB555)
+                return ((p >> 9) & 0x7C00) | ((p >> 6) & 0x03E0) | ((p >> 3) & 0x001F);
+            else
+                return p;
+        }
+
+        // --- Row converters, specialized per format and byte order ---
+
+        template <PixelFormat F, bool Swap>
+        void ConvertRow32(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo&) {
+            int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m128i p = Pack4<F>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                if constexpr (Swap)
+                    p = Swap32(p);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), p);
+            }
+            for (; i < count; ++i) {
+                uint32_t p = Pack1<F>(src[i]);
+                if constexpr (Swap)
+                    p = __builtin_bswap32(p);
+                std::memcpy(dst + i * 4, &p, 4);
+            }
+        }
+
+        template <PixelFormat F, bool Swap>
+        void ConvertRow16(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo&) {
+            int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m128i a = Pack4<F>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                __m128i b = Pack4<F>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)));
+
+                // Sign-extend the low halves so the saturating pack keeps them bit-exact
+                a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+                b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+                __m128i p = _mm_packs_epi32(a, b);
+                if constexpr (Swap)
+                    p = Swap16(p);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), p);
+            }
+            for (; i < count; ++i) {
+                uint16_t p = static_cast<uint16_t>(Pack1<F>(src[i]));
+                if constexpr (Swap)
+                    p = __builtin_bswap16(p);
+                std::memcpy(dst + i * 2, &p, 2);
+            }
+        }
+
+        // Packed 24bpp: 4 pixels become 3 words. With Swap the bytes go out as R, G, B.
+        template <bool Swap>
+        void ConvertRow24(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo&) {
+            auto order = [](uint32_t p) { return Swap ? Pack1<PixelFormat::XBGR8888>(p) : p; };
+
+            int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                uint32_t a = order(src[i]), b = order(src[i + 1]), c = order(src[i + 2]), d = order(src[i + 3]);
+                uint32_t words[3] = {(a & 0xFFFFFF) | (b << 24), ((b >> 8) & 0xFFFF) | (c << 16), ((c >> 16) & 0xFF) | (d << 8)};
+                std::memcpy(dst + i * 3, words, sizeof(words));
+            }
+            for (; i < count; ++i) {
+                uint32_t p = order(src[i]);
+                dst[i * 3 + 0] = p & 0xFF;
+                dst[i * 3 + 1] = (p >> 8) & 0xFF;
+                dst[i * 3 + 2] = (p >> 16) & 0xFF;
+            }
+        }
+
+        // Same output with byte shuffles: each group of 4 pixels drops its padding bytes (16 -> 12 bytes),
+        // four groups are stitched into three full stores. pshufb needs SSSE3, which every AVX2 CPU has.
+        template <bool Swap>
+        X11ENGINE_TARGET_AVX2 void ConvertRow24Shuffle(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo& info) {
+            const __m128i pack = Swap ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+                                      : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+            int i = 0;
+            for (; i + 16 <= count; i += 16) {
+                __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), pack);
+                __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), pack);
+                __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)), pack);
+                __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), pack);
+
+                uint8_t* out = dst + i * 3;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(a, _mm_slli_si128(b, 12)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+            }
+            ConvertRow24<Swap>(src + i, dst + i * 3, count - i, info);
+        }
+
+        // Scales an 8-bit channel into an arbitrary mask. Narrow channels truncate like the fast paths,
+        // wide ones (e.g. 10-bit deep color) are stretched to full range.
+        inline uint32_t ToMask(uint32_t channel, uint32_t mask) {
+            if (!mask)
+                return 0;
+            int shift = std::countr_zero(mask);
+            int bits = std::popcount(mask);
+            if (bits <= 8)
+                return (channel >> (8 - bits)) << shift;
+            return ((channel * (mask >> shift)) / 255) << shift;
+        }
+
+        void ConvertRowGeneric(const uint32_t* src, uint8_t* dst, int count, const PixelFormatInfo& info) {
+            int bytes = info.bitsPerPixel / 8;
+            for (int i = 0; i < count; ++i) {
+                uint32_t p = src[i];
+                uint32_t v = ToMask((p >> 16) & 0xFF, info.redMask) | ToMask((p >> 8) & 0xFF, info.greenMask) | ToMask(p & 0xFF, info.blueMask);
+
+                // Emit 'bytes' bytes in the server's order
+                for (int b = 0; b < bytes; ++b) {
+                    int shift = info.swapBytes ? (bytes - 1 - b) * 8 : b * 8;
+                    dst[i * bytes + b] = static_cast<uint8_t>(v >> shift);
+                }
+            }
+        }
+
+        void PixmapFormatForDepth(Display* display, int depth, int& bitsPerPixel, int& scanlinePad) {
+            int count = 0;
+            bitsPerPixel = 32;
+            scanlinePad = 32;
+            XPixmapFormatValues* formats = XListPixmapFormats(display, &count);
+            for (int i = 0; formats && i < count; ++i) {
+                if (formats[i].depth == depth) {
+                    bitsPerPixel = formats[i].bits_per_pixel;
+                    scanlinePad = formats[i].scanline_pad;
+                    break;
+                }
+            }
+            if (formats)
+                XFree(formats);
+        }
+    } // namespace
+
+    PixelFormatInfo DescribeVisual(Display* display, const Visual* visual, int depth) {
+        int bitsPerPixel, scanlinePad;
+        PixmapFormatForDepth(display, depth, bitsPerPixel, scanlinePad);
+        bool trueColor = visual->c_class == TrueColor || visual->c_class == DirectColor;
+        return DescribePixelFormat(depth, bitsPerPixel, scanlinePad, static_cast<uint32_t>(visual->red_mask), static_cast<uint32_t>(visual->green_mask),
+                                   static_cast<uint32_t>(visual->blue_mask), ImageByteOrder(display) == LSBFirst, trueColor);
+    }
+
+    PixelFormatInfo DescribePixelFormat(int depth, int bitsPerPixel, int scanlinePad, uint32_t redMask, uint32_t greenMask, uint32_t blueMask, bool serverLsb, bool trueColor) {
+        PixelFormatInfo info{};
+        info.depth = depth;
+        info.bitsPerPixel = bitsPerPixel;
+        info.scanlinePad = scanlinePad;
+        info.redMask = redMask;
+        info.greenMask = greenMask;
+        info.blueMask = blueMask;
+        info.swapBytes = info.bitsPerPixel > 8 && serverLsb != (std::endian::native == std::endian::little);
+
+        if (!trueColor) {
+            // Colormapped visuals would need a palette; keep the old behaviour and let the server cope
+            std::cerr << "Visual is not TrueColor, colors may be wrong" << std::endl;
+            info.format = PixelFormat::XRGB8888;
+            info.swapBytes = false;
+            return info;
+        }
+
+        auto masks = [&](uint32_t r, uint32_t g, uint32_t b) { return info.redMask == r && info.greenMask == g && info.blueMask == b; };
+
+        if (info.bitsPerPixel == 32 && masks(0xFF0000, 0x00FF00, 0x0000FF))
+            info.format = PixelFormat::XRGB8888;
+        else if (info.bitsPerPixel == 32 && masks(0x0000FF, 0x00FF00, 0xFF0000))
+            info.format = PixelFormat::XBGR8888;
+        else if (info.bitsPerPixel == 16 && masks(0xF800, 0x07E0, 0x001F))
+            info.format = PixelFormat::RGB565;
+        else if (info.bitsPerPixel == 16 && masks(0x7C00, 0x03E0, 0x001F))
+            info.format = PixelFormat::RGB555;
+        else if (info.bitsPerPixel == 24 && masks(0xFF0000, 0x00FF00, 0x0000FF))
+            info.format = PixelFormat::RGB888;
+        else
+            info.format = PixelFormat::Generic;
+
+        return info;
+    }
+
+    ConvertRowFn GetRowConverter(const PixelFormatInfo& info) {
+        bool swap = info.swapBytes;
+        switch (info.format) {
+            case PixelFormat::XRGB8888:
+                return swap ? ConvertRow32<PixelFormat::XRGB8888, true> : nullptr;
+            case PixelFormat::XBGR8888:
+                return swap ? ConvertRow32<PixelFormat::XBGR8888, true> : ConvertRow32<PixelFormat::XBGR8888, false>;
+            case PixelFormat::RGB565:
+                return swap ? ConvertRow16<PixelFormat::RGB565, true> : ConvertRow16<PixelFormat::RGB565, false>;
+            case PixelFormat::RGB555:
+                return swap ? ConvertRow16<PixelFormat::RGB555, true> : ConvertRow16<PixelFormat::RGB555, false>;
+            case PixelFormat::RGB888:
+                if (kernels::Get().level >= kernels::CpuLevel::AVX2)
+                    return swap ? ConvertRow24Shuffle<true> : ConvertRow24Shuffle<false>;
+                return swap ? ConvertRow24<true> : ConvertRow24<false>;
+            default:
+                return ConvertRowGeneric;
+        }
+    }
+
+    const char* GetPixelFormatName(PixelFormat format) {
+        switch (format) {
+            case PixelFormat::XRGB8888:
+                return "XRGB8888";
+            case PixelFormat::XBGR8888:
+                return "XBGR8888";
+            case PixelFormat::RGB565:
+                return "RGB565";
+            case PixelFormat::RGB555:
+                return "RGB555";
+            case PixelFormat::RGB888:
+                return "RGB888";
+            default:
+                return "Generic";
+        }
+    }
+
+} // namespace x11engine
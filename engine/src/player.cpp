@@ -5,15 +5,8 @@
 
 namespace x11engine::objects {
 
-    const std::vector<std::array<int, 2>> Player::edges = {
-        {0, 1}, {1, 2}, {2, 3}, {3, 0}, // Bottom face
-        {4, 5}, {5, 6}, {6, 7}, {7, 4}, // Top face
-        {0, 4}, {1, 5}, {2, 6}, {3, 7}  // Connecting pillars
-    };
-
     Player::Player(float x, float y, float z, float size, uint32_t color) : forward(0.0f, 0.0f, -1.0f), up(0.0f, 1.0f, 0.0f), Object3D(x, y, z, color) {
         scale = {size, size, size};
-        vertices = {{-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}};
     }
 
     void Player::Update(const Input& input) {
@@ -24,6 +17,8 @@ namespace x11engine::objects {
         // if (rotation.y >= 360.0f)
         //     rotation.y -= 360.0f;
 
+        previousPosition = position;
+
         // Movement (FPS Strafing)
         math::Vec3 flatForward = math::normalize({forward.x, 0.0f, forward.z});
         math::Vec3 rightVector = math::normalize(math::cross(flatForward, up));
@@ -43,6 +38,6 @@ namespace x11engine::objects {
             position -= rightVector * moveSpeed;
     }
 
-    void Player::Draw(Renderer& renderer, const Mat4& viewProj) { DrawWireframe(renderer, viewProj, edges); }
+    void Player::Prepare(const ViewContext& view, DrawList& out) const { DrawWireframe(view, out, primitives::CUBE); }
 
 } // namespace x11engine::objects
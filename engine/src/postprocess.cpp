@@ -0,0 +1,218 @@
+#include "x11engine/postprocess.hpp"
+#include "x11engine/jobs.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace x11engine {
+
+    namespace {
+        constexpr int MAX_LUMA = 4 * 255; // r + 2g + b
+
+        // Fraction -> 0..65535 factor for kernels::vignetteRow
+        inline uint16_t ToFactor(float f) { return static_cast<uint16_t>(std::lround(std::clamp(f, 0.0f, 1.0f) * 65535.0f)); }
+
+        // Separable falloff 1 - strength * d^2 with d in [-1, 1] from the center, sampled at pixel centers
+        inline float Falloff(int i, int size, float strength) {
+            float d = (i + 0.5f) / size * 2.0f - 1.0f;
+            return 1.0f - strength * d * d;
+        }
+    } // namespace
+
+    ColorCurves ColorCurves::Identity() {
+        ColorCurves curves;
+        for (int i = 0; i < 256; ++i)
+            curves.r[i] = curves.g[i] = curves.b[i] = static_cast<uint8_t>(i);
+        return curves;
+    }
+
+    void PostProcessor::AddGamma(float gamma) {
+        Effect effect{EffectType::Lut, {}, gamma};
+        for (int i = 0; i < 256; ++i) {
+            uint8_t v = static_cast<uint8_t>(std::lround(255.0f * std::pow(i / 255.0f, 1.0f / gamma)));
+            effect.curves[i] = effect.curves[256 + i] = effect.curves[512 + i] = v;
+        }
+        effects.push_back(effect);
+        dirty = true;
+    }
+
+    void PostProcessor::AddCurves(const ColorCurves& curves) {
+        Effect effect{EffectType::Lut, {}, 0.0f};
+        std::copy(curves.b.begin(), curves.b.end(), effect.curves.begin());
+        std::copy(curves.g.begin(), curves.g.end(), effect.curves.begin() + 256);
+        std::copy(curves.r.begin(), curves.r.end(), effect.curves.begin() + 512);
+        effects.push_back(effect);
+        dirty = true;
+    }
+
+    void PostProcessor::AddVignette(float strength) {
+        effects.push_back({EffectType::Vignette, {}, std::clamp(strength, 0.0f, 1.0f)});
+        dirty = true;
+    }
+
+    void PostProcessor::AddEdgeSmoothing(float threshold) {
+        effects.push_back({EffectType::Smooth, {}, threshold});
+        dirty = true;
+    }
+
+    void PostProcessor::Clear() {
+        effects.clear();
+        dirty = true;
+    }
+
+    void PostProcessor::Compile() {
+        ops.clear();
+        stages.clear();
+
+        Stage current{false, 0, 0, 0};
+        for (const Effect& effect : effects) {
+            if (effect.type == EffectType::Smooth) {
+                // Smoothing reads the rows around each pixel, which must already have been through everything before it
+                if (current.smooth || current.opCount > 0)
+                    stages.push_back(current);
+                current = {true, static_cast<int>(std::lround(std::clamp(effect.value, 0.0f, 1.0f) * MAX_LUMA)), ops.size(), 0};
+                continue;
+            }
+
+            // Back-to-back lookups compose into one: later[earlier[v]]
+            if (effect.type == EffectType::Lut && current.opCount > 0 && ops.back().type == EffectType::Lut) {
+                for (int i = 0; i < 768; ++i)
+                    ops.back().curves[i] = effect.curves[(i & ~0xFF) + ops.back().curves[i]];
+                continue;
+            }
+
+            ops.push_back({effect.type, effect.curves, {}, effect.value, {}, {}});
+            current.opCount++;
+        }
+        if (current.smooth || current.opCount > 0)
+            stages.push_back(current);
+
+        for (Op& op : ops) {
+            for (int i = 0; i < 768; ++i)
+                op.table[i] = static_cast<uint32_t>(op.curves[i]) << (8 * (i >> 8));
+        }
+
+        dirty = false;
+        width = 0; // Size tables of the new ops still need building
+    }
+
+    void PostProcessor::Resize(int newWidth, int newHeight) {
+        width = newWidth;
+        height = newHeight;
+
+        for (Op& op : ops) {
+            if (op.type != EffectType::Vignette)
+                continue;
+            op.columns.resize(static_cast<std::size_t>(width) * 4);
+            for (int x = 0; x < width; ++x)
+                std::fill_n(op.columns.begin() + 4 * x, 4, ToFactor(Falloff(x, width, op.strength)));
+            op.rows.resize(height);
+            for (int y = 0; y < height; ++y)
+                op.rows[y] = ToFactor(Falloff(y, height, op.strength));
+        }
+    }
+
+    void PostProcessor::Apply(Renderer& renderer, ThreadPool* jobs) {
+        if (effects.empty())
+            return;
+
+        // 1. Rebuild what changed
+        if (dirty)
+            Compile();
+        if (renderer.GetWidth() != width || renderer.GetHeight() != height)
+            Resize(renderer.GetWidth(), renderer.GetHeight());
+
+        if (width <= 0 || height <= 0)
+            return;
+
+        // 2. A couple of bands per thread balances rows of uneven cost. The band count is recomputed from the rounded-up
+        //    band height: 8 bands over 100 rows are 13 rows each, and the 8th would start past the last row.
+        std::size_t threads = jobs ? jobs->GetThreadCount() : 1;
+        std::size_t bands = std::min<std::size_t>(threads == 1 ? 1 : threads * 2, height);
+        std::size_t rowsPerBand = (height + bands - 1) / bands;
+        bands = (height + rowsPerBand - 1) / rowsPerBand;
+        if (scratch.size() < bands * BAND_ROWS * width)
+            scratch.resize(bands * BAND_ROWS * width);
+
+        for (const Stage& stage : stages) {
+            // 3. Smoothing works in place: save each band's outer neighbour rows before any band writes
+            if (stage.smooth) {
+                for (std::size_t band = 0; band < bands; ++band) {
+                    uint32_t* rows = scratch.data() + band * BAND_ROWS * width;
+                    int y0 = static_cast<int>(band * rowsPerBand);
+                    int y1 = std::min(static_cast<int>((band + 1) * rowsPerBand), height);
+                    if (y0 > 0)
+                        renderer.ReadRow(y0 - 1, rows + 4 * width);
+                    if (y1 < height)
+                        renderer.ReadRow(y1, rows + 5 * width);
+                }
+            }
+
+            auto run = [&](std::size_t begin, std::size_t end) {
+                for (std::size_t band = begin; band < end; ++band)
+                    RunBand(renderer, stage, band, static_cast<int>(band * rowsPerBand), std::min(static_cast<int>((band + 1) * rowsPerBand), height));
+            };
+            if (jobs && bands > 1)
+                jobs->ParallelFor(bands, 1, run);
+            else
+                run(0, bands);
+        }
+    }
+
+    void PostProcessor::RunOps(const Stage& stage, uint32_t* row, int y) const {
+        const kernels::KernelTable& k = kernels::Get();
+        for (std::size_t i = stage.firstOp; i < stage.firstOp + stage.opCount; ++i) {
+            const Op& op = ops[i];
+            if (op.type == EffectType::Lut)
+                k.lutRow(row, width, op.table.data());
+            else
+                k.vignetteRow(row, width, op.columns.data(), op.rows[y]);
+        }
+    }
+
+    void PostProcessor::RunBand(Renderer& renderer, const Stage& stage, std::size_t band, int y0, int y1) {
+        uint32_t* rows = scratch.data() + band * BAND_ROWS * width;
+        uint32_t* out = rows + 3 * width;
+
+        // 1. Per-pixel ops only: linear rows are processed in place, tiled rows through a copy
+        if (!stage.smooth) {
+            for (int y = y0; y < y1; ++y) {
+                if (uint32_t* row = renderer.GetLinearRow(y)) {
+                    RunOps(stage, row, y);
+                } else {
+                    renderer.ReadRow(y, out);
+                    RunOps(stage, out, y);
+                    renderer.WriteRow(y, out);
+                }
+            }
+            return;
+        }
+
+        // 2. Smoothing: a window of original rows slides down the band. Rows outside the band come from the saved
+        //    borders, the image edges repeat themselves.
+        const kernels::KernelTable& k = kernels::Get();
+        uint32_t* window[3] = {rows, rows + width, rows + 2 * width};
+        const std::size_t rowBytes = static_cast<std::size_t>(width) * sizeof(uint32_t);
+
+        renderer.ReadRow(y0, window[1]);
+        std::memcpy(window[0], y0 > 0 ? rows + 4 * width : window[1], rowBytes);
+        for (int y = y0; y < y1; ++y) {
+            if (y + 1 >= height)
+                std::memcpy(window[2], window[1], rowBytes);
+            else if (y + 1 < y1)
+                renderer.ReadRow(y + 1, window[2]);
+            else
+                std::memcpy(window[2], rows + 5 * width, rowBytes);
+
+            k.smoothRow(out, window[0], window[1], window[2], width, stage.threshold);
+            RunOps(stage, out, y);
+            renderer.WriteRow(y, out);
+
+            std::rotate(window, window + 1, window + 3);
+        }
+    }
+
+} // namespace x11engine
@@ -0,0 +1,123 @@
+#include "x11engine/profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <time.h>
+
+namespace x11engine {
+
+    double Profiler::Now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+    }
+
+    void Profiler::BeginFrame() {
+        current = {};
+        current.frame = frames;
+        frameAllocStart = memory::GetThreadAllocations();
+        frameStart = Now();
+    }
+
+    void Profiler::EndFrame() {
+        current.total = Now() - frameStart;
+        current.allocations = memory::GetThreadAllocations() - frameAllocStart;
+        last = current;
+        frames++;
+    }
+
+    void Profiler::BeginPhase(FramePhase phase) {
+        std::size_t i = static_cast<std::size_t>(phase);
+        phaseAllocStart[i] = memory::GetThreadAllocations();
+        phaseStart[i] = Now();
+    }
+
+    void Profiler::EndPhase(FramePhase phase) {
+        std::size_t i = static_cast<std::size_t>(phase);
+        current.phases[i] += Now() - phaseStart[i];
+        current.phaseAllocations[i] += memory::GetThreadAllocations() - phaseAllocStart[i];
+    }
+
+    void Profiler::RecordInputLatency(double seconds) {
+        current.inputEvents++;
+        current.inputLatency = std::max(current.inputLatency, seconds);
+        inputLatency.Record(seconds);
+    }
+
+    void LatencyHistogram::Record(double seconds) {
+        if (!(seconds >= 0.0))
+            seconds = 0.0;
+
+        // Bucket i > 0 covers [MIN_LATENCY * 2^((i - 1) / STEPS), MIN_LATENCY * 2^(i / STEPS))
+        std::size_t bucket = 0;
+        if (seconds >= MIN_LATENCY) {
+            double index = std::floor(std::log2(seconds / MIN_LATENCY) * STEPS_PER_DOUBLING) + 1.0;
+            bucket = index < static_cast<double>(BUCKETS - 1) ? static_cast<std::size_t>(index) : BUCKETS - 1;
+        }
+        buckets[bucket]++;
+        count++;
+        sum += seconds;
+        max = std::max(max, seconds);
+    }
+
+    double LatencyHistogram::Percentile(const std::array<uint64_t, BUCKETS>& buckets, double p) {
+        uint64_t total = std::accumulate(buckets.begin(), buckets.end(), uint64_t{0});
+        if (total == 0)
+            return 0.0;
+
+        uint64_t rank = std::clamp<uint64_t>(static_cast<uint64_t>(std::ceil(p * total)), 1, total);
+        uint64_t seen = 0;
+        std::size_t i = 0;
+        for (; i < BUCKETS - 1; ++i) {
+            seen += buckets[i];
+            if (seen >= rank)
+                break;
+        }
+        return GetBucketUpperEdge(i);
+    }
+
+    double LatencyHistogram::GetBucketUpperEdge(std::size_t bucket) {
+        if (bucket >= BUCKETS - 1)
+            return std::numeric_limits<double>::infinity();
+        return MIN_LATENCY * std::exp2(static_cast<double>(bucket) / STEPS_PER_DOUBLING);
+    }
+
+    TimingSummary Summarize(std::vector<double>& samples) {
+        if (samples.empty())
+            return {};
+
+        std::sort(samples.begin(), samples.end());
+        auto rank = [&](double p) {
+            std::size_t index = static_cast<std::size_t>(std::ceil(p * samples.size()));
+            return samples[std::clamp<std::size_t>(index, 1, samples.size()) - 1];
+        };
+
+        TimingSummary summary;
+        summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        summary.p50 = rank(0.50);
+        summary.p95 = rank(0.95);
+        summary.p99 = rank(0.99);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    const char* GetFramePhaseName(FramePhase phase) {
+        switch (phase) {
+            case FramePhase::Events:
+                return "events";
+            case FramePhase::Update:
+                return "update";
+            case FramePhase::Render:
+                return "render";
+            case FramePhase::Post:
+                return "post";
+            case FramePhase::Present:
+                return "present";
+            default:
+                return "unknown";
+        }
+    }
+
+} // namespace x11engine
@@ -1,4 +1,10 @@
 #include "x11engine/renderer.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/memory.hpp"
+
+#include <cmath>
+#include <emmintrin.h>
+#include <new>
 
 namespace {
     const int INSIDE = 0; // 0000
@@ -7,83 +13,356 @@ namespace {
     const int BOTTOM = 4; // 0100
     const int TOP = 8;    // 1000
 
-    // Helper to calculate region code for a point(x, y)
-    int ComputeOutCode(int x, int y, int w, int h) {
+    // Helper to calculate region code for a point(x, y) against the inclusive box [minX, maxX] x [minY, maxY]
+    int ComputeOutCode(int x, int y, int minX, int minY, int maxX, int maxY) {
         int code = INSIDE;
-        if (x < 0)
+        if (x < minX)
             code |= LEFT;
-        else if (x >= w)
+        else if (x > maxX)
             code |= RIGHT;
-        if (y < 0)
+        if (y < minY)
             code |= BOTTOM;
-        else if (y >= h)
+        else if (y > maxY)
             code |= TOP;
         return code;
     }
+
+    // Cohen-Sutherland: clips the line to the box, false when nothing is left
+    bool ClipLine(int& x0, int& y0, int& x1, int& y1, int minX, int minY, int maxX, int maxY) {
+        int outcode0 = ComputeOutCode(x0, y0, minX, minY, maxX, maxY);
+        int outcode1 = ComputeOutCode(x1, y1, minX, minY, maxX, maxY);
+
+        while (true) {
+            if (!(outcode0 | outcode1)) {
+                // Both points inside - trivial accept
+                return true;
+            } else if (outcode0 & outcode1) {
+                // Both points share an outside zone - trivial reject
+                return false;
+            } else {
+                // One inside, one outside: Clip
+                int x, y;
+                // Pick the outside point
+                int outcodeOut = outcode0 ? outcode0 : outcode1;
+
+                // Find intersection point
+                // Use floating point for precision during clip, then cast back
+                if (outcodeOut & TOP) { // Above clip window
+                    x = x0 + (x1 - x0) * (maxY - y0) / (double)(y1 - y0);
+                    y = maxY;
+                } else if (outcodeOut & BOTTOM) { // Below clip window
+                    x = x0 + (x1 - x0) * (minY - y0) / (double)(y1 - y0);
+                    y = minY;
+                } else if (outcodeOut & RIGHT) { // Right of clip window
+                    y = y0 + (y1 - y0) * (maxX - x0) / (double)(x1 - x0);
+                    x = maxX;
+                } else { // Left of clip window
+                    y = y0 + (y1 - y0) * (minX - x0) / (double)(x1 - x0);
+                    x = minX;
+                }
+
+                // Update the point we moved
+                if (outcodeOut == outcode0) {
+                    x0 = x;
+                    y0 = y;
+                    outcode0 = ComputeOutCode(x0, y0, minX, minY, maxX, maxY);
+                } else {
+                    x1 = x;
+                    y1 = y;
+                    outcode1 = ComputeOutCode(x1, y1, minX, minY, maxX, maxY);
+                }
+            }
+        }
+    }
+
+    // Render scale is snapped to 1/32 steps so small controller jitter doesn't rebuild targets
+    constexpr float SCALE_STEP = 1.0f / 32.0f;
+    constexpr float MIN_SCALE = 0.25f;
+
+    // Bilinear weights are 7-bit so (b - a) * w stays inside a signed 16-bit lane
+    constexpr int WEIGHT_BITS = 7;
+    constexpr int WEIGHT_ONE = 1 << WEIGHT_BITS;
+
+    // Source pixel whose footprint holds the center of destination pixel 'i': floor((i + 0.5) * src / dst), exact in integers
+    inline int NearestSource(int i, int src, int dst) { return std::min(static_cast<int>((2 * static_cast<int64_t>(i) + 1) * src / (2 * static_cast<int64_t>(dst))), src - 1); }
+
+    void UpscaleNearest(const uint32_t* src, int srcW, int srcH, uint32_t* dst, int dstW, int dstH, const int* mapX) {
+        int lastSy = -1;
+        for (int y = 0; y < dstH; ++y) {
+            uint32_t* out = dst + static_cast<std::size_t>(y) * dstW;
+            int sy = NearestSource(y, srcH, dstH); // Same rule as the columns (mapX)
+
+            // Consecutive rows sampling the same source row are a plain copy
+            if (sy == lastSy) {
+                std::memcpy(out, out - dstW, dstW * sizeof(uint32_t));
+                continue;
+            }
+            lastSy = sy;
+
+            const uint32_t* row = src + static_cast<std::size_t>(sy) * srcW;
+            int x = 0;
+            for (; x + 4 <= dstW; x += 4) {
+                __m128i px = _mm_setr_epi32(row[mapX[x]], row[mapX[x + 1]], row[mapX[x + 2]], row[mapX[x + 3]]);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), px);
+            }
+            for (; x < dstW; ++x)
+                out[x] = row[mapX[x]];
+        }
+    }
+
+    // Lerp 2 pixels (8 x 16-bit channels): a + ((b - a) * w >> WEIGHT_BITS)
+    inline __m128i Lerp16(__m128i a, __m128i b, __m128i w) { return _mm_add_epi16(a, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b, a), w), WEIGHT_BITS)); }
+
+    void UpscaleBilinear(const uint32_t* src, int srcW, int srcH, uint32_t* dst, int dstW, int dstH, const int* x0, const int* x1, const int16_t* wx) {
+        const __m128i zero = _mm_setzero_si128();
+        const float stepY = static_cast<float>(srcH) / dstH;
+
+        for (int y = 0; y < dstH; ++y) {
+            // Sample at pixel centers
+            float fy = std::max(0.0f, (y + 0.5f) * stepY - 0.5f);
+            int sy0 = std::min(static_cast<int>(fy), srcH - 1);
+            int sy1 = std::min(sy0 + 1, srcH - 1);
+            int16_t wy = static_cast<int16_t>((fy - sy0) * WEIGHT_ONE);
+
+            const uint32_t* r0 = src + static_cast<std::size_t>(sy0) * srcW;
+            const uint32_t* r1 = src + static_cast<std::size_t>(sy1) * srcW;
+            uint32_t* out = dst + static_cast<std::size_t>(y) * dstW;
+            const __m128i wyv = _mm_set1_epi16(wy);
+
+            int x = 0;
+            for (; x + 4 <= dstW; x += 4) {
+                __m128i a = _mm_setr_epi32(r0[x0[x]], r0[x0[x + 1]], r0[x0[x + 2]], r0[x0[x + 3]]);
+                __m128i b = _mm_setr_epi32(r0[x1[x]], r0[x1[x + 1]], r0[x1[x + 2]], r0[x1[x + 3]]);
+                __m128i c = _mm_setr_epi32(r1[x0[x]], r1[x0[x + 1]], r1[x0[x + 2]], r1[x0[x + 3]]);
+                __m128i d = _mm_setr_epi32(r1[x1[x]], r1[x1[x + 1]], r1[x1[x + 2]], r1[x1[x + 3]]);
+
+                // Horizontal weights broadcast over the 4 channels of each pixel
+                __m128i wlo = _mm_setr_epi16(wx[x], wx[x], wx[x], wx[x], wx[x + 1], wx[x + 1], wx[x + 1], wx[x + 1]);
+                __m128i whi = _mm_setr_epi16(wx[x + 2], wx[x + 2], wx[x + 2], wx[x + 2], wx[x + 3], wx[x + 3], wx[x + 3], wx[x + 3]);
+
+                __m128i topLo = Lerp16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), wlo);
+                __m128i topHi = Lerp16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), whi);
+                __m128i botLo = Lerp16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero), wlo);
+                __m128i botHi = Lerp16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero), whi);
+
+                __m128i lo = Lerp16(topLo, botLo, wyv);
+                __m128i hi = Lerp16(topHi, botHi, wyv);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(lo, hi));
+            }
+
+            for (; x < dstW; ++x) {
+                uint32_t result = 0;
+                for (int shift = 0; shift < 32; shift += 8) {
+                    int a = (r0[x0[x]] >> shift) & 0xFF, b = (r0[x1[x]] >> shift) & 0xFF;
+                    int c = (r1[x0[x]] >> shift) & 0xFF, d = (r1[x1[x]] >> shift) & 0xFF;
+                    int top = a + (((b - a) * wx[x]) >> WEIGHT_BITS);
+                    int bot = c + (((d - c) * wx[x]) >> WEIGHT_BITS);
+                    result |= static_cast<uint32_t>(top + (((bot - top) * wy) >> WEIGHT_BITS)) << shift;
+                }
+                out[x] = result;
+            }
+        }
+    }
 } // namespace
 
 namespace x11engine {
 
-    Renderer::Renderer(int width, int height) : width(width), height(height), framebuffer(nullptr), image(nullptr) {
-        framebuffer = new uint32_t[width * height];
+    Renderer::Renderer(int width, int height)
+        : width(width), height(height), windowWidth(width), windowHeight(height), renderScale(1.0f), filter(UpscaleFilter::Bilinear), framebuffer(nullptr), capacity(0),
+          layout(FramebufferLayout::Linear), tilesPerRow((width + kernels::TILE - 1) >> kernels::TILE_SHIFT), linearBuffer(nullptr), linearCapacity(0), presentBuffer(nullptr), presentCapacity(0), pixelFormat{}, convertRow(nullptr), convertBuffer(nullptr), convertCapacity(0), convertPitch(0) {
+        Reserve(framebuffer, capacity, GetStoragePixels());
         Clear(color::BLACK);
     }
 
     Renderer::~Renderer() {
-        if (image) {
-            // XDestroyImage frees the data buffer if we don't handle it carefully.
-            // Since we allocated 'framebuffer' ourselves, we usually want to free it ourselves
-            // or let XDestroyImage do it.
-            // Standard trick: set data to NULL before destroying if you want to keep ownership,
-            // OR let XImage take ownership. Here we manually delete framebuffer, so we decouple it.
-            image->data = NULL;
-            XDestroyImage(image);
-        }
-        delete[] framebuffer;
+        memory::FreeAligned(framebuffer);
+        memory::FreeAligned(linearBuffer);
+        memory::FreeAligned(presentBuffer);
+        memory::FreeAligned(convertBuffer);
     }
 
     bool Renderer::Init(const Frame& frame) {
-        Visual* visual = DefaultVisual(frame.GetDisplay(), frame.GetScreen());
-        int depth = DefaultDepth(frame.GetDisplay(), frame.GetScreen());
+        // The visual never changes for a window: the frame negotiated its pixel layout once
+        pixelFormat = frame.GetPixelFormat();
+        convertRow = GetRowConverter(pixelFormat);
+        UpdateConvertTarget();
+        return true;
+    }
+
+    void Renderer::UpdateConvertTarget() {
+        if (!convertRow)
+            return;
+
+        // Row pitch follows the server's scanline pad for this depth
+        convertPitch = GetBytesPerLine(pixelFormat, windowWidth);
+        std::size_t bytes = static_cast<std::size_t>(convertPitch) * windowHeight;
+        Reserve(convertBuffer, convertCapacity, (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    }
+
+    void Renderer::Present(Frame& frame) {
+        // 1. Everything after this point reads a linear render-sized image
+        const uint32_t* image = framebuffer;
+        if (layout == FramebufferLayout::Tiled) {
+            Detile();
+            image = linearBuffer;
+        }
+
+        if (IsScaled()) {
+            if (filter == UpscaleFilter::Nearest)
+                UpscaleNearest(image, width, height, presentBuffer, windowWidth, windowHeight, upscaleNearestX.data());
+            else
+                UpscaleBilinear(image, width, height, presentBuffer, windowWidth, windowHeight, upscaleX0.data(), upscaleX1.data(), upscaleWX.data());
+        }
+
+        // The window always shows a window-sized image; while scaled it is the upscale target
+        const uint32_t* source = GetPresentedImage();
+        if (!convertRow) {
+            frame.PresentImage(source, windowWidth, windowHeight, windowWidth * static_cast<int>(sizeof(uint32_t)));
+            return;
+        }
+
+        uint8_t* dst = reinterpret_cast<uint8_t*>(convertBuffer);
+        for (int y = 0; y < windowHeight; ++y)
+            convertRow(source + static_cast<std::size_t>(y) * windowWidth, dst + static_cast<std::size_t>(y) * convertPitch, windowWidth, pixelFormat);
+        frame.PresentImage(convertBuffer, windowWidth, windowHeight, convertPitch);
+    }
+
+    const uint32_t* Renderer::GetPresentedImage() const {
+        if (IsScaled())
+            return presentBuffer;
+        return layout == FramebufferLayout::Tiled ? linearBuffer : framebuffer;
+    }
+
+    void Renderer::Detile() {
+        // One row of tiles at a time: each tile is read once, front to back
+        const kernels::KernelTable& k = kernels::Get();
+        const std::size_t tileRowPixels = static_cast<std::size_t>(tilesPerRow) * kernels::TILE_PIXELS;
+        for (int y = 0; y < height; y += kernels::TILE)
+            k.detileRow(linearBuffer + static_cast<std::size_t>(y) * width, width, framebuffer + (y >> kernels::TILE_SHIFT) * tileRowPixels, width, std::min(kernels::TILE, height - y));
+    }
+
+    // Padding pixels of partial edge tiles are cleared too, never presented
+    void Renderer::Clear(uint32_t color) { kernels::Get().fill(framebuffer, GetStoragePixels(), color); }
+
+    void Renderer::SetLayout(FramebufferLayout newLayout) {
+        if (newLayout == layout)
+            return;
+
+        layout = newLayout;
+        Reserve(framebuffer, capacity, GetStoragePixels());
+        if (layout == FramebufferLayout::Tiled)
+            Reserve(linearBuffer, linearCapacity, static_cast<std::size_t>(width) * height);
+        Clear(color::BLACK);
+    }
+
+    std::size_t Renderer::GetStoragePixels() const {
+        if (layout == FramebufferLayout::Linear)
+            return static_cast<std::size_t>(width) * height;
+        std::size_t tileRows = (static_cast<std::size_t>(height) + kernels::TILE - 1) >> kernels::TILE_SHIFT;
+        return tileRows * tilesPerRow * kernels::TILE_PIXELS;
+    }
 
-        image = XCreateImage(frame.GetDisplay(), visual, depth, ZPixmap, 0, reinterpret_cast<char*>(framebuffer), width, height, 32, 0);
+    void Renderer::Resize(const Frame&, int newWidth, int newHeight) {
+        if (newWidth == windowWidth && newHeight == windowHeight)
+            return;
 
-        return image != nullptr;
+        windowWidth = newWidth;
+        windowHeight = newHeight;
+        UpdateTargets();
     }
 
-    void Renderer::Present(const Frame& frame) {
-        if (!image)
+    void Renderer::SetRenderScale(const Frame&, float scale) {
+        scale = std::clamp(std::round(scale / SCALE_STEP) * SCALE_STEP, MIN_SCALE, 1.0f);
+        if (scale == renderScale)
             return;
 
-        XPutImage(frame.GetDisplay(), frame.GetWindow(), DefaultGC(frame.GetDisplay(), frame.GetScreen()), image, 0, 0, 0, 0, width, height);
+        renderScale = scale;
+        UpdateTargets();
+    }
+
+    void Renderer::UpdateTargets() {
+        // 1. Update dimensions, only reallocating when the capacity is exceeded
+        width = std::max(1, static_cast<int>(std::lround(windowWidth * renderScale)));
+        height = std::max(1, static_cast<int>(std::lround(windowHeight * renderScale)));
+        tilesPerRow = (width + kernels::TILE - 1) >> kernels::TILE_SHIFT;
+        Reserve(framebuffer, capacity, GetStoragePixels());
+        if (layout == FramebufferLayout::Tiled)
+            Reserve(linearBuffer, linearCapacity, static_cast<std::size_t>(width) * height);
 
-        // Sync to ensure commands are processed
-        XSync(frame.GetDisplay(), False);
+        if (IsScaled()) {
+            Reserve(presentBuffer, presentCapacity, static_cast<std::size_t>(windowWidth) * windowHeight);
+
+            // 2. Rebuild column lookups (pixel-center sampling, clamped at the right edge). Nearest takes the source pixel
+            //    under each center; bilinear the pair around it.
+            upscaleNearestX.resize(windowWidth);
+            upscaleX0.resize(windowWidth);
+            upscaleX1.resize(windowWidth);
+            upscaleWX.resize(windowWidth);
+            float stepX = static_cast<float>(width) / windowWidth;
+            for (int x = 0; x < windowWidth; ++x) {
+                float fx = std::max(0.0f, (x + 0.5f) * stepX - 0.5f);
+                int sx = std::min(static_cast<int>(fx), width - 1);
+                upscaleNearestX[x] = NearestSource(x, width, windowWidth);
+                upscaleX0[x] = sx;
+                upscaleX1[x] = std::min(sx + 1, width - 1);
+                upscaleWX[x] = static_cast<int16_t>((fx - sx) * WEIGHT_ONE);
+            }
+        }
+
+        // 3. Grow the conversion target with the window
+        UpdateConvertTarget();
     }
 
-    void Renderer::Clear(uint32_t color) {
-        // std::fill_n(framebuffer, width * height, color);
-        memset(framebuffer, 0x001100, width * height * sizeof(uint32_t));
+    void Renderer::Reserve(uint32_t*& buffer, std::size_t& capacity, std::size_t pixels) {
+        if (pixels <= capacity)
+            return;
+
+        // Grow by 1.5x so a window drag settles after a few reallocations
+        std::size_t newCapacity = std::max(pixels, capacity + capacity / 2);
+
+#ifdef X11ENGINE_HUGE_PAGES
+        constexpr bool hugePages = true;
+#else
+        constexpr bool hugePages = false;
+#endif
+
+        uint32_t* newBuffer = static_cast<uint32_t*>(memory::AllocateAligned(newCapacity * sizeof(uint32_t), memory::CACHE_LINE, hugePages));
+        if (!newBuffer)
+            throw std::bad_alloc();
+
+        // Contents are redrawn every frame, no need to copy the old buffer
+        memory::FreeAligned(buffer);
+        buffer = newBuffer;
+        capacity = newCapacity;
     }
 
-    void Renderer::Resize(const Frame& frame, int newWidth, int newHeight) {
-        if (newWidth == width && newHeight == height)
+    template <class Run>
+    void Renderer::ForEachRun(int x, int y, std::size_t count, Run&& run) const {
+        if (layout == FramebufferLayout::Linear) {
+            run(framebuffer + static_cast<std::size_t>(y) * width + x, std::size_t{0}, count);
             return;
+        }
 
-        // 1. Clean up old resources
-        if (image) {
-            image->data = NULL; // Decouple before destroying
-            XDestroyImage(image);
+        for (std::size_t i = 0; i < count;) {
+            int px = x + static_cast<int>(i);
+            std::size_t n = std::min<std::size_t>(kernels::TILE - (px & (kernels::TILE - 1)), count - i);
+            run(framebuffer + kernels::TiledOffset(px, y, tilesPerRow), i, n);
+            i += n;
         }
-        delete[] framebuffer;
+    }
+
+    void Renderer::ReadRow(int y, uint32_t* dst) const {
+        ForEachRun(0, y, static_cast<std::size_t>(width), [dst](const uint32_t* src, std::size_t i, std::size_t n) { std::memcpy(dst + i, src, n * sizeof(uint32_t)); });
+    }
 
-        // 2. Update dimensions and allocate new buffer
-        width = newWidth;
-        height = newHeight;
-        framebuffer = new uint32_t[width * height];
+    void Renderer::WriteRow(int y, const uint32_t* src) {
+        ForEachRun(0, y, static_cast<std::size_t>(width), [src](uint32_t* dst, std::size_t i, std::size_t n) { std::memcpy(dst, src + i, n * sizeof(uint32_t)); });
+    }
 
-        // 3. Re-initialize XImage
-        Init(frame);
+    void Renderer::ResetStats() {
+        statObjects.store(0, std::memory_order_relaxed);
+        statLines.store(0, std::memory_order_relaxed);
+        statPixels.store(0, std::memory_order_relaxed);
     }
 
     void Renderer::MapToScreenCoord(int& x, int& y) {
@@ -93,7 +372,7 @@ namespace x11engine {
 
     void Renderer::DrawPixelScreen(int x, int y, uint32_t color) {
         if (x >= 0 && x < width && y >= 0 && y < height)
-            framebuffer[y * width + x] = color;
+            framebuffer[GetPixelOffset(x, y)] = color;
     }
 
     void Renderer::DrawPixel(int x, int y, uint32_t color) {
@@ -101,85 +380,184 @@ namespace x11engine {
         DrawPixelScreen(x, y, color);
     }
 
-    void Renderer::DrawLine(int x0, int y0, int x1, int y1, uint32_t color) {
+    void Renderer::DrawLine(int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
         // --- 1. Cohen-Sutherland 2D Clipping ---
-        int outcode0 = ComputeOutCode(x0, y0, width, height);
-        int outcode1 = ComputeOutCode(x1, y1, width, height);
-        bool accept = false;
+        if (!ClipLine(x0, y0, x1, y1, 0, 0, width - 1, height - 1))
+            return;
 
-        while (true) {
-            if (!(outcode0 | outcode1)) {
-                // Both points inside - trivial accept
-                accept = true;
-                break;
-            } else if (outcode0 & outcode1) {
-                // Both points share an outside zone - trivial reject
-                break;
-            } else {
-                // One inside, one outside: Clip
-                int x, y;
-                // Pick the outside point
-                int outcodeOut = outcode0 ? outcode0 : outcode1;
+        // --- 2. Rasterize ---
+        // Now x0,y0 and x1,y1 are guaranteed to be on-screen
+        Count(1, RasterLine(x0, y0, x1, y1, color, mode));
+    }
 
-                // Find intersection point
-                // Use floating point for precision during clip, then cast back
-                if (outcodeOut & TOP) { // Above clip window
-                    x = x0 + (x1 - x0) * (height - 1 - y0) / (double)(y1 - y0);
-                    y = height - 1;
-                } else if (outcodeOut & BOTTOM) { // Below clip window
-                    x = x0 + (x1 - x0) * (0 - y0) / (double)(y1 - y0);
-                    y = 0;
-                } else if (outcodeOut & RIGHT) { // Right of clip window
-                    y = y0 + (y1 - y0) * (width - 1 - x0) / (double)(x1 - x0);
-                    x = width - 1;
-                } else if (outcodeOut & LEFT) { // Left of clip window
-                    y = y0 + (y1 - y0) * (0 - x0) / (double)(x1 - x0);
-                    x = 0;
-                }
+    void Renderer::DrawLines(const ViewRect& rect, std::span<const kernels::ScreenLine> lines, std::span<const uint32_t> colors, color::BlendMode mode) {
+        // Scissor in the lines' coordinates: the rect, cut down to the target
+        int minX = std::max(0, -rect.x);
+        int minY = std::max(0, -rect.y);
+        int maxX = std::min(rect.width, width - rect.x) - 1;
+        int maxY = std::min(rect.height, height - rect.y) - 1;
+        if (minX > maxX || minY > maxY)
+            return;
 
-                // Update the point we moved
-                if (outcodeOut == outcode0) {
-                    x0 = x;
-                    y0 = y;
-                    outcode0 = ComputeOutCode(x0, y0, width, height);
-                } else {
-                    x1 = x;
-                    y1 = y;
-                    outcode1 = ComputeOutCode(x1, y1, width, height);
-                }
+        uint64_t drawn = 0, pixels = 0;
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            kernels::ScreenLine line = lines[i];
+            if (ClipLine(line.x0, line.y0, line.x1, line.y1, minX, minY, maxX, maxY)) {
+                pixels += RasterLine(rect.x + line.x0, rect.y + line.y0, rect.x + line.x1, rect.y + line.y1, colors[i], mode);
+                drawn++;
             }
         }
+        Count(drawn, pixels);
+    }
 
-        if (!accept)
+    void Renderer::FillRect(const ViewRect& rect, uint32_t color) {
+        int x0 = std::max(rect.x, 0);
+        int x1 = std::min(rect.x + rect.width, width) - 1;
+        int y0 = std::max(rect.y, 0);
+        int y1 = std::min(rect.y + rect.height, height);
+        if (x0 > x1 || y0 >= y1)
             return;
 
-        // --- 2. Original Bresenham's Algorithm (Unchanged) ---
-        // Now x0,y0 and x1,y1 are guaranteed to be on-screen
+        for (int y = y0; y < y1; ++y)
+            Span(x0, x1, y, color, color::BlendMode::Replace);
+        Count(0, static_cast<uint64_t>(x1 - x0 + 1) * (y1 - y0));
+    }
 
-        int dx = std::abs(x1 - x0);
-        int dy = -std::abs(y1 - y0);
-        int sx = x0 < x1 ? 1 : -1;
-        int sy = y0 < y1 ? 1 : -1;
-        int err = dx + dy;
+    int Renderer::RasterLine(int x0, int y0, int x1, int y1, uint32_t color, color::BlendMode mode) {
+        if (y0 == y1) {
+            Span(std::min(x0, x1), std::max(x0, x1), y0, color, mode);
+            return std::abs(x1 - x0) + 1;
+        }
 
-        while (true) {
-            // We can use the unsafe fast draw here because we clipped bounds!
-            // But stick to DrawPixelScreen for safety if you prefer.
-            // framebuffer[y0 * width + x0] = color;
-            DrawPixelScreen(x0, y0, color);
-
-            if (x0 == x1 && y0 == y1)
-                break;
-            int e2 = 2 * err;
-            if (e2 >= dy) {
-                err += dy;
-                x0 += sx;
-            }
-            if (e2 <= dx) {
-                err += dx;
-                y0 += sy;
+        const kernels::KernelTable& k = kernels::Get();
+        bool tiled = layout == FramebufferLayout::Tiled;
+        if (mode == color::BlendMode::Replace)
+            tiled ? k.lineTiled(framebuffer, tilesPerRow, x0, y0, x1, y1, color) : k.line(framebuffer, width, x0, y0, x1, y1, color);
+        else
+            tiled ? k.blendLineTiled(framebuffer, tilesPerRow, x0, y0, x1, y1, color, mode) : k.blendLine(framebuffer, width, x0, y0, x1, y1, color, mode);
+        return std::max(std::abs(x1 - x0), std::abs(y1 - y0)) + 1;
+    }
+
+    void Renderer::Blit(const Atlas& atlas, int sprite, int x, int y, BlitMode mode, int scale, bool flipX) {
+        BlitSprite(atlas, {sprite, x, y, scale, flipX}, mode);
+    }
+
+    void Renderer::BlitBatch(const Atlas& atlas, std::span<const SpriteDraw> draws, BlitMode mode) {
+        for (const SpriteDraw& draw : draws)
+            BlitSprite(atlas, draw, mode);
+    }
+
+    void Renderer::BlitSprite(const Atlas& atlas, const SpriteDraw& draw, BlitMode mode) {
+        if (draw.sprite < 0 || draw.sprite >= atlas.GetSpriteCount() || draw.scale < 1)
+            return;
+
+        // 1. Clip the scaled rectangle against the target. Its far edge and the offsets into it are 64-bit:
+        //    a large scale or position would overflow int.
+        const SpriteRect& rect = atlas.GetSprite(draw.sprite);
+        int x0 = std::max(draw.x, 0);
+        int y0 = std::max(draw.y, 0);
+        int x1 = static_cast<int>(std::min<int64_t>(draw.x + static_cast<int64_t>(rect.width) * draw.scale, width));
+        int y1 = static_cast<int>(std::min<int64_t>(draw.y + static_cast<int64_t>(rect.height) * draw.scale, height));
+        if (x0 >= x1 || y0 >= y1)
+            return;
+
+        const kernels::KernelTable& k = kernels::Get();
+        std::size_t count = static_cast<std::size_t>(x1 - x0);
+        bool direct = draw.scale == 1 && !draw.flipX;
+        if (!direct && blitRow.size() < count)
+            blitRow.resize(width);
+
+        // 2. Rows: unscaled, unflipped sprites are read straight from the atlas; otherwise the visible
+        //    part of a source row is expanded once and reused for its 'scale' output rows
+        int expandedRow = -1;
+        for (int y = y0; y < y1; ++y) {
+            int sy = rect.y + static_cast<int>((y - static_cast<int64_t>(draw.y)) / draw.scale);
+            const uint32_t* src = atlas.GetRow(sy) + rect.x;
+
+            if (direct) {
+                src += x0 - draw.x;
+            } else {
+                if (sy != expandedRow) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        int sx = static_cast<int>((x0 - static_cast<int64_t>(draw.x) + static_cast<int64_t>(i)) / draw.scale);
+                        blitRow[i] = src[draw.flipX ? rect.width - 1 - sx : sx];
+                    }
+                    expandedRow = sy;
+                }
+                src = blitRow.data();
             }
+
+            ForEachRun(x0, y, count, [&](uint32_t* dst, std::size_t i, std::size_t n) {
+                switch (mode) {
+                    case BlitMode::Opaque:
+                        k.copyRow(dst, src + i, n);
+                        break;
+                    case BlitMode::ColorKey:
+                        k.keyRow(dst, src + i, n, atlas.GetColorKey());
+                        break;
+                    case BlitMode::Alpha:
+                        k.alphaRow(dst, src + i, n);
+                        break;
+                }
+            });
+        }
+        Count(0, count * (y1 - y0));
+    }
+
+    void Renderer::DrawTexturedSpan(int x0, int x1, int y, const Texture& texture, TextureSpan span, TextureFilter filter, BlitMode mode) {
+        if (y < 0 || y >= height || !texture.IsValid())
+            return;
+
+        // Clipping the left end moves the span's start along its gradients (negated as float: -INT_MIN is UB)
+        if (x0 < 0) {
+            float skip = -static_cast<float>(x0);
+            span.uOverW += skip * span.uOverWStep;
+            span.vOverW += skip * span.vOverWStep;
+            span.oneOverW += skip * span.oneOverWStep;
+            x0 = 0;
         }
+        x1 = std::min(x1, width - 1);
+        if (x0 > x1)
+            return;
+
+        std::size_t count = static_cast<std::size_t>(x1 - x0 + 1);
+        if (blitRow.size() < count)
+            blitRow.resize(width);
+        texture.SampleSpan(span, static_cast<int>(count), blitRow.data(), filter);
+
+        const kernels::KernelTable& k = kernels::Get();
+        ForEachRun(x0, y, count, [&](uint32_t* dst, std::size_t i, std::size_t n) {
+            if (mode == BlitMode::Alpha)
+                k.alphaRow(dst, blitRow.data() + i, n);
+            else if (mode == BlitMode::ColorKey)
+                k.keyRow(dst, blitRow.data() + i, n, color::MAGENTA);
+            else
+                k.copyRow(dst, blitRow.data() + i, n);
+        });
+        Count(0, count);
+    }
+
+    void Renderer::FillSpan(int x0, int x1, int y, uint32_t color, color::BlendMode mode) {
+        if (y < 0 || y >= height)
+            return;
+
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, width - 1);
+        if (x0 > x1)
+            return;
+
+        Span(x0, x1, y, color, mode);
+        Count(0, static_cast<uint64_t>(x1 - x0 + 1));
+    }
+
+    void Renderer::Span(int x0, int x1, int y, uint32_t color, color::BlendMode mode) {
+        const kernels::KernelTable& k = kernels::Get();
+        ForEachRun(x0, y, static_cast<std::size_t>(x1 - x0 + 1), [&](uint32_t* dst, std::size_t, std::size_t n) {
+            if (mode == color::BlendMode::Replace)
+                k.fill(dst, n, color);
+            else
+                k.blendFill(dst, n, color, mode);
+        });
     }
 
 } // namespace  x11engine
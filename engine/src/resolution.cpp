@@ -0,0 +1,51 @@
+#include "x11engine/resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double SMOOTHING = 0.1;    // EMA weight of the newest sample
+    constexpr double HIGH_WATER = 0.90;  // Shrink once the average exceeds 90% of the budget
+    constexpr double LOW_WATER = 0.60;   // Grow back while under 60% of the budget
+    constexpr double AIM = 0.80;         // When shrinking, aim for 80% of the budget
+    constexpr float GROW_STEP = 0.05f;   // Grow slowly to avoid oscillating around the threshold
+    constexpr int COOLDOWN_FRAMES = 15;
+} // namespace
+
+namespace x11engine {
+
+    ResolutionController::ResolutionController(double targetFrameTime, float minScale, float maxScale)
+        : budget(targetFrameTime), minScale(minScale), maxScale(maxScale), scale(maxScale), average(0.0), cooldown(0) {}
+
+    void ResolutionController::SetLimits(float newMin, float newMax) {
+        minScale = std::min(newMin, newMax);
+        maxScale = std::max(newMin, newMax);
+        scale = std::clamp(scale, minScale, maxScale);
+    }
+
+    float ResolutionController::Update(double frameTime) {
+        average = average == 0.0 ? frameTime : average + (frameTime - average) * SMOOTHING;
+
+        if (cooldown > 0) {
+            cooldown--;
+            return scale;
+        }
+
+        float newScale = scale;
+        if (average > budget * HIGH_WATER) {
+            // Pixel cost scales with area, so correct by the square root of the overshoot
+            newScale = scale * static_cast<float>(std::sqrt(budget * AIM / average));
+        } else if (average < budget * LOW_WATER) {
+            newScale = scale + GROW_STEP;
+        }
+
+        newScale = std::clamp(newScale, minScale, maxScale);
+        if (newScale != scale) {
+            scale = newScale;
+            cooldown = COOLDOWN_FRAMES;
+        }
+
+        return scale;
+    }
+
+} // namespace x11engine
@@ -0,0 +1,156 @@
+#include "x11engine/telemetry.hpp"
+
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace x11engine {
+
+    namespace {
+        constexpr std::size_t SAMPLE_WORDS = sizeof(TelemetrySample) / sizeof(uint64_t);
+        using SampleWords = std::array<uint64_t, SAMPLE_WORDS>;
+
+        // Payload words are accessed atomically (relaxed) so the reader's racing copy is well-defined;
+        // the ordering comes from the sequence counter around them
+        inline std::atomic_ref<uint64_t> Word(TelemetryBlock* block, std::size_t i) { return std::atomic_ref<uint64_t>(reinterpret_cast<uint64_t*>(&block->sample)[i]); }
+    } // namespace
+
+    std::string GetDefaultTelemetryName(pid_t pid) { return "/x11engine." + std::to_string(pid); }
+
+    TelemetryWriter::~TelemetryWriter() { Close(); }
+
+    bool TelemetryWriter::Open(const std::string& shmName) {
+        Close();
+
+        // 1. An object left behind by a crashed run is replaced rather than reused
+        shm_unlink(shmName.c_str());
+        int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            std::cerr << "Failed to create telemetry block " << shmName << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+
+        void* memory = MAP_FAILED;
+        if (ftruncate(fd, sizeof(TelemetryBlock)) == 0)
+            memory = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED) {
+            std::cerr << "Failed to map telemetry block " << shmName << ": " << std::strerror(errno) << std::endl;
+            shm_unlink(shmName.c_str());
+            return false;
+        }
+
+        // 2. Fresh pages are zero (sequence 0 = nothing published). The magic goes in last, readers check it first.
+        block = static_cast<TelemetryBlock*>(memory);
+        block->version = TELEMETRY_VERSION;
+        block->pid = getpid();
+        block->phaseCount = FRAME_PHASE_COUNT;
+        std::atomic_ref<uint32_t>(block->magic).store(TELEMETRY_MAGIC, std::memory_order_release);
+
+        name = shmName;
+        totals = {};
+        return true;
+    }
+
+    void TelemetryWriter::Close() {
+        if (!block)
+            return;
+        munmap(block, sizeof(TelemetryBlock));
+        shm_unlink(name.c_str());
+        block = nullptr;
+        name.clear();
+    }
+
+    void TelemetryWriter::Publish(const TelemetrySample& sample) {
+        if (!block)
+            return;
+
+        totals.frames++;
+        totals.totalFrameTime += sample.frameTime;
+        totals.totalObjects += sample.objects;
+        totals.totalLines += sample.lines;
+        totals.totalPixels += sample.pixels;
+        totals.totalAllocations += sample.allocations;
+
+        TelemetrySample out = sample;
+        out.frames = totals.frames;
+        out.totalFrameTime = totals.totalFrameTime;
+        out.totalObjects = totals.totalObjects;
+        out.totalLines = totals.totalLines;
+        out.totalPixels = totals.totalPixels;
+        out.totalAllocations = totals.totalAllocations;
+        SampleWords words = std::bit_cast<SampleWords>(out);
+
+        // Seqlock write: odd sequence, payload, even sequence
+        uint64_t sequence = block->sequence.load(std::memory_order_relaxed);
+        block->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < SAMPLE_WORDS; ++i)
+            Word(block, i).store(words[i], std::memory_order_relaxed);
+        block->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    TelemetryReader::~TelemetryReader() { Close(); }
+
+    bool TelemetryReader::Open(const std::string& shmName) {
+        Close();
+
+        int fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void* memory = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(TelemetryBlock))
+            memory = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED)
+            return false;
+
+        block = static_cast<TelemetryBlock*>(memory);
+        if (std::atomic_ref<uint32_t>(block->magic).load(std::memory_order_acquire) != TELEMETRY_MAGIC || block->version != TELEMETRY_VERSION ||
+            block->phaseCount != FRAME_PHASE_COUNT) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void TelemetryReader::Close() {
+        if (!block)
+            return;
+        munmap(block, sizeof(TelemetryBlock));
+        block = nullptr;
+    }
+
+    bool TelemetryReader::Read(TelemetrySample& out) const {
+        if (!block)
+            return false;
+
+        // The writer never blocks inside an update, so a retry is rare; the bound only guards against one that died mid-update
+        SampleWords words;
+        for (int attempt = 0; attempt < 1 << 16; ++attempt) {
+            uint64_t before = block->sequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+            if (before & 1)
+                continue;
+
+            for (std::size_t i = 0; i < SAMPLE_WORDS; ++i)
+                words[i] = Word(block, i).load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (block->sequence.load(std::memory_order_relaxed) == before) {
+                out = std::bit_cast<TelemetrySample>(words);
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace x11engine
@@ -0,0 +1,148 @@
+#include "x11engine/texture.hpp"
+#include "x11engine/atlas.hpp"
+#include "x11engine/kernels.hpp"
+#include "x11engine/memory.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace x11engine {
+
+    namespace {
+        // 2x2 box filter, rounded. A dimension already at 1 is not halved.
+        void Downsample(const uint32_t* src, int width, int height, uint32_t* dst) {
+            int dstWidth = std::max(width / 2, 1);
+            int dstHeight = std::max(height / 2, 1);
+            for (int y = 0; y < dstHeight; ++y) {
+                const uint32_t* row0 = src + static_cast<std::size_t>(std::min(y * 2, height - 1)) * width;
+                const uint32_t* row1 = src + static_cast<std::size_t>(std::min(y * 2 + 1, height - 1)) * width;
+                for (int x = 0; x < dstWidth; ++x) {
+                    int x0 = std::min(x * 2, width - 1);
+                    int x1 = std::min(x * 2 + 1, width - 1);
+                    uint32_t out = 0;
+                    for (int shift = 0; shift < 32; shift += 8) {
+                        uint32_t sum = ((row0[x0] >> shift) & 0xFF) + ((row0[x1] >> shift) & 0xFF) + ((row1[x0] >> shift) & 0xFF) + ((row1[x1] >> shift) & 0xFF);
+                        out |= ((sum + 2) >> 2) << shift;
+                    }
+                    dst[static_cast<std::size_t>(y) * dstWidth + x] = out;
+                }
+            }
+        }
+    } // namespace
+
+    Texture::~Texture() { Release(); }
+
+    Texture::Texture(Texture&& other) noexcept { *this = std::move(other); }
+
+    Texture& Texture::operator=(Texture&& other) noexcept {
+        if (this != &other) {
+            Release();
+            data = std::exchange(other.data, nullptr);
+            levels = std::move(other.levels);
+        }
+        return *this;
+    }
+
+    void Texture::Release() {
+        memory::FreeAligned(data);
+        data = nullptr;
+        levels.clear();
+    }
+
+    bool Texture::Create(const uint32_t* texels, int width, int height, bool generateMips) {
+        if (width <= 0 || height <= 0 || !std::has_single_bit(static_cast<unsigned>(width)) || !std::has_single_bit(static_cast<unsigned>(height))) {
+            std::cerr << "Texture size must be a power of two (got " << width << "x" << height << ")" << std::endl;
+            return false;
+        }
+        Release();
+
+        // 1. Level layout: whole 4x4 tiles, each level starting on a cache line
+        std::size_t total = 0;
+        for (int w = width, h = height;; w = std::max(w / 2, 1), h = std::max(h / 2, 1)) {
+            int tilesPerRow = std::max(w / 4, 1);
+            int tilesPerColumn = std::max(h / 4, 1);
+            levels.push_back({w, h, std::countr_zero(static_cast<unsigned>(tilesPerRow)) + 4, total});
+            total += static_cast<std::size_t>(tilesPerRow) * tilesPerColumn * 16;
+            if (!generateMips || (w == 1 && h == 1))
+                break;
+        }
+
+        data = static_cast<uint32_t*>(memory::AllocateAligned(total * sizeof(uint32_t)));
+        if (!data) {
+            levels.clear();
+            std::cerr << "Failed to allocate texture" << std::endl;
+            return false;
+        }
+        std::memset(data, 0, total * sizeof(uint32_t));
+
+        // 2. Filter each level from the previous one in row-major order, then swizzle it into tiles
+        std::vector<uint32_t> current(texels, texels + static_cast<std::size_t>(width) * height);
+        std::vector<uint32_t> next;
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            const Level& level = levels[i];
+            kernels::TextureLevel view{data + level.offset, level.width - 1, level.height - 1, level.tileShift, 0.0f, 0.0f};
+            for (int y = 0; y < level.height; ++y)
+                for (int x = 0; x < level.width; ++x)
+                    data[level.offset + kernels::TextureOffset(view, x, y)] = current[static_cast<std::size_t>(y) * level.width + x];
+
+            if (i + 1 < levels.size()) {
+                next.resize(static_cast<std::size_t>(levels[i + 1].width) * levels[i + 1].height);
+                Downsample(current.data(), level.width, level.height, next.data());
+                current.swap(next);
+            }
+        }
+        return true;
+    }
+
+    bool Texture::Load(const std::string& path, bool generateMips) {
+        std::vector<uint32_t> pixels;
+        int width, height;
+        return ReadImageFile(path, pixels, width, height) && Create(pixels.data(), width, height, generateMips);
+    }
+
+    int Texture::SelectLevel(float texelsPerPixel, float lodBias) const {
+        if (levels.empty())
+            return 0;
+        float lod = std::log2(std::max(texelsPerPixel, 1e-6f)) + lodBias;
+        return std::clamp(static_cast<int>(std::floor(lod + 0.5f)), 0, GetLevelCount() - 1);
+    }
+
+    uint32_t Texture::Fetch(int level, int x, int y) const {
+        const Level& l = levels[level];
+        kernels::TextureLevel view{data + l.offset, l.width - 1, l.height - 1, l.tileShift, 0.0f, 0.0f};
+        return view.texels[kernels::TextureOffset(view, x, y)];
+    }
+
+    void Texture::Sample(const float* u, const float* v, std::size_t count, uint32_t* out, TextureFilter filter, int level) const {
+        const Level& l = levels[std::clamp(level, 0, GetLevelCount() - 1)];
+        kernels::TextureLevel view{data + l.offset, l.width - 1, l.height - 1, l.tileShift, static_cast<float>(l.width), static_cast<float>(l.height)};
+
+        const kernels::KernelTable& k = kernels::Get();
+        (filter == TextureFilter::Nearest ? k.sampleNearest : k.sampleBilinear)(view, u, v, count, out);
+    }
+
+    void Texture::SampleSpan(const TextureSpan& span, int count, uint32_t* out, TextureFilter filter, float lodBias) const {
+        if (count <= 0)
+            return;
+
+        // 1. Footprint of one pixel at the middle of the span, in level 0 texels
+        float mid = static_cast<float>(count / 2);
+        float q0 = span.oneOverW + mid * span.oneOverWStep;
+        float q1 = q0 + span.oneOverWStep;
+        float du = (span.uOverW + (mid + 1.0f) * span.uOverWStep) / q1 - (span.uOverW + mid * span.uOverWStep) / q0;
+        float dv = (span.vOverW + (mid + 1.0f) * span.vOverWStep) / q1 - (span.vOverW + mid * span.vOverWStep) / q0;
+        int level = SelectLevel(std::max(std::abs(du) * GetWidth(), std::abs(dv) * GetHeight()), lodBias);
+
+        // 2. Sample that level
+        const Level& l = levels[level];
+        kernels::TextureLevel view{data + l.offset, l.width - 1, l.height - 1, l.tileShift, static_cast<float>(l.width), static_cast<float>(l.height)};
+
+        const kernels::KernelTable& k = kernels::Get();
+        (filter == TextureFilter::Nearest ? k.sampleSpanNearest : k.sampleSpanBilinear)(view, span, count, out);
+    }
+
+} // namespace x11engine
@@ -0,0 +1,28 @@
+#include "x11engine/view.hpp"
+
+#include <cmath>
+
+namespace x11engine {
+
+    ViewContext MakeViewContext(const math::Mat4& viewProj, int width, int height, int* lod) {
+        // Rows of viewProj: a point is inside when -w <= x, y, z <= w, i.e. row3 +- rowN >= 0
+        auto row = [&](int i) { return math::Vec4{viewProj.c0[i], viewProj.c1[i], viewProj.c2[i], viewProj.c3[i]}; };
+        math::Vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+        return {viewProj, {w + x, w - x, w + y, w - y, w + z, w - z}, width, height, lod};
+    }
+
+    bool IsInFrustum(const ViewContext& view, const collision::Aabb& bounds) {
+        math::Vec3 center = (bounds.min + bounds.max) * 0.5f;
+        math::Vec3 extent = (bounds.max - bounds.min) * 0.5f;
+
+        for (const math::Vec4& plane : view.frustum) {
+            float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            if (distance + radius < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+} // namespace x11engine
@@ -0,0 +1,101 @@
+#include "x11engine/viewport.hpp"
+#include "x11engine/jobs.hpp"
+#include "x11engine/objects.hpp"
+#include "x11engine/renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace x11engine {
+
+    namespace {
+        bool Intersects(const ViewRect& a, const ViewRect& b) { return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height; }
+    } // namespace
+
+    int ViewportRenderer::AddViewport(const Viewport& viewport) {
+        viewports.emplace_back().viewport = viewport;
+        return static_cast<int>(viewports.size()) - 1;
+    }
+
+    ViewRect ViewportRenderer::GetRect(const Renderer& renderer, int index) const {
+        // Edges are rounded independently, so viewports that share an edge in fractions share it in pixels
+        const Viewport& v = viewports[index].viewport;
+        float w = static_cast<float>(renderer.GetWidth());
+        float h = static_cast<float>(renderer.GetHeight());
+        int x0 = static_cast<int>(std::lround(v.x * w));
+        int y0 = static_cast<int>(std::lround(v.y * h));
+        int x1 = static_cast<int>(std::lround((v.x + v.width) * w));
+        int y1 = static_cast<int>(std::lround((v.y + v.height) * h));
+        return {x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0)};
+    }
+
+    void ViewportRenderer::Render(Renderer& renderer, std::span<const std::unique_ptr<objects::Object>> scene, ThreadPool* jobs) {
+        const std::size_t chunkCount = (scene.size() + CHUNK - 1) / CHUNK;
+
+        // 1. Per-view setup (serial, only touches the viewports)
+        for (std::size_t v = 0; v < viewports.size(); ++v) {
+            View& view = viewports[v];
+            view.rect = GetRect(renderer, static_cast<int>(v));
+            if (view.rect.width > 0 && view.rect.height > 0)
+                view.viewport.camera.SetAspectRatio(static_cast<float>(view.rect.width) / static_cast<float>(view.rect.height));
+
+            camera::Camera& camera = view.viewport.camera;
+            view.context = MakeViewContext(camera.GetProjectionMatrix() * camera.GetViewMatrix(), view.rect.width, view.rect.height, nullptr);
+            view.lods.resize(scene.size(), 0);
+            view.chunks.resize(chunkCount);
+        }
+
+        // 2. Prepare: one job per (viewport, chunk). Each writes its own list and LOD slots, the objects are only read.
+        auto prepare = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t job = begin; job < end; ++job) {
+                View& view = viewports[job / chunkCount];
+                std::size_t chunk = job % chunkCount;
+                DrawList& list = view.chunks[chunk];
+                list.Clear();
+                if (view.rect.width == 0 || view.rect.height == 0)
+                    continue;
+
+                ViewContext context = view.context;
+                for (std::size_t i = chunk * CHUNK; i < std::min((chunk + 1) * CHUNK, scene.size()); ++i) {
+                    context.lod = &view.lods[i];
+                    std::size_t before = list.lines.size();
+                    scene[i]->Prepare(context, list);
+                    list.objects += list.lines.size() > before;
+                }
+            }
+        };
+
+        std::size_t jobCount = viewports.size() * chunkCount;
+        if (jobs)
+            jobs->ParallelFor(jobCount, 1, prepare);
+        else
+            prepare(0, jobCount);
+
+        // 3. Rasterize. Overlapping viewports (picture-in-picture) must land in order.
+        bool disjoint = true;
+        for (std::size_t a = 0; a < viewports.size() && disjoint; ++a) {
+            for (std::size_t b = a + 1; b < viewports.size() && disjoint; ++b)
+                disjoint = !Intersects(viewports[a].rect, viewports[b].rect);
+        }
+
+        if (jobs && disjoint) {
+            jobs->ParallelFor(viewports.size(), 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t v = begin; v < end; ++v)
+                    Rasterize(renderer, viewports[v]);
+            });
+        } else {
+            for (const View& view : viewports)
+                Rasterize(renderer, view);
+        }
+    }
+
+    void ViewportRenderer::Rasterize(Renderer& renderer, const View& view) const {
+        if (view.viewport.clear)
+            renderer.FillRect(view.rect, view.viewport.clearColor);
+        for (const DrawList& list : view.chunks) {
+            renderer.DrawLines(view.rect, list.lines, list.colors);
+            renderer.CountObjects(list.objects);
+        }
+    }
+
+} // namespace x11engine
@@ -4,6 +4,7 @@
 #include <x11engine/camera.hpp>
 #include <x11engine/color.hpp>
 #include <x11engine/player.hpp>
+#include <x11engine/viewport.hpp>
 
 #include <vector>
 #include <memory>
@@ -18,7 +19,7 @@ public:
         objects.push_back(std::make_unique<Object::Cube>(0.0f, 0.0f, -200.0f, 100.0f, Color::RED));
 
         // 2. Sphere: Radius 50 (Diameter 100). Should look same width as Cube.
-        objects.push_back(std::make_unique<Object::Sphere>(150.0f, 0.0f, -200.0f, 50.0f, 16, 2, Color::GREEN));
+        objects.push_back(std::make_unique<Object::Sphere<16, 3>>(150.0f, 0.0f, -200.0f, 50.0f, Color::GREEN));
 
         // 3. Square Pyramid
         objects.push_back(std::make_unique<Object::SquarePyramid>(-150.0f, 0.0f, -200.0f, 100.0f, 100.0f, Color::YELLOW));
@@ -29,6 +30,19 @@ public:
         // Player
         // objects.push_back(std::make_unique<Object::Player>(0.0f, 0.0f, 0.0f, 100.0f, Color::GRAY));
 
+        // Views: the player's camera over the whole window, a top-down minimap in the corner
+        views.AddViewport({});
+
+        x11engine::Viewport minimap;
+        minimap.x = 0.74f;
+        minimap.y = 0.02f;
+        minimap.width = 0.24f;
+        minimap.height = 0.24f;
+        minimap.clearColor = Color::RGB(24, 24, 32);
+        minimap.camera.forward = {0.0f, -1.0f, 0.0f};
+        minimap.camera.up = {0.0f, 0.0f, -1.0f}; // Looking straight down, screen up is world -Z
+        views.AddViewport(minimap);
+
         return true;
     }
 
@@ -39,7 +53,9 @@ public:
         if (input->IsKeyDown(XK_Escape))
             Close();
 
+        x11engine::camera::Camera& camera = views.GetViewport(MAIN_VIEW).camera;
         camera.Update(*input);
+        views.GetViewport(MINIMAP_VIEW).camera.position = camera.position + x11engine::math::Vec3{0.0f, 800.0f, 0.0f};
 
         for (auto& obj : objects)
             obj->Update(*input);
@@ -49,27 +65,15 @@ public:
         if (!renderer)
             return;
 
-        // Clear screen
-        renderer->Clear(Color::BLACK);
-
-        // Calculate ViewProjection Matrix
-        auto view = camera.GetViewMatrix();
-        auto proj = camera.GetProjectionMatrix();
-        auto vp = proj * view;
-
-        // Draw all objects
-        for (auto& obj : objects)
-            obj->Draw(*renderer, vp);
-    }
-
-    void OnResize(int width, int height) override {
-        // Prevent division by zero
-        if (height > 0)
-            camera.SetAspectRatio((float)width / (float)height);
+        // Each viewport clears its rectangle, keeps its camera's aspect ratio and prepares in parallel
+        views.Render(*renderer, objects, jobs);
     }
 
 private:
-    x11engine::camera::Camera camera;
+    static constexpr int MAIN_VIEW = 0;
+    static constexpr int MINIMAP_VIEW = 1;
+
+    x11engine::ViewportRenderer views;
     std::vector<std::unique_ptr<x11engine::objects::Object>> objects;
 };
 
@@ -77,6 +81,7 @@ int main() {
     SandboxApp game;
 
     x11engine::Engine engine(1280, 960, "X11 3D Engine", &game);
+    engine.SetDynamicResolution(true);
 
     if (engine.Init())
         engine.Run();
@@ -0,0 +1,548 @@
+// Whole-engine benchmark: a generated scene, a scripted camera and a fixed number of frames.
+//
+// Usage: stress [options]
+//   --frames N           Measured frames (default 600)
+//   --warmup N           Frames run before measuring (default 60)
+//   --cubes N            Object counts (default 200 / 100 / 100)
+//   --spheres N
+//   --pyramids N         Split evenly between square and triangular pyramids
+//   --rings N            Sphere mesh complexity at the finest LOD (default 16 x 24). 8 x 12, 16 x 24 and
+//                        32 x 48 use the compile-time meshes, anything else is tessellated at startup.
+//   --sectors N
+//   --particles N        Fountain of about N live particles in the middle of the field (default 0)
+//   --streaks            Draw the particles as streaks instead of points
+//   --collisions         Run the sweep-and-prune broadphase over all objects every update
+//   --views N            1: single camera; 2: side-by-side split screen; 3: split screen plus a top-down
+//                        picture-in-picture. Views are prepared on the worker threads. (default 1)
+//   --tiled              Draw into the tiled framebuffer layout (detiled on present)
+//   --post               Post-process every frame: edge smoothing, gamma, vignette (the "post" phase)
+//   --distribution D     uniform | shell | clusters (default uniform)
+//   --extent X           Half-size of the populated region in world units (default 1500)
+//   --path P             orbit | flythrough | static (default orbit)
+//   --seed N             Scene generator seed (default 1)
+//   --size WxH           Window / render target size (default 1280x960)
+//   --windowed           Present to an X window (default: headless)
+//   --dynamic-resolution Let the resolution controller run (default off, fixed work per frame)
+//   --input-rate HZ      Inject synthetic key presses at this rate and report their input-to-present latency
+//   --output FILE        Write the JSON report to FILE instead of stdout
+//   --max-p50 MS         Fail (exit code 2) when a frame-time statistic exceeds the threshold
+//   --max-p95 MS
+//   --max-p99 MS
+//   --max-frame MS
+//   --max-input-p99 MS   Fail when the input latency p99 exceeds the threshold (needs --input-rate)
+
+#include <x11engine/application.hpp>
+#include <x11engine/camera.hpp>
+#include <x11engine/collision.hpp>
+#include <x11engine/color.hpp>
+#include <x11engine/engine.hpp>
+#include <x11engine/objects.hpp>
+#include <x11engine/particles.hpp>
+#include <x11engine/profiler.hpp>
+#include <x11engine/renderer.hpp>
+#include <x11engine/viewport.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace Object = x11engine::objects;
+namespace Color = x11engine::color;
+using x11engine::math::Vec3;
+
+namespace {
+
+    enum class Distribution { Uniform, Shell, Clusters };
+    enum class CameraPath { Orbit, Flythrough, Static };
+
+    struct Options {
+        int frames = 600;
+        int warmup = 60;
+        int cubes = 200;
+        int spheres = 100;
+        int pyramids = 100;
+        int rings = 16;
+        int sectors = 24;
+        int particles = 0;
+        bool streaks = false;
+        bool collisions = false;
+        int views = 1;
+        bool tiled = false;
+        bool post = false;
+        Distribution distribution = Distribution::Uniform;
+        float extent = 1500.0f;
+        CameraPath path = CameraPath::Orbit;
+        unsigned seed = 1;
+        int width = 1280;
+        int height = 960;
+        bool windowed = false;
+        bool dynamicResolution = false;
+        double inputRate = 0.0;
+        std::string output;
+
+        // Thresholds in milliseconds, <= 0 when unset
+        double maxP50 = 0.0;
+        double maxP95 = 0.0;
+        double maxP99 = 0.0;
+        double maxFrame = 0.0;
+        double maxInputP99 = 0.0;
+    };
+
+    void PrintUsage() {
+        std::cerr << "Usage: stress [--frames N] [--warmup N] [--cubes N] [--spheres N] [--pyramids N] [--rings N] [--sectors N]\n"
+                     "              [--particles N] [--streaks] [--collisions] [--views 1-3] [--tiled] [--post]\n"
+                     "              [--distribution uniform|shell|clusters] [--extent X] [--path orbit|flythrough|static] [--seed N]\n"
+                     "              [--size WxH] [--windowed] [--dynamic-resolution] [--input-rate HZ] [--output FILE]\n"
+                     "              [--max-p50 MS] [--max-p95 MS] [--max-p99 MS] [--max-frame MS] [--max-input-p99 MS]\n"
+                     "See the header of stress/src/main.cpp for details."
+                  << std::endl;
+    }
+
+    // The whole of 'text' as a T within [min, max]. from_chars takes no sign on unsigned types, so "-1" is rejected
+    // rather than wrapped, and floats must be finite.
+    template <class T>
+    bool ParseNumber(std::string_view text, T& out, T min, T max = std::numeric_limits<T>::max()) {
+        T value{};
+        auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (ec != std::errc() || ptr != text.data() + text.size())
+            return false;
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!std::isfinite(value))
+                return false;
+        }
+        if (value < min || value > max)
+            return false;
+        out = value;
+        return true;
+    }
+
+    // "WxH", both positive
+    bool ParseSize(std::string_view text, int& width, int& height) {
+        std::size_t x = text.find('x');
+        return x != std::string_view::npos && ParseNumber(text.substr(0, x), width, 1) && ParseNumber(text.substr(x + 1), height, 1);
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& o) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+            auto number = [&]<class T>(T& out, T min, T max = std::numeric_limits<T>::max()) {
+                const char* value = next();
+                return value && ParseNumber(std::string_view(value), out, min, max);
+            };
+
+            bool ok = true;
+            if (arg == "--frames")
+                ok = number(o.frames, 1);
+            else if (arg == "--warmup")
+                ok = number(o.warmup, 0);
+            else if (arg == "--cubes")
+                ok = number(o.cubes, 0);
+            else if (arg == "--spheres")
+                ok = number(o.spheres, 0);
+            else if (arg == "--pyramids")
+                ok = number(o.pyramids, 0);
+            else if (arg == "--rings")
+                ok = number(o.rings, 2);
+            else if (arg == "--sectors")
+                ok = number(o.sectors, 3);
+            else if (arg == "--particles")
+                ok = number(o.particles, 0);
+            else if (arg == "--views")
+                ok = number(o.views, 1, 3);
+            else if (arg == "--extent")
+                ok = number(o.extent, std::numeric_limits<float>::min());
+            else if (arg == "--seed")
+                ok = number(o.seed, 0u);
+            else if (arg == "--max-p50")
+                ok = number(o.maxP50, 0.0);
+            else if (arg == "--max-p95")
+                ok = number(o.maxP95, 0.0);
+            else if (arg == "--max-p99")
+                ok = number(o.maxP99, 0.0);
+            else if (arg == "--max-frame")
+                ok = number(o.maxFrame, 0.0);
+            else if (arg == "--max-input-p99")
+                ok = number(o.maxInputP99, 0.0);
+            else if (arg == "--input-rate")
+                ok = number(o.inputRate, 0.0);
+            else if (arg == "--streaks")
+                o.streaks = true;
+            else if (arg == "--collisions")
+                o.collisions = true;
+            else if (arg == "--tiled")
+                o.tiled = true;
+            else if (arg == "--post")
+                o.post = true;
+            else if (arg == "--windowed")
+                o.windowed = true;
+            else if (arg == "--dynamic-resolution")
+                o.dynamicResolution = true;
+            else if (arg == "--output") {
+                const char* value = next();
+                ok = value != nullptr;
+                if (ok)
+                    o.output = value;
+            } else if (arg == "--size") {
+                const char* value = next();
+                ok = value && ParseSize(value, o.width, o.height);
+            } else if (arg == "--distribution") {
+                const char* value = next();
+                std::string d = value ? value : "";
+                ok = d == "uniform" || d == "shell" || d == "clusters";
+                o.distribution = d == "shell" ? Distribution::Shell : d == "clusters" ? Distribution::Clusters : Distribution::Uniform;
+            } else if (arg == "--path") {
+                const char* value = next();
+                std::string p = value ? value : "";
+                ok = p == "orbit" || p == "flythrough" || p == "static";
+                o.path = p == "flythrough" ? CameraPath::Flythrough : p == "static" ? CameraPath::Static : CameraPath::Orbit;
+            } else {
+                ok = false;
+            }
+
+            if (!ok) {
+                std::cerr << "Bad or unknown option '" << arg << "'" << std::endl;
+                PrintUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    class StressApp : public x11engine::Application {
+    public:
+        explicit StressApp(const Options& options) : options(options), rng(options.seed) {}
+
+        bool OnCreate() override {
+            const uint32_t palette[] = {Color::RED, Color::GREEN, Color::BLUE, Color::YELLOW, Color::CYAN, Color::MAGENTA, Color::ORANGE, Color::WHITE};
+            std::uniform_real_distribution<float> size(20.0f, 60.0f);
+            auto color = [&]() { return palette[rng() % std::size(palette)]; };
+
+            for (int i = 0; i < options.cubes; ++i) {
+                Vec3 p = NextPosition();
+                objects.push_back(std::make_unique<Object::Cube>(p.x, p.y, p.z, size(rng), color()));
+            }
+            for (int i = 0; i < options.spheres; ++i) {
+                Vec3 p = NextPosition();
+                objects.push_back(MakeSphere(p, size(rng) * 0.5f, color()));
+            }
+            for (int i = 0; i < options.pyramids; ++i) {
+                Vec3 p = NextPosition();
+                if (i % 2 == 0)
+                    objects.push_back(std::make_unique<Object::SquarePyramid>(p.x, p.y, p.z, size(rng), size(rng), color()));
+                else
+                    objects.push_back(std::make_unique<Object::TriangularPyramid>(p.x, p.y, p.z, size(rng), size(rng), color()));
+            }
+
+            // Every object is an Object3D; their boxes change as they spin
+            if (options.collisions) {
+                for (auto& obj : objects)
+                    world.Add(static_cast<Object::Object3D&>(*obj));
+            }
+
+            if (options.particles > 0) {
+                // Emission matches the lifetime so the pool levels off near full
+                particles = std::make_unique<Object::ParticleSystem>(options.particles);
+                Object::EmitterConfig fountain;
+                fountain.position = {0.0f, -options.extent * 0.5f, 0.0f};
+                fountain.velocity = {0.0f, options.extent * 0.5f, 0.0f};
+                fountain.spread = options.extent * 0.2f;
+                fountain.lifetime = 3.0f;
+                fountain.lifetimeJitter = 0.0f;
+                fountain.rate = options.particles / fountain.lifetime;
+                fountain.colorStart = Color::YELLOW;
+                fountain.colorEnd = Color::RED;
+                particles->AddEmitter(fountain);
+                particles->SetAcceleration({0.0f, -options.extent * 0.25f, 0.0f});
+                particles->SetDrag(0.1f);
+            }
+
+            camera.far_plane = options.extent * 4.0f;
+            camera.SetAspectRatio(static_cast<float>(options.width) / options.height);
+
+            if (options.tiled)
+                renderer->SetLayout(x11engine::FramebufferLayout::Tiled);
+            if (options.post) {
+                post->AddEdgeSmoothing();
+                post->AddGamma(1.2f);
+                post->AddVignette(0.5f);
+            }
+
+            if (options.views > 1) {
+                // Left half follows the path, the right half looks at the field from the side
+                x11engine::Viewport left;
+                left.width = 0.5f;
+                left.camera.far_plane = camera.far_plane;
+                x11engine::Viewport right = left;
+                right.x = 0.5f;
+                right.camera.position = {options.extent * 1.6f, 0.0f, 0.0f};
+                right.camera.forward = {-1.0f, 0.0f, 0.0f};
+                views.AddViewport(left);
+                views.AddViewport(right);
+            }
+            if (options.views > 2) {
+                x11engine::Viewport map;
+                map.x = 0.375f;
+                map.y = 0.02f;
+                map.width = 0.25f;
+                map.height = 0.25f;
+                map.clearColor = Color::RGB(24, 24, 32);
+                map.camera.far_plane = camera.far_plane;
+                map.camera.position = {0.0f, options.extent * 2.5f, 0.0f};
+                map.camera.forward = {0.0f, -1.0f, 0.0f};
+                map.camera.up = {0.0f, 0.0f, -1.0f};
+                views.AddViewport(map);
+            }
+            frameTimes.reserve(options.frames);
+            for (auto& phase : phaseTimes)
+                phase.reserve(options.frames);
+            return true;
+        }
+
+        void OnUpdate(float dt) override {
+            for (auto& obj : objects)
+                obj->Update(*input);
+            if (particles)
+                particles->Update(dt, jobs);
+            if (options.collisions) {
+                world.Update();
+                collisionPairs = world.GetBroadphase().GetPairs().size();
+            }
+        }
+
+        void OnRender() override {
+            // The camera follows the frame index, not wall time, so every run renders the same frames
+            PlaceCamera(static_cast<float>(frame) / static_cast<float>(options.warmup + options.frames));
+
+            auto vp = camera.GetProjectionMatrix() * camera.GetViewMatrix();
+            if (options.views > 1) {
+                x11engine::camera::Camera& main = views.GetViewport(0).camera;
+                main.position = camera.position;
+                main.forward = camera.forward;
+                views.Render(*renderer, objects, jobs);
+                vp = main.GetProjectionMatrix() * main.GetViewMatrix(); // Particles go full-screen with the main camera
+            } else {
+                renderer->Clear(Color::BLACK);
+                for (auto& obj : objects)
+                    obj->Draw(*renderer, vp);
+            }
+            if (particles)
+                particles->Draw(*renderer, vp, jobs, options.streaks ? Object::ParticleStyle::Streaks : Object::ParticleStyle::Points);
+        }
+
+        void OnResize(int width, int height) override {
+            if (height > 0)
+                camera.SetAspectRatio(static_cast<float>(width) / static_cast<float>(height));
+        }
+
+        void OnFrameEnd(const x11engine::FrameTiming& timing) override {
+            if (frame >= options.warmup) {
+                frameTimes.push_back(timing.total * 1000.0);
+                for (std::size_t i = 0; i < x11engine::FRAME_PHASE_COUNT; ++i)
+                    phaseTimes[i].push_back(timing.phases[i] * 1000.0);
+                allocations += timing.allocations;
+                allocatingFrames += timing.allocations.count > 0;
+                InjectInput();
+            }
+            if (++frame >= options.warmup + options.frames)
+                Close();
+        }
+
+        // Writes the JSON report, returns false when a threshold was exceeded
+        bool Report(std::ostream& out) {
+            x11engine::TimingSummary total = x11engine::Summarize(frameTimes);
+
+            auto summary = [&](const x11engine::TimingSummary& s) {
+                out << "{\"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+            };
+
+            out << "{\n";
+            out << "  \"config\": {\"frames\": " << options.frames << ", \"warmup\": " << options.warmup << ", \"cubes\": " << options.cubes << ", \"spheres\": " << options.spheres
+                << ", \"pyramids\": " << options.pyramids << ", \"rings\": " << options.rings << ", \"sectors\": " << options.sectors << ", \"particles\": " << options.particles
+                << ", \"views\": " << options.views << ", \"tiled\": " << (options.tiled ? "true" : "false") << ", \"post\": " << (options.post ? "true" : "false")
+                << ", \"width\": " << options.width << ", \"height\": " << options.height << ", \"windowed\": " << (options.windowed ? "true" : "false") << ", \"seed\": " << options.seed << "},\n";
+            if (options.collisions)
+                out << "  \"collision_pairs\": " << collisionPairs << ",\n";
+            out << "  \"frame_ms\": ";
+            summary(total);
+            out << ",\n  \"phases_ms\": {";
+            for (std::size_t i = 0; i < x11engine::FRAME_PHASE_COUNT; ++i) {
+                out << (i ? ", " : "") << "\"" << x11engine::GetFramePhaseName(static_cast<x11engine::FramePhase>(i)) << "\": ";
+                summary(x11engine::Summarize(phaseTimes[i]));
+            }
+            out << "},\n";
+
+            // Only filled in with X11ENGINE_ALLOC_TRACKING and X11ENGINE_ALLOC=track
+            out << "  \"allocations\": {\"count\": " << allocations.count << ", \"bytes\": " << allocations.bytes << ", \"frames_allocating\": " << allocatingFrames << "},\n";
+
+            // Log-scale buckets: percentiles are bucket upper edges (under 10% high), capped at the max
+            double inputP99 = 0.0;
+            if (options.inputRate > 0.0 && engine) {
+                const x11engine::LatencyHistogram& latency = engine->GetProfiler().GetInputLatency();
+                inputP99 = latency.GetPercentile(0.99) * 1000.0;
+                out << "  \"input_latency_ms\": {\"count\": " << latency.GetCount() << ", \"mean\": " << latency.GetMean() * 1000.0 << ", \"p50\": " << latency.GetPercentile(0.50) * 1000.0
+                    << ", \"p95\": " << latency.GetPercentile(0.95) * 1000.0 << ", \"p99\": " << inputP99 << ", \"max\": " << latency.GetMax() * 1000.0 << "},\n";
+            }
+
+            // Thresholds
+            struct Check {
+                const char* name;
+                double value;
+                double limit;
+            };
+            const Check checks[] = {{"p50", total.p50, options.maxP50}, {"p95", total.p95, options.maxP95}, {"p99", total.p99, options.maxP99}, {"max", total.max, options.maxFrame}, {"input_p99", inputP99, options.maxInputP99}};
+            bool passed = true;
+            out << "  \"failures\": [";
+            for (const Check& check : checks) {
+                if (check.limit > 0.0 && check.value > check.limit) {
+                    out << (passed ? "" : ", ") << "{\"stat\": \"" << check.name << "\", \"value\": " << check.value << ", \"limit\": " << check.limit << "}";
+                    passed = false;
+                }
+            }
+            out << "],\n  \"passed\": " << (passed ? "true" : "false") << "\n}\n";
+            return passed;
+        }
+
+        x11engine::Engine* engine = nullptr; // For synthetic input
+
+    private:
+        // Presses arrive between frames like real ones and wait in the queue for the next fixed tick
+        void InjectInput() {
+            if (options.inputRate <= 0.0 || !engine)
+                return;
+            double now = x11engine::Profiler::Now();
+            if (nextInput == 0.0)
+                nextInput = now;
+            if (now < nextInput)
+                return;
+            nextInput = std::max(nextInput + 1.0 / options.inputRate, now);
+
+            x11engine::InputEvent key{};
+            key.type = x11engine::InputEventType::KeyDown;
+            key.time = now;
+            key.key = XK_space;
+            engine->PushInput(key);
+            key.type = x11engine::InputEventType::KeyUp;
+            engine->PushInput(key);
+        }
+
+        std::unique_ptr<Object::Object> MakeSphere(Vec3 p, float radius, uint32_t color) const {
+            int r = options.rings;
+            int s = options.sectors;
+            if (r == 8 && s == 12)
+                return std::make_unique<Object::Sphere<8, 12>>(p.x, p.y, p.z, radius, color);
+            if (r == 16 && s == 24)
+                return std::make_unique<Object::Sphere<16, 24>>(p.x, p.y, p.z, radius, color);
+            if (r == 32 && s == 48)
+                return std::make_unique<Object::Sphere<32, 48>>(p.x, p.y, p.z, radius, color);
+            return std::make_unique<Object::TessellatedSphere>(p.x, p.y, p.z, radius, r, s, color);
+        }
+
+        Vec3 NextPosition() {
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            std::normal_distribution<float> normal(0.0f, 1.0f);
+            float e = options.extent;
+
+            switch (options.distribution) {
+                case Distribution::Shell: {
+                    Vec3 d{normal(rng), normal(rng), normal(rng)};
+                    float length = std::max(std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z), 1e-6f);
+                    return d * (e / length);
+                }
+                case Distribution::Clusters: {
+                    // A handful of fixed centers, objects scattered around them
+                    if (clusters.empty()) {
+                        for (int i = 0; i < 8; ++i)
+                            clusters.push_back(Vec3{unit(rng), unit(rng), unit(rng)} * e);
+                    }
+                    Vec3 c = clusters[rng() % clusters.size()];
+                    return c + Vec3{normal(rng), normal(rng), normal(rng)} * (e * 0.1f);
+                }
+                default:
+                    return Vec3{unit(rng), unit(rng), unit(rng)} * e;
+            }
+        }
+
+        void PlaceCamera(float t) {
+            constexpr float TWO_PI = 6.2831853f;
+            float e = options.extent;
+            Vec3 target{0.0f, 0.0f, 0.0f};
+
+            switch (options.path) {
+                case CameraPath::Orbit:
+                    camera.position = {std::cos(t * TWO_PI) * e * 1.6f, e * 0.3f, std::sin(t * TWO_PI) * e * 1.6f};
+                    break;
+                case CameraPath::Flythrough:
+                    // Straight through the middle of the field, looking ahead
+                    camera.position = {0.0f, 0.0f, e * (1.5f - 3.0f * t)};
+                    target = camera.position + Vec3{0.0f, 0.0f, -1.0f};
+                    break;
+                case CameraPath::Static:
+                    camera.position = {0.0f, 0.0f, e * 1.6f};
+                    break;
+            }
+            camera.forward = x11engine::math::normalize(target - camera.position);
+        }
+
+        const Options& options;
+        std::mt19937 rng;
+        x11engine::camera::Camera camera;
+        std::vector<std::unique_ptr<Object::Object>> objects;
+        std::vector<Vec3> clusters;
+        std::unique_ptr<Object::ParticleSystem> particles;
+        x11engine::collision::CollisionWorld world;
+        x11engine::ViewportRenderer views;
+        std::size_t collisionPairs = 0;
+
+        int frame = 0;
+        std::vector<double> frameTimes;
+        std::vector<double> phaseTimes[x11engine::FRAME_PHASE_COUNT];
+        x11engine::memory::AllocationStats allocations{};
+        int allocatingFrames = 0;
+        double nextInput = 0.0;
+    };
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    StressApp app(options);
+
+    x11engine::Engine engine(options.width, options.height, "X11 Engine - Stress", &app);
+    app.engine = &engine;
+    engine.SetWindowBackend(options.windowed ? x11engine::WindowBackend::Xlib : x11engine::WindowBackend::Headless);
+    engine.SetTargetFps(0.0); // Measure how fast frames can be made, not the cap
+    engine.SetDynamicResolution(options.dynamicResolution);
+
+    if (!engine.Init())
+        return 1;
+    engine.Run();
+
+    bool passed;
+    if (options.output.empty()) {
+        passed = app.Report(std::cout);
+    } else {
+        std::ofstream file(options.output);
+        if (!file) {
+            std::cerr << "Failed to open " << options.output << std::endl;
+            return 1;
+        }
+        passed = app.Report(file);
+    }
+    return passed ? 0 : 2;
+}
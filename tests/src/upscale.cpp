@@ -0,0 +1,62 @@
+// Nearest upscaling must map rows and columns with the same pixel-center rule: at exactly 2x every source pixel
+// becomes a 2x2 block, so a pattern of 1-pixel stripes in both directions comes out with columns aligned to rows.
+
+#include <x11engine/frame.hpp>
+#include <x11engine/renderer.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace x11engine;
+
+namespace {
+
+    // Vertical stripes in red, horizontal stripes in blue: each source pixel differs from all four neighbours
+    uint32_t Pattern(int x, int y) { return (x & 1 ? 0xFF0000u : 0u) | (y & 1 ? 0x0000FFu : 0u) | 0x004000u; }
+
+    int CheckNearest2x(Frame& frame, int windowWidth, int windowHeight) {
+        Renderer renderer(windowWidth, windowHeight);
+        if (!renderer.Init(frame))
+            return 1;
+        renderer.SetUpscaleFilter(UpscaleFilter::Nearest);
+        renderer.SetRenderScale(frame, 0.5f);
+        if (renderer.GetWidth() * 2 != windowWidth || renderer.GetHeight() * 2 != windowHeight) {
+            std::fprintf(stderr, "unexpected render size %dx%d\n", renderer.GetWidth(), renderer.GetHeight());
+            return 1;
+        }
+
+        std::vector<uint32_t> row(renderer.GetWidth());
+        for (int y = 0; y < renderer.GetHeight(); ++y) {
+            for (int x = 0; x < renderer.GetWidth(); ++x)
+                row[x] = Pattern(x, y);
+            renderer.WriteRow(y, row.data());
+        }
+        renderer.Present(frame);
+
+        const uint32_t* image = renderer.GetPresentedImage();
+        int bad = 0;
+        for (int y = 0; y < windowHeight; ++y) {
+            for (int x = 0; x < windowWidth; ++x) {
+                uint32_t expected = Pattern(x / 2, y / 2);
+                uint32_t actual = image[static_cast<std::size_t>(y) * windowWidth + x] & 0xFFFFFF;
+                if (actual != expected && bad++ < 5)
+                    std::fprintf(stderr, "%dx%d: pixel (%d, %d) is %06x, expected %06x\n", windowWidth, windowHeight, x, y, actual, expected);
+            }
+        }
+        return bad != 0;
+    }
+
+} // namespace
+
+int main() {
+    Frame frame(64, 48, "UpscaleTest");
+    frame.SetBackend(WindowBackend::Headless);
+    if (!frame.Init())
+        return 1;
+
+    int failures = CheckNearest2x(frame, 64, 48) + CheckNearest2x(frame, 34, 18) + CheckNearest2x(frame, 2, 2);
+    if (failures)
+        std::fprintf(stderr, "%d upscale checks failed\n", failures);
+    return failures != 0;
+}
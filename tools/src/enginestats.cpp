@@ -0,0 +1,165 @@
+// Live metrics of running engines, read from their telemetry blocks (see x11engine/telemetry.hpp)
+//
+// Usage: EngineStats [--interval <seconds>] [--count <n>] [name...]
+//   name            Telemetry object to watch, e.g. /x11engine.1234. Default: every /dev/shm/x11engine.* found
+//   --interval <s>  Seconds between reports (default 1)
+//   --count <n>     Stop after n reports (default: until interrupted)
+//
+// Start the engine with X11ENGINE_TELEMETRY=1. Rates are computed from the running totals of two consecutive samples,
+// so nothing is missed between reads however slowly this polls.
+
+#include <x11engine/telemetry.hpp>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <signal.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace x11engine;
+
+namespace {
+
+    struct Instance {
+        std::unique_ptr<TelemetryReader> reader;
+        TelemetrySample last{};
+        bool hasLast = false;
+    };
+
+    std::vector<std::string> FindInstances() {
+        std::vector<std::string> names;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", error)) {
+            std::string file = entry.path().filename().string();
+            if (file.starts_with("x11engine."))
+                names.push_back("/" + file);
+        }
+        return names;
+    }
+
+    bool IsAlive(pid_t pid) { return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM); }
+
+    void PrintHeader() {
+        std::printf("%-22s %8s %7s %8s", "instance", "frame", "fps", "ms/frame");
+        for (std::size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+            std::printf(" %8s", GetFramePhaseName(static_cast<FramePhase>(i)));
+        std::printf(" %8s %10s %9s %9s %8s %8s\n", "objects", "lines/s", "Mpixels/s", "allocs/s", "in p50", "in p99");
+    }
+
+    void PrintRates(const std::string& name, const TelemetrySample& prev, const TelemetrySample& cur) {
+        double elapsed = cur.time - prev.time;
+        uint64_t frames = cur.frames - prev.frames;
+        if (elapsed <= 0.0 || frames == 0) {
+            std::printf("%-22s %8llu  (no new frames)\n", name.c_str(), static_cast<unsigned long long>(cur.frame));
+            return;
+        }
+
+        // Phases are the last frame's, the rest is averaged over the interval
+        std::printf("%-22s %8llu %7.1f %8.2f", name.c_str(), static_cast<unsigned long long>(cur.frame), frames / elapsed, (cur.totalFrameTime - prev.totalFrameTime) / frames * 1000.0);
+        for (std::size_t i = 0; i < FRAME_PHASE_COUNT; ++i)
+            std::printf(" %8.2f", cur.phases[i] * 1000.0);
+        std::printf(" %8.0f %10.0f %9.2f %9.1f", static_cast<double>(cur.totalObjects - prev.totalObjects) / frames, (cur.totalLines - prev.totalLines) / elapsed,
+                    (cur.totalPixels - prev.totalPixels) / elapsed * 1e-6, (cur.totalAllocations - prev.totalAllocations) / elapsed);
+
+        // Input-to-present latency of the presses in the interval (ms, bucket upper edges; "over" past the last finite bucket)
+        if (cur.inputLatencyCount == prev.inputLatencyCount) {
+            std::printf(" %8s %8s\n", "-", "-");
+            return;
+        }
+        std::array<uint64_t, LatencyHistogram::BUCKETS> buckets;
+        for (std::size_t i = 0; i < buckets.size(); ++i)
+            buckets[i] = cur.inputLatencyBuckets[i] - prev.inputLatencyBuckets[i];
+        for (double p : {0.50, 0.99}) {
+            double latency = LatencyHistogram::Percentile(buckets, p);
+            if (std::isinf(latency))
+                std::printf(" %8s", "over");
+            else
+                std::printf(" %8.1f", latency * 1000.0);
+        }
+        std::printf("\n");
+    }
+
+    // Opens instances that appeared, drops those whose process went away, prints a line per live instance (when 'print')
+    void Poll(std::map<std::string, Instance>& instances, const std::vector<std::string>& names, bool print) {
+        for (const std::string& name : names.empty() ? FindInstances() : names) {
+            Instance& instance = instances[name];
+            if (!instance.reader) {
+                instance.reader = std::make_unique<TelemetryReader>();
+                if (!instance.reader->Open(name))
+                    instance.reader.reset();
+            }
+        }
+
+        bool printed = false;
+        for (auto it = instances.begin(); it != instances.end();) {
+            Instance& instance = it->second;
+            if (!instance.reader || !IsAlive(instance.reader->GetPid())) {
+                it = instances.erase(it);
+                continue;
+            }
+
+            // The first sample of an instance only sets the baseline
+            TelemetrySample sample;
+            if (instance.reader->Read(sample)) {
+                if (print && instance.hasLast) {
+                    if (!printed)
+                        PrintHeader();
+                    PrintRates(it->first, instance.last, sample);
+                    printed = true;
+                }
+                instance.last = sample;
+                instance.hasLast = true;
+            }
+            ++it;
+        }
+
+        if (print && !printed)
+            std::printf("No running instances%s\n", names.empty() ? " (start one with X11ENGINE_TELEMETRY=1)" : "");
+        if (print)
+            std::printf("\n");
+        std::fflush(stdout);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double interval = 1.0;
+    long count = 0;
+    std::vector<std::string> names;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--interval" && i + 1 < argc) {
+            interval = std::atof(argv[++i]);
+            if (interval <= 0.0) {
+                std::cerr << "Invalid interval " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--count" && i + 1 < argc) {
+            count = std::atol(argv[++i]);
+        } else if (arg.starts_with("--")) {
+            std::cerr << "Usage: EngineStats [--interval <seconds>] [--count <n>] [name...]" << std::endl;
+            return 1;
+        } else {
+            names.push_back(arg.starts_with("/") ? std::string(arg) : "/" + std::string(arg));
+        }
+    }
+
+    std::map<std::string, Instance> instances;
+    Poll(instances, names, false);
+    for (long report = 0; count <= 0 || report < count; ++report) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+        Poll(instances, names, true);
+    }
+    return 0;
+}
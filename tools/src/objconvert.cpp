@@ -0,0 +1,200 @@
+// Offline converter: Wavefront OBJ -> binary .xmesh (see x11engine/mesh.hpp)
+//
+// Usage: ObjConvert [--normalize] [--no-optimize] <input.obj> <output.xmesh>
+//   --normalize    Center the mesh and scale it to fit a unit cube, like the built-in primitives
+//   --no-optimize  Keep vertices and edges exactly as authored (no welding or reordering)
+
+#include <x11engine/mesh.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Object = x11engine::objects;
+using x11engine::math::Vec3;
+
+namespace {
+
+    struct ObjData {
+        std::vector<Vec3> vertices;
+        std::vector<Object::Edge> edges;
+        std::vector<Object::Face> faces;
+    };
+
+    std::string_view NextToken(std::string_view& line) {
+        std::size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos) {
+            line = {};
+            return {};
+        }
+        std::size_t end = line.find_first_of(" \t\r", start);
+        std::string_view token = line.substr(start, end - start);
+        line = end == std::string_view::npos ? std::string_view{} : line.substr(end);
+        return token;
+    }
+
+    // std::from_chars takes no leading '+', which OBJ writers may emit
+    std::string_view SkipPlus(std::string_view token) { return token.starts_with('+') && !token.substr(1).starts_with('-') ? token.substr(1) : token; }
+
+    // OBJ indices are 1-based, negative values count back from the last vertex
+    bool ParseIndex(std::string_view token, int vertexCount, int& out) {
+        token = SkipPlus(token.substr(0, token.find('/'))); // Drop texture/normal indices
+        int value = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (ec != std::errc() || ptr != token.data() + token.size() || value == 0)
+            return false;
+
+        out = value > 0 ? value - 1 : vertexCount + value;
+        return out >= 0 && out < vertexCount;
+    }
+
+    class EdgeSet {
+    public:
+        void Add(int a, int b, std::vector<Object::Edge>& edges) {
+            if (a == b)
+                return;
+            uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | static_cast<uint32_t>(std::max(a, b));
+            if (seen.insert(key).second)
+                edges.push_back({a, b});
+        }
+
+    private:
+        std::unordered_set<uint64_t> seen;
+    };
+
+    bool ParseObj(const std::string& text, ObjData& obj) {
+        EdgeSet edgeSet;
+        std::vector<int> polygon;
+        std::size_t lineNumber = 0;
+        std::size_t pos = 0;
+
+        while (pos < text.size()) {
+            std::size_t end = text.find('\n', pos);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string_view line(text.data() + pos, end - pos);
+            pos = end + 1;
+            lineNumber++;
+
+            std::string_view keyword = NextToken(line);
+            int vertexCount = static_cast<int>(obj.vertices.size());
+
+            if (keyword == "v") {
+                Vec3 v;
+                for (int i = 0; i < 3; ++i) {
+                    std::string_view token = SkipPlus(NextToken(line));
+                    auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), v[i]);
+                    if (ec != std::errc() || ptr != token.data() + token.size()) {
+                        std::cerr << "Line " << lineNumber << ": malformed vertex" << std::endl;
+                        return false;
+                    }
+                }
+                obj.vertices.push_back(v);
+
+            } else if (keyword == "f" || keyword == "l") {
+                polygon.clear();
+                for (std::string_view token = NextToken(line); !token.empty(); token = NextToken(line)) {
+                    int index;
+                    if (!ParseIndex(token, vertexCount, index)) {
+                        std::cerr << "Line " << lineNumber << ": bad index '" << token << "'" << std::endl;
+                        return false;
+                    }
+                    polygon.push_back(index);
+                }
+
+                if (keyword == "l") {
+                    // Polyline: connect consecutive points
+                    for (std::size_t i = 1; i < polygon.size(); ++i)
+                        edgeSet.Add(polygon[i - 1], polygon[i], obj.edges);
+                    continue;
+                }
+
+                if (polygon.size() < 3)
+                    continue;
+
+                // Wireframe edges follow the polygon outline, faces are fan-triangulated
+                for (std::size_t i = 0; i < polygon.size(); ++i)
+                    edgeSet.Add(polygon[i], polygon[(i + 1) % polygon.size()], obj.edges);
+
+                for (std::size_t i = 1; i + 1 < polygon.size(); ++i)
+                    obj.faces.push_back({static_cast<uint32_t>(polygon[0]), static_cast<uint32_t>(polygon[i]), static_cast<uint32_t>(polygon[i + 1])});
+            }
+            // Everything else (vt, vn, g, o, s, usemtl, comments) is irrelevant for wireframes
+        }
+
+        return true;
+    }
+
+    void Normalize(std::vector<Vec3>& vertices) {
+        if (vertices.empty())
+            return;
+
+        Vec3 lo = vertices[0];
+        Vec3 hi = lo;
+        for (const Vec3& v : vertices) {
+            for (int i = 0; i < 3; ++i) {
+                lo[i] = std::min(lo[i], v[i]);
+                hi[i] = std::max(hi[i], v[i]);
+            }
+        }
+
+        Vec3 center = (lo + hi) * 0.5f;
+        float extent = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z});
+        float invExtent = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+        for (Vec3& v : vertices)
+            v = (v - center) * invExtent;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool normalize = false;
+    bool optimize = true;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--normalize")
+            normalize = true;
+        else if (arg == "--no-optimize")
+            optimize = false;
+        else
+            paths.push_back(arg);
+    }
+
+    if (paths.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--normalize] [--no-optimize] <input.obj> <output.xmesh>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream input(paths[0], std::ios::binary);
+    if (!input) {
+        std::cerr << "Failed to open " << paths[0] << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+
+    ObjData obj;
+    if (!ParseObj(buffer.str(), obj))
+        return 1;
+
+    if (normalize)
+        Normalize(obj.vertices);
+
+    // Weld after normalizing so the epsilon is relative to a unit-sized model
+    if (optimize)
+        Object::OptimizeMesh(obj.vertices, obj.edges, obj.faces);
+
+    if (!Object::WriteMeshFile(paths[1], obj.vertices, obj.edges, obj.faces))
+        return 1;
+
+    std::cout << paths[1] << ": " << obj.vertices.size() << " vertices, " << obj.edges.size() << " edges, " << obj.faces.size() << " faces" << std::endl;
+    return 0;
+}